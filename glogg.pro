@@ -23,13 +23,23 @@ SOURCES += \
     src/data/logdata.cpp \
     src/data/logfiltereddata.cpp \
     src/data/logfiltereddataworkerthread.cpp \
+    src/data/trigramindex.cpp \
+    src/data/timestampindex.cpp \
+    src/data/matchhistogram.cpp \
+    src/data/regexpbudget.cpp \
+    src/data/quickfindindex.cpp \
+    src/data/perfcounters.cpp \
+    src/data/tracer.cpp \
     src/data/logdataworkerthread.cpp \
     src/mainwindow.cpp \
     src/crawlerwidget.cpp \
+    src/headlesssearch.cpp \
+    src/histogramwidget.cpp \
     src/abstractlogview.cpp \
     src/logmainview.cpp \
     src/filteredview.cpp \
     src/optionsdialog.cpp \
+    src/diagnosticsdialog.cpp \
     src/persistentinfo.cpp \
     src/configuration.cpp \
     src/filtersdialog.cpp \
@@ -40,11 +50,13 @@ SOURCES += \
     src/filewatcher.cpp \
     src/selection.cpp \
     src/quickfind.cpp \
+    src/quickfindworkerthread.cpp \
     src/quickfindpattern.cpp \
     src/quickfindwidget.cpp \
     src/sessioninfo.cpp \
     src/recentfiles.cpp \
     src/overview.cpp \
+    src/linerendercache.cpp \
     src/overviewwidget.cpp \
     src/marks.cpp \
     src/quickfindmux.cpp \
@@ -53,21 +65,37 @@ SOURCES += \
 
 INCLUDEPATH += src/
 
+# Follow the files by inode on Linux (see FileWatcher)
+linux-* {
+    DEFINES += GLOGG_SUPPORTS_INOTIFY
+}
+
 HEADERS += \
     src/data/abstractlogdata.h \
     src/data/logdata.h \
     src/data/logfiltereddata.h \
     src/data/logfiltereddataworkerthread.h \
     src/data/logdataworkerthread.h \
+    src/data/atomicflag.h \
+    src/data/trigramindex.h \
+    src/data/timestampindex.h \
+    src/data/matchhistogram.h \
+    src/data/regexpbudget.h \
+    src/data/quickfindindex.h \
+    src/data/perfcounters.h \
+    src/data/tracer.h \
     src/mainwindow.h \
     src/session.h \
     src/viewinterface.h \
     src/crawlerwidget.h \
+    src/headlesssearch.h \
+    src/histogramwidget.h \
     src/logmainview.h \
     src/log.h \
     src/filteredview.h \
     src/abstractlogview.h \
     src/optionsdialog.h \
+    src/diagnosticsdialog.h \
     src/persistentinfo.h \
     src/configuration.h \
     src/filtersdialog.h \
@@ -77,6 +105,7 @@ HEADERS += \
     src/filewatcher.h \
     src/selection.h \
     src/quickfind.h \
+    src/quickfindworkerthread.h \
     src/quickfindpattern.h \
     src/quickfindwidget.h \
     src/sessioninfo.h \
@@ -84,6 +113,7 @@ HEADERS += \
     src/recentfiles.h \
     src/menuactiontooltipbehavior.h \
     src/overview.h \
+    src/linerendercache.h \
     src/overviewwidget.h \
     src/marks.h \
     src/qfnotifications.h \
@@ -112,6 +142,7 @@ else {
 
 FORMS += src/optionsdialog.ui
 FORMS += src/filtersdialog.ui
+FORMS += src/diagnosticsdialog.ui
 
 # For Windows icon
 RC_FILE = glogg.rc
@@ -25,6 +25,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <limits>
 
 #include <QApplication>
 #include <QClipboard>
@@ -37,6 +38,7 @@
 #include <QMenu>
 #include <QAction>
 #include <QtCore>
+#include <QElapsedTimer>
 
 #include "log.h"
 
@@ -47,6 +49,8 @@
 #include "quickfindpattern.h"
 #include "overview.h"
 #include "configuration.h"
+#include "data/perfcounters.h"
+#include "data/tracer.h"
 
 namespace {
 
@@ -214,9 +218,9 @@ void DigitsBuffer::add( char character )
     timer_.start( timeout_ , this );
 }
 
-int DigitsBuffer::content()
+qint64 DigitsBuffer::content()
 {
-    int result = digits_.toInt();
+    qint64 result = digits_.toLongLong();
     reset();
 
     return result;
@@ -244,7 +248,8 @@ AbstractLogView::AbstractLogView(const AbstractLogData* newLogData,
     autoScrollTimer_(),
     selection_(),
     quickFindPattern_( quickFindPattern ),
-    quickFind_( newLogData, &selection_, quickFindPattern )
+    quickFind_( newLogData, &selection_, quickFindPattern ),
+    renderCache_()
 {
     logData = newLogData;
 
@@ -256,6 +261,9 @@ AbstractLogView::AbstractLogView(const AbstractLogData* newLogData,
     firstLine = 0;
     lastLine = 0;
     firstCol = 0;
+    verticalScrollScale_ = 1;
+    nbLinesUpdated_ = 0;
+    followChangeTime_ = -1;
 
     overview_ = NULL;
     overviewWidget_ = NULL;
@@ -289,6 +297,10 @@ AbstractLogView::AbstractLogView(const AbstractLogData* newLogData,
             this, SIGNAL( notifyQuickFind( const QFNotification& ) ) );
     connect( &quickFind_, SIGNAL( clearNotification() ),
             this, SIGNAL( clearQuickFindNotification() ) );
+    connect( &quickFind_, SIGNAL( searchFinished( qint64 ) ),
+            this, SLOT( handleQuickFindFinished( qint64 ) ) );
+    connect( &quickFind_, SIGNAL( indexUpdated() ),
+            this, SLOT( updateQuickFindOverview() ) );
 }
 
 AbstractLogView::~AbstractLogView()
@@ -319,7 +331,7 @@ void AbstractLogView::mousePressEvent( QMouseEvent* mouseEvent )
 
     if ( mouseEvent->button() == Qt::LeftButton )
     {
-        int line = convertCoordToLine( mouseEvent->y() );
+        qint64 line = convertCoordToLine( mouseEvent->y() );
 
         if ( mouseEvent->modifiers() & Qt::ShiftModifier )
         {
@@ -386,35 +398,35 @@ void AbstractLogView::mouseMoveEvent( QMouseEvent* mouseEvent )
     // Selection implementation
     if ( selectionStarted_ )
     {
-        QPoint thisEndPos = convertCoordToFilePos( mouseEvent->pos() );
+        FilePosition thisEndPos = convertCoordToFilePos( mouseEvent->pos() );
         if ( thisEndPos != selectionCurrentEndPos_ )
         {
             // Are we on a different line?
-            if ( selectionStartPos_.y() != thisEndPos.y() )
+            if ( selectionStartPos_.line() != thisEndPos.line() )
             {
-                if ( thisEndPos.y() != selectionCurrentEndPos_.y() )
+                if ( thisEndPos.line() != selectionCurrentEndPos_.line() )
                 {
                     // This is a 'range' selection
-                    selection_.selectRange( selectionStartPos_.y(),
-                            thisEndPos.y() );
-                    emit updateLineNumber( thisEndPos.y() );
+                    selection_.selectRange( selectionStartPos_.line(),
+                            thisEndPos.line() );
+                    emit updateLineNumber( thisEndPos.line() );
                     update();
                 }
             }
             // So we are on the same line. Are we moving horizontaly?
-            else if ( thisEndPos.x() != selectionCurrentEndPos_.x() )
+            else if ( thisEndPos.column() != selectionCurrentEndPos_.column() )
             {
                 // This is a 'portion' selection
-                selection_.selectPortion( thisEndPos.y(),
-                        selectionStartPos_.x(), thisEndPos.x() );
+                selection_.selectPortion( thisEndPos.line(),
+                        selectionStartPos_.column(), thisEndPos.column() );
                 update();
             }
             // On the same line, and moving vertically then
             else
             {
                 // This is a 'line' selection
-                selection_.selectLine( thisEndPos.y() );
-                emit updateLineNumber( thisEndPos.y() );
+                selection_.selectLine( thisEndPos.line() );
+                emit updateLineNumber( thisEndPos.line() );
                 update();
             }
             selectionCurrentEndPos_ = thisEndPos;
@@ -436,7 +448,7 @@ void AbstractLogView::mouseReleaseEvent( QMouseEvent* mouseEvent )
 {
     if ( markingClickInitiated_ ) {
         markingClickInitiated_ = false;
-        int line = convertCoordToLine( mouseEvent->y() );
+        qint64 line = convertCoordToLine( mouseEvent->y() );
         if ( line == markingClickLine_ )
             emit markLine( line );
     }
@@ -452,7 +464,7 @@ void AbstractLogView::mouseDoubleClickEvent( QMouseEvent* mouseEvent )
 {
     if ( mouseEvent->button() == Qt::LeftButton )
     {
-        const QPoint pos = convertCoordToFilePos( mouseEvent->pos() );
+        const FilePosition pos = convertCoordToFilePos( mouseEvent->pos() );
         selectWordAtPosition( pos );
     }
 }
@@ -523,6 +535,8 @@ void AbstractLogView::keyPressEvent( QKeyEvent* keyEvent )
         selectAndDisplayLine( 0 );
         emit updateLineNumber( 0 );
     }
+    else if ( keyEvent->key() == Qt::Key_Escape && quickFind_.isSearching() )
+        quickFind_.stopSearch();
     else if ( keyEvent->key() == Qt::Key_F3 && !shiftModifier )
         searchNext(); // duplicate of 'n' action.
     else if ( keyEvent->key() == Qt::Key_F3 && shiftModifier )
@@ -538,7 +552,9 @@ void AbstractLogView::keyPressEvent( QKeyEvent* keyEvent )
             switch ( (keyEvent->text())[0].toLatin1() ) {
                 case 'j':
                     {
-                        int delta = qMax( 1, digitsBuffer_.content() );
+                        // (the selection moves by an int)
+                        int delta = qBound<qint64>( 1, digitsBuffer_.content(),
+                                std::numeric_limits<int>::max() );
                         emit followDisabled();
                         //verticalScrollBar()->triggerAction(
                         //QScrollBar::SliderSingleStepAdd);
@@ -547,7 +563,8 @@ void AbstractLogView::keyPressEvent( QKeyEvent* keyEvent )
                     }
                 case 'k':
                     {
-                        int delta = qMin( -1, - digitsBuffer_.content() );
+                        int delta = - qBound<qint64>( 1, digitsBuffer_.content(),
+                                std::numeric_limits<int>::max() );
                         emit followDisabled();
                         //verticalScrollBar()->triggerAction(
                         //QScrollBar::SliderSingleStepSub);
@@ -570,7 +587,7 @@ void AbstractLogView::keyPressEvent( QKeyEvent* keyEvent )
                     break;
                 case 'g':
                     {
-                        int newLine = qMax( 0, digitsBuffer_.content() - 1 );
+                        qint64 newLine = qMax<qint64>( 0, digitsBuffer_.content() - 1 );
                         if ( newLine >= logData->getNbLine() )
                             newLine = logData->getNbLine() - 1;
                         emit followDisabled();
@@ -629,7 +646,15 @@ void AbstractLogView::scrollContentsBy( int dx, int dy )
 {
     LOG(logDEBUG4) << "scrollContentsBy received";
 
-    firstLine = (firstLine - dy) > 0 ? firstLine - dy : 0;
+    const qint64 oldFirstLine = firstLine;
+    const int oldFirstCol = firstCol;
+
+    if ( verticalScrollScale_ == 1 )
+        firstLine = (firstLine - dy) > 0 ? firstLine - dy : 0;
+    else if ( firstLine / verticalScrollScale_ != verticalScrollBar()->value() )
+        // The scroll bar has been moved by the user, setTopLine() keeps
+        // the precise line if the step is the right one.
+        firstLine = verticalScrollBar()->value() * verticalScrollScale_;
     firstCol  = (firstCol - dx) > 0 ? firstCol - dx : 0;
     lastLine = qMin( logData->getNbLine(), firstLine + getNbVisibleLines() );
 
@@ -641,8 +666,14 @@ void AbstractLogView::scrollContentsBy( int dx, int dy )
     const QPoint mouse_pos = mapFromGlobal( QCursor::pos() );
     considerMouseHovering( mouse_pos.x(), mouse_pos.y() );
 
-    // Redraw
-    update();
+    // Redraw, when scrolling vertically by less than a screen we move
+    // what is already drawn and only the lines exposed are painted.
+    const qint64 scrolledLines = oldFirstLine - firstLine;
+    if ( firstCol == oldFirstCol && scrolledLines != 0
+            && qAbs( scrolledLines ) < getNbVisibleLines() )
+        viewport()->scroll( 0, scrolledLines * charHeight_ );
+    else
+        update();
 }
 
 void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
@@ -658,6 +689,12 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
         ", " << invalidRect.bottomRight().x() <<
         ", " << invalidRect.bottomRight().y();
 
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+    TraceScope trace( "paintEvent" );
+    int nbLinesDrawn = 0;
+    int nbLinesFromCache = 0;
+
     {
         // Repaint the viewport
         QPainter painter( viewport() );
@@ -680,7 +717,7 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
 
         // First check the lines to be drawn are within range (might not be the case if
         // the file has just changed)
-        const int nbLines = logData->getNbLine();
+        const qint64 nbLines = logData->getNbLine();
         if ( nbLines == 0 ) {
             return;
         }
@@ -691,8 +728,32 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
                 lastLine =  nbLines - 1;
         }
 
-        // Lines to write
-        const QStringList lines = logData->getExpandedLines( firstLine, lastLine - firstLine + 1 );
+        // Only the lines in the invalidated area are drawn
+        // (e.g. the ones exposed by scrolling)
+        const qint64 paintFirstLine = firstLine + invalidRect.top() / fontHeight;
+        const qint64 paintLastLine  = qMin<qint64>( lastLine,
+                firstLine + invalidRect.bottom() / fontHeight );
+
+        // Lines to write, cut to fit the length and position of the view
+        // (only the part displayed of very long lines is read)
+        const QStringList lines = ( paintLastLine >= paintFirstLine ) ?
+            logData->getExpandedLinesWindow( paintFirstLine,
+                    paintLastLine - paintFirstLine + 1, firstCol, nbCols ) :
+            QStringList();
+
+        // Only the lines we haven't rendered since the filters, the
+        // pattern or the data last changed are matched again
+        renderCache_.setVersions( logData->getLinesGeneration(),
+                filterSet->version(), quickFindPattern_->version() );
+        const int nbCachedLines = lastLine - firstLine + 1;
+        renderCache_.retain( firstLine - nbCachedLines, lastLine + nbCachedLines );
+        cacheRenderAttributes( paintFirstLine, lines.size(), *filterSet );
+
+#if QT_VERSION >= 0x050100
+        const int pixelRatio = viewport()->devicePixelRatio();
+#else
+        const int pixelRatio = 1;
+#endif
 
         // First draw the bullet left margin
         painter.setPen(palette.color(QPalette::Text));
@@ -739,14 +800,21 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
         leftMarginPx_ = contentStartPosX;
 
         // Then draw each line
-        for (int i = firstLine; i <= lastLine; i++) {
+        for (qint64 i = paintFirstLine; i <= paintLastLine; i++) {
             // Position in pixel of the base line of the line to print
             const int yPos = (i-firstLine) * fontHeight;
             const int xPos = contentStartPosX + CONTENT_MARGIN_WIDTH;
 
-            // string to print, cut to fit the length and position of the view
-            const QString line = lines[i - firstLine];
-            const QString cutLine = line.mid( firstCol, nbCols );
+            // string to print
+            const QString cutLine = lines[i - paintFirstLine];
+
+            // (the line can only be missing if the data changed under
+            // our feet, it will be repainted)
+            static const LineRenderCache::Attributes noAttributes;
+            const LineRenderCache::Attributes* attributes =
+                renderCache_.find( i );
+            if ( attributes == NULL )
+                attributes = &noAttributes;
 
             if ( selection_.isLineSelected( i ) ) {
                 // Reverse the selected line
@@ -754,9 +822,10 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
                 backColor = palette.color( QPalette::Highlight );
                 painter.setPen(palette.color(QPalette::Text));
             }
-            else if ( filterSet->matchLine( logData->getLineString( i ),
-                        &foreColor, &backColor ) ) {
+            else if ( attributes->isFiltered() ) {
                 // Apply a filter to the line
+                foreColor = attributes->foreColor();
+                backColor = attributes->backColor();
             }
             else {
                 // Use the default colors
@@ -769,84 +838,117 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
             bool isSelection =
                 selection_.getPortionForLine( i, &sel_start, &sel_end );
             // Has the line got elements to be highlighted
-            QList<QuickFindMatch> qfMatchList;
-            bool isMatch =
-                quickFindPattern_->matchLine( line, qfMatchList );
-
-            if ( isSelection || isMatch ) {
-                // We use the LineDrawer and its chunks because the
-                // line has to be somehow highlighted
-                LineDrawer lineDrawer( backColor );
-
-                // First we create a list of chunks with the highlights
-                QList<LineChunk> chunkList;
-                int column = 0; // Current column in line space
-                foreach( const QuickFindMatch match, qfMatchList ) {
-                    int start = match.startColumn() - firstCol;
-                    int end = start + match.length();
-                    // Ignore matches that are *completely* outside view area
-                    if ( ( start < 0 && end < 0 ) || start >= nbCols )
-                        continue;
-                    if ( start > column )
-                        chunkList << LineChunk( column, start - 1, LineChunk::Normal );
-                    column = qMin( start + match.length() - 1, nbCols );
-                    chunkList << LineChunk( qMax( start, 0 ), column,
-                                            LineChunk::Highlighted );
-                    column++;
-                }
-                if ( column <= cutLine.length() - 1 )
-                    chunkList << LineChunk( column, cutLine.length() - 1, LineChunk::Normal );
-
-                // Then we add the selection if needed
-                QList<LineChunk> newChunkList;
-                if ( isSelection ) {
-                    sel_start -= firstCol; // coord in line space
-                    sel_end   -= firstCol;
-
-                    foreach ( const LineChunk chunk, chunkList ) {
-                        newChunkList << chunk.select( sel_start, sel_end );
+            const QList<QuickFindMatch>& qfMatchList = attributes->matches();
+            bool isMatch = ! qfMatchList.isEmpty();
+
+            // The text is drawn in an image kept in the cache, so the
+            // line doesn't have to be drawn again while its style
+            // doesn't change.
+            const int lineWidth =
+                CONTENT_MARGIN_WIDTH + cutLine.length() * charWidth_;
+            const LineRenderCache::Style style( firstCol, nbCols,
+                    selection_.isLineSelected( i ),
+                    isSelection ? sel_start : -1,
+                    isSelection ? sel_end : -1 );
+            QPixmap image;
+            const QPixmap* cachedImage = renderCache_.findPixmap( i, style );
+            if ( cachedImage != NULL ) {
+                image = *cachedImage;
+                nbLinesFromCache++;
+            }
+            else {
+                image = QPixmap( lineWidth * pixelRatio, fontHeight * pixelRatio );
+#if QT_VERSION >= 0x050100
+                image.setDevicePixelRatio( pixelRatio );
+#endif
+                image.fill( backColor );
+
+                QPainter linePainter( &image );
+                linePainter.setFont( painter.font() );
+
+                if ( isSelection || isMatch ) {
+                    // We use the LineDrawer and its chunks because the
+                    // line has to be somehow highlighted
+                    LineDrawer lineDrawer( backColor );
+
+                    // First we create a list of chunks with the highlights
+                    QList<LineChunk> chunkList;
+                    int column = 0; // Current column in line space
+                    foreach( const QuickFindMatch match, qfMatchList ) {
+                        int start = match.startColumn() - firstCol;
+                        int end = start + match.length();
+                        // Ignore matches that are *completely* outside view area
+                        if ( ( start < 0 && end < 0 ) || start >= nbCols )
+                            continue;
+                        if ( start > column )
+                            chunkList << LineChunk( column, start - 1, LineChunk::Normal );
+                        column = qMin( start + match.length() - 1, nbCols );
+                        chunkList << LineChunk( qMax( start, 0 ), column,
+                                                LineChunk::Highlighted );
+                        column++;
                     }
-                }
-                else
-                    newChunkList = chunkList;
-
-                foreach ( const LineChunk chunk, newChunkList ) {
-                    // Select the colours
-                    QColor fore;
-                    QColor back;
-                    switch ( chunk.type() ) {
-                        case LineChunk::Normal:
-                            fore = foreColor;
-                            back = backColor;
-                            break;
-                        case LineChunk::Highlighted:
-                            fore = QColor( "black" );
-                            back = QColor( "yellow" );
-                            // fore = highlightForeColor;
-                            // back = highlightBackColor;
-                            break;
-                        case LineChunk::Selected:
-                            fore = palette.color( QPalette::HighlightedText ),
-                            back = palette.color( QPalette::Highlight );
-                            break;
+                    if ( column <= cutLine.length() - 1 )
+                        chunkList << LineChunk( column, cutLine.length() - 1, LineChunk::Normal );
+
+                    // Then we add the selection if needed
+                    QList<LineChunk> newChunkList;
+                    if ( isSelection ) {
+                        sel_start -= firstCol; // coord in line space
+                        sel_end   -= firstCol;
+
+                        foreach ( const LineChunk chunk, chunkList ) {
+                            newChunkList << chunk.select( sel_start, sel_end );
+                        }
                     }
-                    lineDrawer.addChunk ( chunk, fore, back );
+                    else
+                        newChunkList = chunkList;
+
+                    foreach ( const LineChunk chunk, newChunkList ) {
+                        // Select the colours
+                        QColor fore;
+                        QColor back;
+                        switch ( chunk.type() ) {
+                            case LineChunk::Normal:
+                                fore = foreColor;
+                                back = backColor;
+                                break;
+                            case LineChunk::Highlighted:
+                                fore = QColor( "black" );
+                                back = QColor( "yellow" );
+                                // fore = highlightForeColor;
+                                // back = highlightBackColor;
+                                break;
+                            case LineChunk::Selected:
+                                fore = palette.color( QPalette::HighlightedText ),
+                                back = palette.color( QPalette::Highlight );
+                                break;
+                        }
+                        lineDrawer.addChunk ( chunk, fore, back );
+                    }
+
+                    lineDrawer.draw( linePainter, CONTENT_MARGIN_WIDTH, 0,
+                                     lineWidth, cutLine,
+                                     CONTENT_MARGIN_WIDTH );
+                }
+                else {
+                    // Nothing to be highlighted, we print the whole line!
+                    // (the background, filled above, is extended on the left
+                    // to cover the small margin, it looks better (LineDrawer
+                    // does the same) )
+                    linePainter.setPen( foreColor );
+                    linePainter.drawText( CONTENT_MARGIN_WIDTH, fontAscent, cutLine );
                 }
 
-                lineDrawer.draw( painter, xPos, yPos,
-                                 viewport()->width(), cutLine,
-                                 CONTENT_MARGIN_WIDTH );
-            }
-            else {
-                // Nothing to be highlighted, we print the whole line!
-                painter.fillRect( xPos - CONTENT_MARGIN_WIDTH, yPos,
-                        viewport()->width(), fontHeight, backColor );
-                // (the rectangle is extended on the left to cover the small
-                // margin, it looks better (LineDrawer does the same) )
-                painter.setPen( foreColor );
-                painter.drawText( xPos, yPos + fontAscent, cutLine );
+                linePainter.end();
+                renderCache_.insertPixmap( i, style, image );
             }
 
+            painter.drawPixmap( xPos - CONTENT_MARGIN_WIDTH, yPos, image );
+            // The rest of the line is just background
+            painter.fillRect( xPos - CONTENT_MARGIN_WIDTH + lineWidth, yPos,
+                    viewport()->width(), fontHeight, backColor );
+            nbLinesDrawn++;
+
             // Then draw the bullet
             painter.setPen( palette.color( QPalette::Text ) );
             const int circleSize = 3;
@@ -894,12 +996,27 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
         } // For each line
     }
     LOG(logDEBUG4) << "End of repaint";
+
+    // Frame timing
+    const qint64 paintTime = paintTimer.nsecsElapsed() / 1000;
+    PerfCounters::record( PerfCounters::PaintTime, paintTime );
+    PerfCounters::add( PerfCounters::RenderCacheHits, nbLinesFromCache );
+    PerfCounters::add( PerfCounters::RenderCacheMisses,
+            nbLinesDrawn - nbLinesFromCache );
+    LOG(logDEBUG) << "paintEvent: " << nbLinesDrawn << " lines drawn ("
+        << nbLinesFromCache << " from cache) in " << paintTime << " us";
+
+    if ( followChangeTime_ >= 0 ) {
+        PerfCounters::record( PerfCounters::FollowLatency,
+                Tracer::now() - followChangeTime_ );
+        followChangeTime_ = -1;
+    }
 }
 
 // These two functions are virtual and this implementation is clearly
 // only valid for a non-filtered display.
 // We count on the 'filtered' derived classes to override them.
-qint64 AbstractLogView::displayLineNumber( int lineNumber ) const
+qint64 AbstractLogView::displayLineNumber( qint64 lineNumber ) const
 {
     return lineNumber + 1; // show a 1-based index
 }
@@ -916,25 +1033,22 @@ void AbstractLogView::setOverview( Overview* overview,
     overviewWidget_ = overview_widget;
 
     if ( overviewWidget_ ) {
-        connect( overviewWidget_, SIGNAL( lineClicked ( int ) ),
+        connect( overviewWidget_, SIGNAL( lineClicked ( qint64 ) ),
                 this, SIGNAL( followDisabled() ) );
-        connect( overviewWidget_, SIGNAL( lineClicked ( int ) ),
-                this, SLOT( jumpToLine( int ) ) );
+        connect( overviewWidget_, SIGNAL( lineClicked ( qint64 ) ),
+                this, SLOT( jumpToLine( qint64 ) ) );
     }
     refreshOverview();
 }
 
+// The search runs in the background, its result is received by
+// handleQuickFindFinished()
 void AbstractLogView::searchUsingFunction(
-        qint64 (QuickFind::*search_function)() )
+        void (QuickFind::*search_function)() )
 {
     emit followDisabled();
 
-    int line = (quickFind_.*search_function)();
-    if ( line >= 0 ) {
-        LOG(logDEBUG) << "search " << line;
-        displayLine( line );
-        emit updateLineNumber( line );
-    }
+    (quickFind_.*search_function)();
 }
 
 void AbstractLogView::searchForward()
@@ -998,9 +1112,34 @@ void AbstractLogView::handlePatternUpdated()
     LOG(logDEBUG) << "AbstractLogView::handlePatternUpdated()";
 
     quickFind_.resetLimits();
+    updateQuickFindOverview();
     update();
 }
 
+// Show the QuickFind matches indexed so far on the overview
+void AbstractLogView::updateQuickFindOverview()
+{
+    if ( overview_ == NULL )
+        return;
+
+    MatchHistogram histogram;
+    quickFind_.getMatchHistogram( &histogram );
+    overview_->setQuickFindMatches( histogram );
+
+    if ( overviewWidget_ )
+        overviewWidget_->update();
+}
+
+// Show the line found by QuickFind
+void AbstractLogView::handleQuickFindFinished( qint64 line )
+{
+    if ( line >= 0 ) {
+        LOG(logDEBUG) << "search " << line;
+        displayLine( line );
+        emit updateLineNumber( line );
+    }
+}
+
 // OR the current with the current search expression
 void AbstractLogView::addToSearch()
 {
@@ -1063,8 +1202,23 @@ void AbstractLogView::updateData()
     // Crop selection if it become out of range
     selection_.crop( logData->getNbLine() - 1 );
 
-    // Adapt the scroll bars to the new content
-    verticalScrollBar()->setRange( 0, logData->getNbLine()-1 );
+    // The last line might have been completed, the lines before it are
+    // the same if only new lines have been added
+    renderCache_.forgetFrom( qMax<qint64>( nbLinesUpdated_ - 1, 0 ) );
+    nbLinesUpdated_ = logData->getNbLine();
+
+    // Adapt the scroll bars to the new content, the value is moved
+    // to the new scale first so the range doesn't clip it
+    const qint64 scale =
+        ( logData->getNbLine() - 1 ) / std::numeric_limits<int>::max() + 1;
+    if ( scale != verticalScrollScale_ ) {
+        verticalScrollScale_ = scale;
+        verticalScrollBar()->setValue( firstLine / verticalScrollScale_ );
+        verticalScrollBar()->setPageStep(
+                qMax<qint64>( getNbVisibleLines() / verticalScrollScale_, 1 ) );
+    }
+    verticalScrollBar()->setRange( 0,
+            ( logData->getNbLine() - 1 ) / verticalScrollScale_ );
     const int hScrollMaxValue = ( logData->getMaxLength() - getNbVisibleCols() + 1 ) > 0 ?
         ( logData->getMaxLength() - getNbVisibleCols() + 1 ) : 0;
     horizontalScrollBar()->setRange( 0, hScrollMaxValue );
@@ -1088,6 +1242,12 @@ void AbstractLogView::updateData()
     update();
 }
 
+void AbstractLogView::measureFollowLatency( qint64 changeTime )
+{
+    if ( followMode_ && changeTime >= 0 )
+        followChangeTime_ = changeTime;
+}
+
 void AbstractLogView::updateDisplaySize()
 {
     // Font is assumed to be mono-space (is restricted by options dialog)
@@ -1097,11 +1257,15 @@ void AbstractLogView::updateDisplaySize()
     // following give the right result, not sure why:
     charWidth_ = fm.width( QChar('a') );
 
+    // The images of the lines are drawn with the old font
+    renderCache_.clear();
+
     // Calculate the index of the last line shown
     lastLine = qMin( logData->getNbLine(), firstLine + getNbVisibleLines() );
 
     // Update the scroll bars
-    verticalScrollBar()->setPageStep( getNbVisibleLines() );
+    verticalScrollBar()->setPageStep(
+            qMax<qint64>( getNbVisibleLines() / verticalScrollScale_, 1 ) );
 
     const int hScrollMaxValue = ( logData->getMaxLength() - getNbVisibleCols() + 1 ) > 0 ?
         ( logData->getMaxLength() - getNbVisibleCols() + 1 ) : 0;
@@ -1117,7 +1281,7 @@ void AbstractLogView::updateDisplaySize()
                 OVERVIEW_WIDTH - 1, viewport()->height() );
 }
 
-int AbstractLogView::getTopLine() const
+qint64 AbstractLogView::getTopLine() const
 {
     return firstLine;
 }
@@ -1133,7 +1297,7 @@ void AbstractLogView::selectAll()
     update();
 }
 
-void AbstractLogView::selectAndDisplayLine( int line )
+void AbstractLogView::selectAndDisplayLine( qint64 line )
 {
     emit followDisabled();
     selection_.selectLine( line );
@@ -1143,15 +1307,14 @@ void AbstractLogView::selectAndDisplayLine( int line )
 
 // The difference between this function and displayLine() is quite
 // subtle: this one always jump, even if the line passed is visible.
-void AbstractLogView::jumpToLine( int line )
+void AbstractLogView::jumpToLine( qint64 line )
 {
     // Put the selected line in the middle if possible
-    int newTopLine = line - ( getNbVisibleLines() / 2 );
+    qint64 newTopLine = line - ( getNbVisibleLines() / 2 );
     if ( newTopLine < 0 )
         newTopLine = 0;
 
-    // This will also trigger a scrollContents event
-    verticalScrollBar()->setValue( newTopLine );
+    setTopLine( newTopLine );
 }
 
 void AbstractLogView::setLineNumbersVisible( bool lineNumbersVisible )
@@ -1176,18 +1339,18 @@ int AbstractLogView::getNbVisibleCols() const
 }
 
 // Converts the mouse x, y coordinates to the line number in the file
-int AbstractLogView::convertCoordToLine(int yPos) const
+qint64 AbstractLogView::convertCoordToLine(int yPos) const
 {
-    int line = firstLine + yPos / charHeight_;
+    qint64 line = firstLine + yPos / charHeight_;
 
     return line;
 }
 
 // Converts the mouse x, y coordinates to the char coordinates (in the file)
 // This function ensure the pos exists in the file.
-QPoint AbstractLogView::convertCoordToFilePos( const QPoint& pos ) const
+FilePosition AbstractLogView::convertCoordToFilePos( const QPoint& pos ) const
 {
-    int line = firstLine + pos.y() / charHeight_;
+    qint64 line = firstLine + pos.y() / charHeight_;
     if ( line >= logData->getNbLine() )
         line = logData->getNbLine() - 1;
     if ( line < 0 )
@@ -1196,8 +1359,7 @@ QPoint AbstractLogView::convertCoordToFilePos( const QPoint& pos ) const
     // Determine column in screen space and convert it to file space
     int column = firstCol + ( pos.x() - leftMarginPx_ ) / charWidth_;
 
-    QString this_line = logData->getExpandedLineString( line );
-    const int length = this_line.length();
+    const int length = logData->getLineLength( line );
 
     if ( column >= length )
         column = length - 1;
@@ -1206,14 +1368,32 @@ QPoint AbstractLogView::convertCoordToFilePos( const QPoint& pos ) const
 
     LOG(logDEBUG4) << "AbstractLogView::convertCoordToFilePos col="
         << column << " line=" << line;
-    QPoint point( column, line );
+    FilePosition position( line, column );
 
-    return point;
+    return position;
+}
+
+// Scroll the view so the passed line is at the top.
+// The scroll bar only moves by steps of verticalScrollScale_ lines on very
+// long files, so in that case firstLine is set here and scrollContentsBy()
+// keeps it as long as it matches the scroll bar.
+void AbstractLogView::setTopLine( qint64 line )
+{
+    if ( verticalScrollScale_ == 1 ) {
+        // This will also trigger a scrollContents event
+        verticalScrollBar()->setValue( line );
+    }
+    else {
+        firstLine = line;
+        verticalScrollBar()->setValue( line / verticalScrollScale_ );
+        // In case the scroll bar hasn't moved
+        scrollContentsBy( 0, 0 );
+    }
 }
 
 // Makes the widget adjust itself to display the passed line.
 // Doing so, it will throw itself a scrollContents event.
-void AbstractLogView::displayLine( int line )
+void AbstractLogView::displayLine( qint64 line )
 {
     // If the line is already the screen
     if ( ( line >= firstLine ) &&
@@ -1225,13 +1405,56 @@ void AbstractLogView::displayLine( int line )
     }
 }
 
+void AbstractLogView::cacheRenderAttributes( qint64 first, int number,
+        const FilterSet& filterSet )
+{
+    QList<int> missing;
+    for ( int i = 0; i < number; i++ ) {
+        if ( renderCache_.find( first + i ) == NULL )
+            missing << i;
+    }
+
+    if ( missing.isEmpty() )
+        return;
+
+    // The filters apply to the lines as they are in the file,
+    // they are read in one go and classified together.
+    const int nbLinesToRead = missing.last() - missing.first() + 1;
+    const QStringList rawLines = logData->getLines(
+            first + missing.first(), nbLinesToRead );
+    const QStringList expandedLines = logData->getExpandedLines(
+            first + missing.first(), nbLinesToRead );
+    if ( rawLines.size() < nbLinesToRead
+            || expandedLines.size() < nbLinesToRead )
+        return;
+
+    QStringList linesToMatch;
+    foreach ( int i, missing )
+        linesToMatch << rawLines[i - missing.first()];
+
+    QVector<int> filters;
+    filterSet.matchLines( linesToMatch, &filters );
+
+    for ( int n = 0; n < missing.size(); n++ ) {
+        const int i = missing[n];
+        LineRenderCache::Attributes attributes = ( filters[n] != -1 ) ?
+            LineRenderCache::Attributes( filterSet.foreColor( filters[n] ),
+                    filterSet.backColor( filters[n] ) ) :
+            LineRenderCache::Attributes();
+        quickFindPattern_->matchLine( expandedLines[i - missing.first()],
+                attributes.matches() );
+
+        renderCache_.insert( first + i, attributes );
+    }
+}
+
 // Move the selection up and down by the passed number of lines
 void AbstractLogView::moveSelection( int delta )
 {
     LOG(logDEBUG) << "AbstractLogView::moveSelection delta=" << delta;
 
-    QList<int> selection = selection_.getLines();
-    int new_line;
+    QList<qint64> selection = selection_.getLines();
+    qint64 new_line;
 
     // If nothing is selected, do as if line -1 was.
     if ( selection.isEmpty() )
@@ -1262,11 +1485,11 @@ void AbstractLogView::jumpToStartOfLine()
 // Make the end of the lines in the selection visible
 void AbstractLogView::jumpToEndOfLine()
 {
-    QList<int> selection = selection_.getLines();
+    QList<qint64> selection = selection_.getLines();
 
     // Search the longest line in the selection
     int max_length = 0;
-    foreach ( int line, selection ) {
+    foreach ( qint64 line, selection ) {
         int length = logData->getLineLength( line );
         if ( length > max_length )
             max_length = length;
@@ -1278,11 +1501,9 @@ void AbstractLogView::jumpToEndOfLine()
 // Make the end of the lines on the screen visible
 void AbstractLogView::jumpToRightOfScreen()
 {
-    QList<int> selection = selection_.getLines();
-
     // Search the longest line on screen
     int max_length = 0;
-    for ( int i = firstLine; i <= ( firstLine + getNbVisibleLines() ); i++ ) {
+    for ( qint64 i = firstLine; i <= ( firstLine + getNbVisibleLines() ); i++ ) {
         int length = logData->getLineLength( i );
         if ( length > max_length )
             max_length = length;
@@ -1294,19 +1515,17 @@ void AbstractLogView::jumpToRightOfScreen()
 // Jump to the first line
 void AbstractLogView::jumpToTop()
 {
-    // This will also trigger a scrollContents event
-    verticalScrollBar()->setValue( 0 );
+    setTopLine( 0 );
     update();       // in case the screen hasn't moved
 }
 
 // Jump to the last line
 void AbstractLogView::jumpToBottom()
 {
-    const int new_top_line =
+    const qint64 new_top_line =
         qMax( logData->getNbLine() - getNbVisibleLines() + 1, 0LL );
 
-    // This will also trigger a scrollContents event
-    verticalScrollBar()->setValue( new_top_line );
+    setTopLine( new_top_line );
     update();       // in case the screen hasn't moved
 }
 
@@ -1323,10 +1542,10 @@ inline bool AbstractLogView::isCharWord( char c )
 }
 
 // Select the word under the given position
-void AbstractLogView::selectWordAtPosition( const QPoint& pos )
+void AbstractLogView::selectWordAtPosition( const FilePosition& pos )
 {
-    const int x = pos.x();
-    const QString line = logData->getExpandedLineString( pos.y() );
+    const int x = pos.column();
+    const QString line = logData->getExpandedLineString( pos.line() );
 
     if ( isCharWord( line[x].toLatin1() ) ) {
         // Search backward for the first character in the word
@@ -1349,7 +1568,7 @@ void AbstractLogView::selectWordAtPosition( const QPoint& pos )
             currentPos--;
         int end = currentPos;
 
-        selection_.selectPortion( pos.y(), start, end );
+        selection_.selectPortion( pos.line(), start, end );
         updateGlobalSelection();
         update();
     }
@@ -1404,7 +1623,7 @@ void AbstractLogView::createMenu()
 
 void AbstractLogView::considerMouseHovering( int x_pos, int y_pos )
 {
-    int line = convertCoordToLine( y_pos );
+    qint64 line = convertCoordToLine( y_pos );
     if ( ( x_pos < leftMarginPx_ )
             && ( line >= 0 )
             && ( line < logData->getNbLine() ) ) {
@@ -28,10 +28,12 @@
 #include "quickfind.h"
 #include "overviewwidget.h"
 #include "quickfindmux.h"
+#include "linerendercache.h"
 
 class QMenu;
 class QAction;
 class AbstractLogData;
+class FilterSet;
 
 class LineChunk
 {
@@ -125,7 +127,7 @@ class DigitsBuffer : public QObject
     // the timeout timer is reset.
     void add( char character );
     // Get the content of the buffer (0 if empty) and reset it.
-    int content();
+    qint64 content();
 
   protected:
     void timerEvent( QTimerEvent* event );
@@ -158,11 +160,15 @@ class AbstractLogView :
 
     // Refresh the widget when the data set has changed.
     void updateData();
+    // Record, at the end of the next repaint, the time it took to display
+    // the new lines of a followed file since their notification at the
+    // passed time (Tracer::now()), nothing if not following the file.
+    void measureFollowLatency( qint64 changeTime );
     // Instructs the widget to update it's content geometry,
     // used when the font is changed.
     void updateDisplaySize();
     // Return the line number of the top line of the view
-    int getTopLine() const;
+    qint64 getTopLine() const;
     // Return the text of the current selection.
     QString getSelection() const;
     // Instructs the widget to select the whole text.
@@ -184,10 +190,10 @@ class AbstractLogView :
     // Must be implemented to return wether the line number is
     // a match, a mark or just a normal line (used for coloured bullets)
     enum LineType { Normal, Marked, Match };
-    virtual LineType lineType( int lineNumber ) const = 0;
+    virtual LineType lineType( qint64 lineNumber ) const = 0;
 
     // Line number to display for line at the given index
-    virtual qint64 displayLineNumber( int lineNumber ) const;
+    virtual qint64 displayLineNumber( qint64 lineNumber ) const;
     virtual qint64 maxDisplayLineNumber() const;
 
     // Get the overview associated with this view, or NULL if there is none
@@ -197,14 +203,14 @@ class AbstractLogView :
 
   signals:
     // Sent when a new line has been selected by the user.
-    void newSelection(int line);
+    void newSelection( qint64 line );
     // Sent up to the MainWindow to disable the follow mode
     void followDisabled();
     // Sent when the view wants the QuickFind widget pattern to change.
     void changeQuickFind( const QString& newPattern,
             QuickFindMux::QFDirection newDirection );
     // Sent up when the current line number is updated
-    void updateLineNumber( int line );
+    void updateLineNumber( qint64 line );
     // Sent up when quickFind wants to show a message to the user.
     void notifyQuickFind( const QFNotification& message );
     // Sent up when quickFind wants to clear the notification.
@@ -225,7 +231,7 @@ class AbstractLogView :
   public slots:
     // Makes the widget select and display the passed line.
     // Scrolling as necessary
-    void selectAndDisplayLine( int line );
+    void selectAndDisplayLine( qint64 line );
 
     // Use the current QFP to go and select the next match.
     virtual void searchForward();
@@ -250,13 +256,19 @@ class AbstractLogView :
     // Make the view jump to the specified line, regardless of weither it
     // is on the screen or not.
     // (does NOT emit followDisabled() )
-    void jumpToLine( int line );
+    void jumpToLine( qint64 line );
 
     // Configure the setting of whether to show line number margin
     void setLineNumbersVisible( bool lineNumbersVisible );
 
+    // Make the view display the last lines
+    // (does NOT emit followDisabled() )
+    void jumpToBottom();
+
   private slots:
     void handlePatternUpdated();
+    void handleQuickFindFinished( qint64 line );
+    void updateQuickFindOverview();
     void addToSearch();
     void findNextSelected();
     void findPreviousSelected();
@@ -297,9 +309,9 @@ class AbstractLogView :
 
     bool selectionStarted_;
     // Start of the selection (characters)
-    QPoint selectionStartPos_;
+    FilePosition selectionStartPos_;
     // Current end of the selection (characters)
-    QPoint selectionCurrentEndPos_;
+    FilePosition selectionCurrentEndPos_;
     QBasicTimer autoScrollTimer_;
 
     // Hovering state
@@ -314,6 +326,9 @@ class AbstractLogView :
     qint64 firstLine;
     qint64 lastLine;
     int firstCol;
+    // Number of lines per step of the vertical scroll bar, which
+    // only has an int range (1 unless the file is that long)
+    qint64 verticalScrollScale_;
 
     // Text handling
     int charWidth_;
@@ -331,26 +346,41 @@ class AbstractLogView :
     // Our own QuickFind object
     QuickFind quickFind_;
 
+    // Filter colours and QuickFind matches of the lines displayed
+    LineRenderCache renderCache_;
+    // Number of lines at the last updateData(), the lines before the
+    // last of them are unchanged by an update (unless the generation
+    // of the data changes)
+    qint64 nbLinesUpdated_;
+    // Time the lines to display next were notified (-1 if not measured)
+    qint64 followChangeTime_;
+
     int getNbVisibleLines() const;
     int getNbVisibleCols() const;
-    QPoint convertCoordToFilePos( const QPoint& pos ) const;
-    int convertCoordToLine( int yPos ) const;
+    FilePosition convertCoordToFilePos( const QPoint& pos ) const;
+    qint64 convertCoordToLine( int yPos ) const;
     int convertCoordToColumn( int xPos ) const;
-    void displayLine( int line );
+    void displayLine( qint64 line );
+    void setTopLine( qint64 line );
     void moveSelection( int y );
     void jumpToStartOfLine();
     void jumpToEndOfLine();
     void jumpToRightOfScreen();
     void jumpToTop();
-    void jumpToBottom();
-    void selectWordAtPosition( const QPoint& pos );
+    void selectWordAtPosition( const FilePosition& pos );
 
     void createMenu();
 
     void considerMouseHovering( int x_pos, int y_pos );
 
+    // Match the lines displayed which are not in renderCache_ against
+    // the filters and the QuickFind pattern, and cache the result
+    // (only these lines are read entirely)
+    void cacheRenderAttributes( qint64 first, int number,
+            const FilterSet& filterSet );
+
     // Search functions (for n/N)
-    void searchUsingFunction ( qint64 (QuickFind::*search_function)() );
+    void searchUsingFunction ( void (QuickFind::*search_function)() );
 
     // Utils functions
     bool isCharWord( char c );
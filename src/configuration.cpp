@@ -32,8 +32,13 @@ Configuration::Configuration()
     mainRegexpType_               = ExtendedRegexp;
     quickfindRegexpType_          = FixedString;
     quickfindIncremental_         = true;
+    searchAsYouType_              = false;
+    searchIndexEnabled_           = false;
+    maxRefreshRate_               = 20;
+    pollingMode_                  = PollingOnNetwork;
 
     overviewVisible_              = true;
+    histogramVisible_             = true;
     lineNumbersVisibleInMain_     = false;
     lineNumbersVisibleInFiltered_ = true;
 
@@ -73,10 +78,21 @@ void Configuration::retrieveFromStorage( QSettings& settings )
             settings.value( "regexpType.quickfind", quickfindRegexpType_ ).toInt() );
     if ( settings.contains( "quickfind.incremental" ) )
         quickfindIncremental_ = settings.value( "quickfind.incremental" ).toBool();
+    if ( settings.contains( "search.asYouType" ) )
+        searchAsYouType_ = settings.value( "search.asYouType" ).toBool();
+    if ( settings.contains( "search.index" ) )
+        searchIndexEnabled_ = settings.value( "search.index" ).toBool();
+    if ( settings.contains( "file.maxRefreshRate" ) )
+        maxRefreshRate_ = settings.value( "file.maxRefreshRate" ).toInt();
+    if ( settings.contains( "file.polling" ) )
+        pollingMode_ = static_cast<FilePollingMode>(
+                settings.value( "file.polling" ).toInt() );
 
     // View settings
     if ( settings.contains( "view.overviewVisible" ) )
         overviewVisible_ = settings.value( "view.overviewVisible" ).toBool();
+    if ( settings.contains( "view.histogramVisible" ) )
+        histogramVisible_ = settings.value( "view.histogramVisible" ).toBool();
     if ( settings.contains( "view.lineNumbersVisibleInMain" ) )
         lineNumbersVisibleInMain_ =
             settings.value( "view.lineNumbersVisibleInMain" ).toBool();
@@ -100,7 +116,12 @@ void Configuration::saveToStorage( QSettings& settings ) const
     settings.setValue( "regexpType.main", static_cast<int>( mainRegexpType_ ) );
     settings.setValue( "regexpType.quickfind", static_cast<int>( quickfindRegexpType_ ) );
     settings.setValue( "quickfind.incremental", quickfindIncremental_ );
+    settings.setValue( "search.asYouType", searchAsYouType_ );
+    settings.setValue( "search.index", searchIndexEnabled_ );
+    settings.setValue( "file.maxRefreshRate", maxRefreshRate_ );
+    settings.setValue( "file.polling", static_cast<int>( pollingMode_ ) );
     settings.setValue( "view.overviewVisible", overviewVisible_ );
+    settings.setValue( "view.histogramVisible", histogramVisible_ );
     settings.setValue( "view.lineNumbersVisibleInMain", lineNumbersVisibleInMain_ );
     settings.setValue( "view.lineNumbersVisibleInFiltered", lineNumbersVisibleInFiltered_ );
 }
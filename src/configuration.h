@@ -32,6 +32,13 @@ enum SearchRegexpType {
     FixedString,
 };
 
+// When to poll the files for changes, in addition to watching them
+enum FilePollingMode {
+    PollingOnNetwork,
+    PollingAlways,
+    PollingNever,
+};
+
 // Configuration class containing everything in the "Settings" dialog
 class Configuration : public Persistable {
   public:
@@ -54,12 +61,34 @@ class Configuration : public Persistable {
     { quickfindRegexpType_ = type; }
     void setQuickfindIncremental( bool is_incremental )
     { quickfindIncremental_ = is_incremental; }
+    bool isSearchAsYouType() const
+    { return searchAsYouType_; }
+    void setSearchAsYouType( bool as_you_type )
+    { searchAsYouType_ = as_you_type; }
+    bool isSearchIndexEnabled() const
+    { return searchIndexEnabled_; }
+    void setSearchIndexEnabled( bool enabled )
+    { searchIndexEnabled_ = enabled; }
+    // Times per second at most a changing file is refreshed
+    int maxRefreshRate() const
+    { return maxRefreshRate_; }
+    void setMaxRefreshRate( int refreshesPerSecond )
+    { maxRefreshRate_ = refreshesPerSecond; }
+    // When the files are polled for changes
+    FilePollingMode pollingMode() const
+    { return pollingMode_; }
+    void setPollingMode( FilePollingMode mode )
+    { pollingMode_ = mode; }
 
     // View settings
     bool isOverviewVisible() const
     { return overviewVisible_; }
     void setOverviewVisible( bool isVisible )
     { overviewVisible_ = isVisible; }
+    bool isHistogramVisible() const
+    { return histogramVisible_; }
+    void setHistogramVisible( bool isVisible )
+    { histogramVisible_ = isVisible; }
     bool mainLineNumbersVisible() const
     { return lineNumbersVisibleInMain_; }
     bool filteredLineNumbersVisible() const
@@ -79,9 +108,14 @@ class Configuration : public Persistable {
     SearchRegexpType mainRegexpType_;
     SearchRegexpType quickfindRegexpType_;
     bool quickfindIncremental_;
+    bool searchAsYouType_;
+    bool searchIndexEnabled_;
+    int maxRefreshRate_;
+    FilePollingMode pollingMode_;
 
     // View settings
     bool overviewVisible_;
+    bool histogramVisible_;
     bool lineNumbersVisibleInMain_;
     bool lineNumbersVisibleInFiltered_;
 };
@@ -35,24 +35,44 @@
 #include <QStandardItemModel>
 #include <QHeaderView>
 #include <QListView>
+#include <QMessageBox>
+#include <QPushButton>
 
 #include "crawlerwidget.h"
 
 #include "quickfindpattern.h"
 #include "overview.h"
+#include "histogramwidget.h"
 #include "infoline.h"
 #include "savedsearches.h"
 #include "quickfindwidget.h"
 #include "persistentinfo.h"
 #include "configuration.h"
+#include "data/regexpbudget.h"
 
 // Palette for error signaling (yellow background)
 const QPalette CrawlerWidget::errorPalette( QColor( "yellow" ) );
 
+// Typing pause after which the search is started in "search as you type" mode
+const int CrawlerWidget::searchAsYouTypeDelay = 300;
+
+// Polling mode of the file watcher for the one configured
+static FileWatcher::PollingMode watcherPollingMode( FilePollingMode mode )
+{
+    switch ( mode ) {
+        case PollingAlways:
+            return FileWatcher::PollAlways;
+        case PollingNever:
+            return FileWatcher::PollNever;
+        default:
+            return FileWatcher::PollNetworkFiles;
+    }
+}
+
 // Constructor only does trivial construction. The real work is done once
 // the data is attached.
 CrawlerWidget::CrawlerWidget( QWidget *parent )
-        : QSplitter( parent ), overview_()
+        : QSplitter( parent ), searchAsYouTypeTimer_(), overview_()
 {
     logData_         = nullptr;
     logFilteredData_ = nullptr;
@@ -66,10 +86,17 @@ CrawlerWidget::CrawlerWidget( QWidget *parent )
     loadingInProgress_ = true;
 
     currentLineNumber_ = 0;
+
+    filteredViewAnchored_   = false;
+    fixedStringOffered_     = false;
+    filteredViewAnchorLine_ = 0;
+
+    lastSearchSyntax_          = ConfiguredSyntax;
+    searchAfterRotationSyntax_ = ConfiguredSyntax;
 }
 
 // The top line is first one on the main display
-int CrawlerWidget::getTopLine() const
+qint64 CrawlerWidget::getTopLine() const
 {
     return logMainView->getTopLine();
 }
@@ -87,6 +114,30 @@ void CrawlerWidget::selectAll()
     activeView()->selectAll();
 }
 
+bool CrawlerWidget::hasTimestamps() const
+{
+    return logData_->hasTimestamps();
+}
+
+bool CrawlerWidget::goToTime( const QString& time )
+{
+    const qint64 timestamp =
+        logData_->parseUserTime( time, logMainView->getTopLine() );
+    if ( timestamp < 0 )
+        return false;
+
+    const qint64 line = logData_->getLineFromTimestamp( timestamp );
+    if ( line < 0 )
+        return false;
+
+    LOG(logDEBUG) << "goToTime " << time.toStdString() << ": line " << line;
+
+    logMainView->selectAndDisplayLine(
+            qMin( line, logData_->getNbLine() - 1 ) );
+
+    return true;
+}
+
 // Return a pointer to the view in which we should do the QuickFind
 SearchableWidgetInterface* CrawlerWidget::doGetActiveSearchable() const
 {
@@ -125,6 +176,7 @@ void CrawlerWidget::reload()
     searchState_.resetState();
     logFilteredData_->clearSearch();
     filteredView->updateData();
+    histogramWidget_->clear();
     printSearchInfoMessage();
 
     logData_->reload();
@@ -163,6 +215,9 @@ void CrawlerWidget::doSetSavedSearches(
 
 void CrawlerWidget::startNewSearch()
 {
+    // The search is started now, no need to wait for the user
+    searchAsYouTypeTimer_.stop();
+
     // Record the search line in the recent list
     // (reload the list first in case another glogg changed it)
     GetPersistentInfo().retrieve( "savedSearches" );
@@ -171,8 +226,22 @@ void CrawlerWidget::startNewSearch()
 
     // Update the SearchLine (history)
     updateSearchCombo();
+
+    const QString text = searchLineEdit->currentText();
+    SearchSyntax searchSyntax = ConfiguredSyntax;
+
+    // A single line could keep the search busy for hours, the user must
+    // choose another way to search before starting
+    if ( isSearchRisky( text ) && ! askSearchSyntax( text,
+                tr( "The expression contains a repeated group which is "
+                    "itself repeated (like \"(a+)+\"), the time needed to "
+                    "match such expressions can grow exponentially with "
+                    "the length of the line." ),
+                true, true, &searchSyntax ) )
+        return;
+
     // Call the private function to do the search
-    replaceCurrentSearch( searchLineEdit->currentText() );
+    replaceCurrentSearch( text, searchSyntax );
 }
 
 void CrawlerWidget::stopSearch()
@@ -188,6 +257,11 @@ void CrawlerWidget::updateFilteredView( int nbMatches, int progress )
     LOG(logDEBUG) << "updateFilteredView received.";
 
     if ( progress == 100 ) {
+        // A search stopped by its budget cannot be refreshed: what it
+        // has not searched would be searched again at every refresh
+        if ( logFilteredData_->isSearchBudgetExhausted() )
+            searchState_.stopSearch();
+
         // Searching done
         printSearchInfoMessage( nbMatches );
         searchInfoLine->hideGauge();
@@ -208,22 +282,42 @@ void CrawlerWidget::updateFilteredView( int nbMatches, int progress )
     }
 
     // Recompute the content of the filtered window.
+    const bool keepAtBottom = filteredViewAnchored_
+        && ( filteredView->getTopLine() == filteredViewAnchorLine_ );
     filteredView->updateData();
 
+    if ( keepAtBottom ) {
+        filteredView->jumpToBottom();
+        filteredViewAnchorLine_ = filteredView->getTopLine();
+    }
+    filteredViewAnchored_ = keepAtBottom && ( progress < 100 );
+
     // Update the match overview
     overview_.updateData( logData_->getNbLine() );
 
+    // And the distribution of the matches
+    histogramWidget_->updateData( logFilteredData_->getMatchHistogram(),
+            logData_->getNbLine() );
+
     // Also update the top window for the coloured bullets.
     update();
+
+    // Asked once per search, from the event loop rather than while
+    // the results are being updated
+    if ( progress == 100 && logFilteredData_->isSearchBudgetExhausted()
+            && ! fixedStringOffered_ ) {
+        fixedStringOffered_ = true;
+        QTimer::singleShot( 0, this, SLOT( offerFixedStringSearch() ) );
+    }
 }
 
-void CrawlerWidget::jumpToMatchingLine(int filteredLineNb)
+void CrawlerWidget::jumpToMatchingLine(qint64 filteredLineNb)
 {
-    int mainViewLine = logFilteredData_->getMatchingLineNumber(filteredLineNb);
+    qint64 mainViewLine = logFilteredData_->getMatchingLineNumber(filteredLineNb);
     logMainView->selectAndDisplayLine(mainViewLine);  // FIXME: should be done with a signal.
 }
 
-void CrawlerWidget::updateLineNumberHandler( int line )
+void CrawlerWidget::updateLineNumberHandler( qint64 line )
 {
     currentLineNumber_ = line;
     emit updateLineNumber( line );
@@ -289,6 +383,12 @@ void CrawlerWidget::applyConfiguration()
     overview_.setVisible( config->isOverviewVisible() );
     logMainView->refreshOverview();
 
+    histogramWidget_->setVisible( config->isHistogramVisible() );
+
+    logFilteredData_->setSearchIndexEnabled( config->isSearchIndexEnabled() );
+    logData_->setMaxRefreshRate( config->maxRefreshRate() );
+    logData_->setPollingMode( watcherPollingMode( config->pollingMode() ) );
+
     logMainView->updateDisplaySize();
     logMainView->update();
     filteredView->updateDisplaySize();
@@ -329,18 +429,41 @@ void CrawlerWidget::loadingFinishedHandler( bool success )
     // FIXME, handle topLine
     // logMainView->updateData( logData_, topLine );
     logMainView->updateData();
+    logMainView->measureFollowLatency( logData_->getChangeTime() );
+
+    // The time window is only useful if we can find the times
+    timeWindowEdit->setVisible( logData_->hasTimestamps() );
 
         // Shall we Forbid starting a search when loading in progress?
         // searchButton->setEnabled( false );
 
     // searchButton->setEnabled( true );
 
-    // See if we need to auto-refresh the search
-    if ( searchState_.isAutorefreshAllowed() ) {
+    // See if we need to search the new file or to auto-refresh the search
+    if ( ! searchAfterRotation_.isEmpty() ) {
+        LOG(logDEBUG) << "Searching the rotated file";
+        if ( success )
+            replaceCurrentSearch( searchAfterRotation_,
+                    searchAfterRotationSyntax_ );
+        searchAfterRotation_.clear();
+    }
+    else if ( searchState_.isAutorefreshAllowed() ) {
         LOG(logDEBUG) << "Refreshing the search";
         logFilteredData_->updateSearch();
     }
 
+    // Use the idle time to index the file for the next searches
+    // (does nothing if disabled or if a search is ongoing)
+    if ( success ) {
+        static std::shared_ptr<Configuration> config =
+            Persistent<Configuration>( "settings" );
+        logFilteredData_->setSearchIndexEnabled( config->isSearchIndexEnabled() );
+        logFilteredData_->buildSearchIndex();
+        logData_->setMaxRefreshRate( config->maxRefreshRate() );
+        logData_->setPollingMode(
+                watcherPollingMode( config->pollingMode() ) );
+    }
+
     emit loadingFinished( success );
 }
 
@@ -354,10 +477,23 @@ void CrawlerWidget::fileChangedHandler( LogData::MonitoredFileStatus status )
             // Invalidate the search
             logFilteredData_->clearSearch();
             filteredView->updateData();
+            histogramWidget_->clear();
             searchState_.truncateFile();
             printSearchInfoMessage();
         }
     }
+    // or replaced by a new file
+    else if ( status == LogData::Rotated ) {
+        // The marks are lost but the search will be done again
+        // on the new file
+        logFilteredData_->clearMarks();
+        if ( searchState_.getState() == SearchState::Static
+                || searchState_.getState() == SearchState::Autorefreshing ) {
+            // The search box might have been edited since the search started
+            searchAfterRotation_       = lastSearchText_;
+            searchAfterRotationSyntax_ = lastSearchSyntax_;
+        }
+    }
 }
 
 // Returns a pointer to the window in which the search should be done
@@ -404,9 +540,34 @@ void CrawlerWidget::searchRefreshChangedHandler( int state )
 
 void CrawlerWidget::searchTextChangeHandler()
 {
+    static std::shared_ptr<Configuration> config =
+        Persistent<Configuration>( "settings" );
+
     // We suspend auto-refresh
     searchState_.changeExpression();
     printSearchInfoMessage( logFilteredData_->getNbMatches() );
+
+    // (Re)start the countdown, the search is started when the user
+    // pauses typing.
+    if ( config->isSearchAsYouType() )
+        searchAsYouTypeTimer_.start();
+}
+
+void CrawlerWidget::startSearchAsYouType()
+{
+    const QString text = searchLineEdit->currentText();
+
+    // Nothing is asked while typing, the user has to start the search
+    if ( isSearchRisky( text ) ) {
+        searchInfoLine->setPalette( errorPalette );
+        searchInfoLine->setText( tr( "The expression might take too long "
+                    "to match, press Enter to search." ) );
+        return;
+    }
+
+    // Not added to the saved searches, only an explicit search is.
+    // The search in progress (if any) is superseded without waiting.
+    replaceCurrentSearch( text );
 }
 
 void CrawlerWidget::changeFilteredViewVisibility( int index )
@@ -521,6 +682,9 @@ void CrawlerWidget::setup()
         } \
 " );
 
+    // Construct the histogram of the matches
+    histogramWidget_ = new HistogramWidget();
+
     // Construct the Search Info line
     searchInfoLine = new InfoLine();
     searchInfoLine->setFrameStyle( QFrame::WinPanel | QFrame::Sunken );
@@ -529,6 +693,10 @@ void CrawlerWidget::setup()
 
     ignoreCaseCheck = new QCheckBox( "Ignore &case" );
     searchRefreshCheck = new QCheckBox( "Auto-&refresh" );
+    newestFirstCheck = new QCheckBox( "&Newest first" );
+    newestFirstCheck->setToolTip(
+            tr("Search from the end of the file, the most recent matches"
+                " are displayed first") );
 
     // Construct the Search line
     searchLabel = new QLabel(tr("&Text: "));
@@ -550,9 +718,17 @@ void CrawlerWidget::setup()
     stopButton->setAutoRaise( true );
     stopButton->setEnabled( false );
 
+    timeWindowEdit = new QLineEdit();
+    timeWindowEdit->setPlaceholderText( tr("Time window") );
+    timeWindowEdit->setToolTip(
+            tr("Only search the lines logged between two times"
+                " (\"from - to\", either can be omitted)") );
+    timeWindowEdit->setVisible( false );
+
     QHBoxLayout* searchLineLayout = new QHBoxLayout;
     searchLineLayout->addWidget(searchLabel);
     searchLineLayout->addWidget(searchLineEdit);
+    searchLineLayout->addWidget(timeWindowEdit);
     searchLineLayout->addWidget(searchButton);
     searchLineLayout->addWidget(stopButton);
     searchLineLayout->setContentsMargins(6, 0, 6, 0);
@@ -564,11 +740,13 @@ void CrawlerWidget::setup()
     searchInfoLineLayout->addWidget( searchInfoLine );
     searchInfoLineLayout->addWidget( ignoreCaseCheck );
     searchInfoLineLayout->addWidget( searchRefreshCheck );
+    searchInfoLineLayout->addWidget( newestFirstCheck );
 
     // Construct the bottom window
     QVBoxLayout* bottomMainLayout = new QVBoxLayout;
     bottomMainLayout->addLayout(searchLineLayout);
     bottomMainLayout->addLayout(searchInfoLineLayout);
+    bottomMainLayout->addWidget(histogramWidget_);
     bottomMainLayout->addWidget(filteredView);
     bottomMainLayout->setContentsMargins(2, 1, 2, 1);
     bottomWindow->setLayout(bottomMainLayout);
@@ -587,22 +765,29 @@ void CrawlerWidget::setup()
             searchButton, SIGNAL( clicked() ));
     connect(searchLineEdit->lineEdit(), SIGNAL( textEdited( const QString& ) ),
             this, SLOT( searchTextChangeHandler() ));
+    connect(timeWindowEdit, SIGNAL( returnPressed() ),
+            searchButton, SIGNAL( clicked() ));
     connect(searchButton, SIGNAL( clicked() ),
             this, SLOT( startNewSearch() ) );
     connect(stopButton, SIGNAL( clicked() ),
             this, SLOT( stopSearch() ) );
 
+    searchAsYouTypeTimer_.setSingleShot( true );
+    searchAsYouTypeTimer_.setInterval( searchAsYouTypeDelay );
+    connect( &searchAsYouTypeTimer_, SIGNAL( timeout() ),
+            this, SLOT( startSearchAsYouType() ) );
+
     connect(visibilityBox, SIGNAL( currentIndexChanged( int ) ),
             this, SLOT( changeFilteredViewVisibility( int ) ) );
 
-    connect(logMainView, SIGNAL( newSelection( int ) ),
+    connect(logMainView, SIGNAL( newSelection( qint64 ) ),
             logMainView, SLOT( update() ) );
-    connect(filteredView, SIGNAL( newSelection( int ) ),
-            this, SLOT( jumpToMatchingLine( int ) ) );
-    connect(filteredView, SIGNAL( newSelection( int ) ),
+    connect(filteredView, SIGNAL( newSelection( qint64 ) ),
+            this, SLOT( jumpToMatchingLine( qint64 ) ) );
+    connect(filteredView, SIGNAL( newSelection( qint64 ) ),
             filteredView, SLOT( update() ) );
-    connect(logMainView, SIGNAL( updateLineNumber( int ) ),
-            this, SLOT( updateLineNumberHandler( int ) ) );
+    connect(logMainView, SIGNAL( updateLineNumber( qint64 ) ),
+            this, SLOT( updateLineNumberHandler( qint64 ) ) );
     connect(logMainView, SIGNAL( markLine( qint64 ) ),
             this, SLOT( markLineFromMain( qint64 ) ) );
     connect(filteredView, SIGNAL( markLine( qint64 ) ),
@@ -613,6 +798,12 @@ void CrawlerWidget::setup()
     connect(filteredView, SIGNAL( addToSearch( const QString& ) ),
             this, SLOT( addToSearch( const QString& ) ) );
 
+    // Clicking on the histogram moves the main view to the bar
+    connect(histogramWidget_, SIGNAL( lineClicked( qint64 ) ),
+            logMainView, SIGNAL( followDisabled() ) );
+    connect(histogramWidget_, SIGNAL( lineClicked( qint64 ) ),
+            logMainView, SLOT( jumpToLine( qint64 ) ) );
+
     connect(filteredView, SIGNAL( mouseHoveredOverLine( qint64 ) ),
             this, SLOT( mouseHoveredOverMatch( qint64 ) ) );
     connect(filteredView, SIGNAL( mouseLeftHoveringZone() ),
@@ -646,26 +837,21 @@ void CrawlerWidget::setup()
 
 // Create a new search using the text passed, replace the currently
 // used one and destroy the old one.
-void CrawlerWidget::replaceCurrentSearch( const QString& searchText )
+void CrawlerWidget::replaceCurrentSearch( const QString& searchText,
+        SearchSyntax searchSyntax )
 {
-    // Interrupt the search if it's ongoing
+    // Interrupt the search if it's ongoing, this does not wait: any update
+    // still in flight from the old search is discarded by logFilteredData_
+    // (a new search supersedes it, as does clearSearch()).
     logFilteredData_->interruptSearch();
 
-    // We have to wait for the last search update (100%)
-    // before clearing/restarting to avoid having remaining results.
-
-    // FIXME: this is a bit of a hack, we call processEvents
-    // for Qt to empty its event queue, including (hopefully)
-    // the search update event sent by logFilteredData_. It saves
-    // us the overhead of having proper sync.
-    QApplication::processEvents( QEventLoop::ExcludeUserInputEvents );
-
     if ( !searchText.isEmpty() ) {
         // Determine the type of regexp depending on the config
         QRegExp::PatternSyntax syntax;
         static std::shared_ptr<Configuration> config =
             Persistent<Configuration>( "settings" );
-        switch ( config->mainRegexpType() ) {
+        switch ( searchSyntax == FixedStringSyntax ?
+                FixedString : config->mainRegexpType() ) {
             case Wildcard:
                 syntax = QRegExp::Wildcard;
                 break;
@@ -685,11 +871,41 @@ void CrawlerWidget::replaceCurrentSearch( const QString& searchText )
         // Constructs the regexp
         QRegExp regexp( searchText, case_sensitivity, syntax );
 
-        if ( regexp.isValid() ) {
+        qint64 beginLine, endLine;
+
+        if ( ! getSearchRange( &beginLine, &endLine ) ) {
+            logFilteredData_->clearSearch();
+            filteredView->updateData();
+            histogramWidget_->clear();
+            searchState_.resetState();
+
+            searchInfoLine->setPalette( errorPalette );
+            searchInfoLine->setText( tr("Error in time window: ") +
+                    timeWindowEdit->text() );
+        }
+        else if ( regexp.isValid() ) {
             // Activate the stop button
             stopButton->setEnabled( true );
-            // Start a new asynchronous search
-            logFilteredData_->runSearch( regexp );
+            logFilteredData_->setSearchIndexEnabled(
+                    config->isSearchIndexEnabled() );
+            logFilteredData_->setSearchRange( beginLine, endLine );
+            logFilteredData_->setBacktrackingLimited(
+                    searchSyntax == LimitedBacktrackingSyntax );
+            if ( newestFirstCheck->isChecked() ) {
+                logFilteredData_->setSearchDirection( SearchBackward );
+                filteredViewAnchored_   = true;
+                filteredViewAnchorLine_ = filteredView->getTopLine();
+            }
+            else {
+                logFilteredData_->setSearchDirection( SearchOutward );
+                filteredViewAnchored_   = false;
+            }
+            // Start a new asynchronous search, beginning with the part
+            // of the file being displayed (or its end)
+            logFilteredData_->runSearch( regexp, logMainView->getTopLine() );
+            fixedStringOffered_ = false;
+            lastSearchText_     = searchText;
+            lastSearchSyntax_   = searchSyntax;
             // Accept auto-refresh of the search
             searchState_.startSearch();
         }
@@ -697,6 +913,7 @@ void CrawlerWidget::replaceCurrentSearch( const QString& searchText )
             // The regexp is wrong
             logFilteredData_->clearSearch();
             filteredView->updateData();
+            histogramWidget_->clear();
             searchState_.resetState();
 
             // Inform the user
@@ -709,6 +926,7 @@ void CrawlerWidget::replaceCurrentSearch( const QString& searchText )
     else {
         logFilteredData_->clearSearch();
         filteredView->updateData();
+        histogramWidget_->clear();
         searchState_.resetState();
         printSearchInfoMessage();
     }
@@ -716,6 +934,54 @@ void CrawlerWidget::replaceCurrentSearch( const QString& searchText )
     logMainView->useNewFiltering( logFilteredData_ );
 }
 
+// The time window is "from - to", each time is in a format accepted by
+// TimestampParser::parseUserTime, 'to' is inclusive (to the second).
+bool CrawlerWidget::getSearchRange( qint64* beginLine, qint64* endLine ) const
+{
+    const QString text = timeWindowEdit->isVisible() ?
+        timeWindowEdit->text().trimmed() : QString();
+
+    *beginLine = 0;
+    *endLine   = -1;
+
+    if ( text.isEmpty() )
+        return true;
+
+    QString from, to;
+    if ( text.startsWith( '-' ) )
+        to = text.mid( 1 );
+    else if ( text.endsWith( '-' ) )
+        from = text.left( text.length() - 1 );
+    else {
+        // Dates contain '-' so spaces are needed around the separator
+        const int separator = text.indexOf( " - " );
+        if ( separator < 0 )
+            return false;
+        from = text.left( separator );
+        to   = text.mid( separator + 3 );
+    }
+
+    if ( ! from.trimmed().isEmpty() ) {
+        const qint64 time =
+            logData_->parseUserTime( from, logMainView->getTopLine() );
+        if ( time < 0 )
+            return false;
+        *beginLine = logData_->getLineFromTimestamp( time );
+    }
+
+    if ( ! to.trimmed().isEmpty() ) {
+        const qint64 time = logData_->parseUserTime( to, *beginLine );
+        if ( time < 0 )
+            return false;
+        *endLine = logData_->getLineFromTimestamp( time + 1000 );
+        // Up to the end of the file, include what is appended later
+        if ( *endLine >= logData_->getNbLine() )
+            *endLine = -1;
+    }
+
+    return ( *beginLine >= 0 );
+}
+
 // Updates the content of the drop down list for the saved searches,
 // called when the SavedSearch has been changed.
 void CrawlerWidget::updateSearchCombo()
@@ -749,10 +1015,111 @@ void CrawlerWidget::printSearchInfoMessage( int nbMatches )
             break;
     }
 
-    searchInfoLine->setPalette( searchInfoLineDefaultPalette );
+    // Warn about the lines the regexp has been too slow to match
+    const int nbSlowLines = logFilteredData_ ?
+        logFilteredData_->getSlowLines().size() : 0;
+    if ( nbSlowLines > 0 && ( searchState_.getState() == SearchState::Static
+                || searchState_.getState() == SearchState::Autorefreshing ) ) {
+        if ( logFilteredData_->isSearchBudgetExhausted() )
+            text = tr("Search stopped. ") + text;
+        text += tr(" The expression was too slow to match %1 line%2 (e.g. line %3).")
+            .arg( nbSlowLines ).arg( nbSlowLines > 1 ? "s" : "" )
+            .arg( logFilteredData_->getSlowLines().first() + 1 );
+        searchInfoLine->setPalette( errorPalette );
+    }
+    else {
+        searchInfoLine->setPalette( searchInfoLineDefaultPalette );
+    }
+
     searchInfoLine->setText( text );
 }
 
+// Propose to search for the text as a fixed string after a search
+// abandoned because the regexp was too slow.
+void CrawlerWidget::offerFixedStringSearch()
+{
+    static std::shared_ptr<Configuration> config =
+        Persistent<Configuration>( "settings" );
+
+    // Only a regexp can be that slow, and the search might have been
+    // replaced since
+    if ( config->mainRegexpType() == FixedString
+            || lastSearchSyntax_ == FixedStringSyntax
+            || ! logFilteredData_->isSearchBudgetExhausted() )
+        return;
+
+    // The search box might have been edited since the search started
+    const QString text = lastSearchText_;
+
+    QString message = tr( "The search has been stopped because the expression "
+            "takes too long to match some lines of the file." );
+    if ( RegExpBudget::isPatternRisky( text ) )
+        message += tr( "\n\nIt contains a repeated group which is itself "
+                "repeated (like \"(a+)+\"), the time needed to match such "
+                "expressions can grow exponentially with the length of the line." );
+
+    // Only this search, the syntax configured is left alone
+    SearchSyntax searchSyntax;
+    if ( askSearchSyntax( text, message,
+                lastSearchSyntax_ != LimitedBacktrackingSyntax, false,
+                &searchSyntax ) )
+        replaceCurrentSearch( text, searchSyntax );
+}
+
+bool CrawlerWidget::isSearchRisky( const QString& searchText ) const
+{
+    static std::shared_ptr<Configuration> config =
+        Persistent<Configuration>( "settings" );
+
+    return config->mainRegexpType() == ExtendedRegexp
+        && RegExpBudget::isPatternRisky( searchText );
+}
+
+bool CrawlerWidget::askSearchSyntax( const QString& searchText,
+        const QString& message, bool allowLimited, bool allowConfigured,
+        SearchSyntax* searchSyntax )
+{
+    static std::shared_ptr<Configuration> config =
+        Persistent<Configuration>( "settings" );
+
+    QMessageBox box( QMessageBox::Question, tr( "Slow expression" ),
+            message + tr( "\n\nHow should it be searched?" ),
+            QMessageBox::Cancel, this );
+
+    QPushButton* limitedButton = nullptr;
+#if QT_VERSION >= 0x050000
+    QRegularExpression limited;
+    if ( allowLimited && config->mainRegexpType() == ExtendedRegexp
+            && RegExpBudget::limitedRegExp( QRegExp( searchText,
+                    Qt::CaseSensitive, QRegExp::RegExp2 ), &limited ) )
+        limitedButton = box.addButton( tr( "Limit the Backtracking" ),
+                QMessageBox::AcceptRole );
+#else
+    Q_UNUSED( allowLimited );
+#endif
+    QPushButton* fixedStringButton = box.addButton(
+            tr( "As a Fixed String" ), QMessageBox::AcceptRole );
+    // Unsafe, only when there is nothing better
+    QPushButton* configuredButton = nullptr;
+    if ( allowConfigured && ! limitedButton )
+        configuredButton = box.addButton( tr( "Search Anyway" ),
+                QMessageBox::AcceptRole );
+
+    box.setDefaultButton( limitedButton ? limitedButton : fixedStringButton );
+    box.exec();
+
+    if ( box.clickedButton() == limitedButton && limitedButton )
+        *searchSyntax = LimitedBacktrackingSyntax;
+    else if ( box.clickedButton() == fixedStringButton )
+        *searchSyntax = FixedStringSyntax;
+    else if ( box.clickedButton() == configuredButton && configuredButton )
+        *searchSyntax = ConfiguredSyntax;
+    else
+        return false;
+
+    return true;
+}
+
 //
 // SearchState implementation
 //
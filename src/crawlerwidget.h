@@ -29,6 +29,7 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QTimer>
 
 #include "logmainview.h"
 #include "filteredview.h"
@@ -43,6 +44,8 @@ class QuickFindPattern;
 class SavedSearches;
 class QStandardItemModel;
 class OverviewWidget;
+class HistogramWidget;
+class QLineEdit;
 
 // Implements the central widget of the application.
 // It includes both windows, the search line, the info
@@ -57,7 +60,7 @@ class CrawlerWidget : public QSplitter,
     CrawlerWidget( QWidget *parent=0 );
 
     // Get the line number of the first line displayed.
-    int getTopLine() const;
+    qint64 getTopLine() const;
     // Get the selected text as a string (from the main window)
     QString getSelectedText() const;
 
@@ -68,6 +71,12 @@ class CrawlerWidget : public QSplitter,
     // is interacting with
     void selectAll();
 
+    // Returns whether the lines of the file are timestamped
+    bool hasTimestamps() const;
+    // Selects the first line at or after the time passed (as typed by
+    // the user), returns false if the time is not understood.
+    bool goToTime( const QString& time );
+
   public slots:
     // Stop the asynchoronous loading of the file if one is in progress
     // The file is identified by the view attached to it.
@@ -105,7 +114,7 @@ class CrawlerWidget : public QSplitter,
     // Sent up to the MainWindow to disable the follow mode
     void followDisabled();
     // Sent up when the current line number is updated
-    void updateLineNumber( int line );
+    void updateLineNumber( qint64 line );
 
   private slots:
     // Instructs the widget to start a search using the current search line.
@@ -122,9 +131,9 @@ class CrawlerWidget : public QSplitter,
     void updateFilteredView( int nbMatches, int progress );
     // Called when a new line has been selected in the filtered view,
     // to instruct the main view to jump to the matching line.
-    void jumpToMatchingLine( int filteredLineNb );
+    void jumpToMatchingLine( qint64 filteredLineNb );
     // Called when the main view is on a new line number
-    void updateLineNumberHandler( int line );
+    void updateLineNumberHandler( qint64 line );
     // Mark a line that has been clicked on the main (top) view.
     void markLineFromMain( qint64 line );
     // Mark a line that has been clicked on the filtered (bottom) view.
@@ -143,6 +152,9 @@ class CrawlerWidget : public QSplitter,
     // Called when the text on the search line is modified
     void searchTextChangeHandler();
 
+    // Called when the user has stopped typing in "search as you type" mode
+    void startSearchAsYouType();
+
     // Called when the user change the visibility combobox
     void changeFilteredViewVisibility( int index );
 
@@ -152,6 +164,10 @@ class CrawlerWidget : public QSplitter,
     // Called when a match is hovered on in the filtered view
     void mouseHoveredOverMatch( qint64 line );
 
+    // Propose to run the search again with a fixed string (or a limited
+    // backtracking) when the regexp has been too slow to match.
+    void offerFixedStringSearch();
+
   private:
     // State machine holding the state of the search, used to allow/disallow
     // auto-refresh and inform the user via the info line.
@@ -190,15 +206,41 @@ class CrawlerWidget : public QSplitter,
         bool autoRefreshRequested_;
     };
 
+    // How a search is run: with the syntax of the configuration, or in
+    // a way which cannot take forever to match
+    enum SearchSyntax {
+        ConfiguredSyntax,
+        FixedStringSyntax,
+        LimitedBacktrackingSyntax,
+    };
+
     // Private functions
     void setup();
-    void replaceCurrentSearch( const QString& searchText );
+    // Start a search, with the syntax of the configuration unless
+    // asked otherwise
+    void replaceCurrentSearch( const QString& searchText,
+            SearchSyntax searchSyntax = ConfiguredSyntax );
+    // Returns whether the search of the text with the syntax configured
+    // might take forever (see RegExpBudget::isPatternRisky)
+    bool isSearchRisky( const QString& searchText ) const;
+    // Ask the user how to search the text, which is too slow to match for
+    // the reason in the message.  A fixed string is offered, as well as a
+    // limited backtracking (if allowed and possible) or else the syntax
+    // configured (if allowed).  Returns false if cancelled.
+    bool askSearchSyntax( const QString& searchText, const QString& message,
+            bool allowLimited, bool allowConfigured,
+            SearchSyntax* searchSyntax );
+    // Computes the range of lines to search from the time window entered,
+    // returns false if it is invalid.
+    bool getSearchRange( qint64* beginLine, qint64* endLine ) const;
     void updateSearchCombo();
     AbstractLogView* activeView() const;
     void printSearchInfoMessage( int nbMatches = 0 );
 
     // Palette for error notification (yellow background)
     static const QPalette errorPalette;
+    // Delay (ms) without typing before a "search as you type" is started
+    static const int searchAsYouTypeDelay;
 
     LogMainView*    logMainView;
     QWidget*        bottomWindow;
@@ -206,12 +248,15 @@ class CrawlerWidget : public QSplitter,
     QComboBox*      searchLineEdit;
     QToolButton*    searchButton;
     QToolButton*    stopButton;
+    QLineEdit*      timeWindowEdit;
     FilteredView*   filteredView;
     QComboBox*      visibilityBox;
     InfoLine*       searchInfoLine;
     QCheckBox*      ignoreCaseCheck;
     QCheckBox*      searchRefreshCheck;
+    QCheckBox*      newestFirstCheck;
     OverviewWidget* overviewWidget_;
+    HistogramWidget* histogramWidget_;
 
     QVBoxLayout*    bottomMainLayout;
     QHBoxLayout*    searchLineLayout;
@@ -235,6 +280,9 @@ class CrawlerWidget : public QSplitter,
     // Search state (for auto-refresh and truncation)
     SearchState     searchState_;
 
+    // Debounce the edits of the search line in "search as you type" mode
+    QTimer          searchAsYouTypeTimer_;
+
     // Matches overview
     Overview        overview_;
 
@@ -244,9 +292,28 @@ class CrawlerWidget : public QSplitter,
     // Last main line number received
     qint64 currentLineNumber_;
 
+    // A newest first search fills the filtered view from the bottom,
+    // the view is kept there (as long as the top line is the one we
+    // set last, i.e. the user has not scrolled) until the search ends.
+    bool            filteredViewAnchored_;
+    qint64          filteredViewAnchorLine_;
+
+    // Has the search been offered to be run as a fixed string since
+    // it has been started (it is only offered once)
+    bool            fixedStringOffered_;
+
+    // Text and syntax of the last search started
+    QString         lastSearchText_;
+    SearchSyntax    lastSearchSyntax_;
+
     // Are we loading something?
     // Set to false when we receive a completion message from the LogData
     bool            loadingInProgress_;
+
+    // Search to do again once the file replacing the one displayed
+    // (rotated) is loaded, empty if none.
+    QString         searchAfterRotation_;
+    SearchSyntax    searchAfterRotationSyntax_;
 };
 
 #endif
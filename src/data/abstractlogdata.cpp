@@ -53,6 +53,24 @@ QStringList AbstractLogData::getExpandedLines( qint64 first_line, int number ) c
     return doGetExpandedLines( first_line, number );
 }
 
+// Simple wrapper in order to use a clean Template Method
+QStringList AbstractLogData::getExpandedLinesWindow( qint64 first_line,
+        int number, int first_col, int nb_cols ) const
+{
+    return doGetExpandedLinesWindow( first_line, number, first_col, nb_cols );
+}
+
+QStringList AbstractLogData::doGetExpandedLinesWindow( qint64 first_line,
+        int number, int first_col, int nb_cols ) const
+{
+    QStringList list;
+
+    foreach ( const QString& line, doGetExpandedLines( first_line, number ) )
+        list.append( line.mid( first_col, nb_cols ) );
+
+    return list;
+}
+
 // Simple wrapper in order to use a clean Template Method
 qint64 AbstractLogData::getNbLine() const
 {
@@ -70,3 +88,9 @@ int AbstractLogData::getLineLength( qint64 line ) const
 {
     return doGetLineLength( line );
 }
+
+// Simple wrapper in order to use a clean Template Method
+int AbstractLogData::getLinesGeneration() const
+{
+    return doGetLinesGeneration();
+}
@@ -22,6 +22,8 @@
 
 // #include "log.h"
 
+#include <cstring>
+
 #include <QObject>
 #include <QString>
 #include <QStringList>
@@ -44,6 +46,10 @@ class AbstractLogData : public QObject {
     QStringList getLines( qint64 first_line, int number ) const;
     // Returns a set of lines with tabs expanded
     QStringList getExpandedLines( qint64 first_line, int number ) const;
+    // Returns the columns [first_col, first_col + nb_cols[ of a set of
+    // lines with tabs expanded, very long lines are then not read entirely
+    QStringList getExpandedLinesWindow( qint64 first_line, int number,
+            int first_col, int nb_cols ) const;
     // Returns the total number of lines
     qint64 getNbLine() const;
     // Returns the visible length of the longest line
@@ -52,6 +58,10 @@ class AbstractLogData : public QObject {
     // Returns the visible length of the passed line
     // Tabs are expanded
     int getLineLength( qint64 line ) const;
+    // Returns a number which changes every time the lines already
+    // returned might have changed (adding lines at the end doesn't
+    // change it), used by the clients caching information about the lines.
+    int getLinesGeneration() const;
 
     // Length of a tab stop
     static const int tabStop = 8;
@@ -65,15 +75,25 @@ class AbstractLogData : public QObject {
     virtual QStringList doGetLines( qint64 first_line, int number ) const = 0;
     // Internal function called to get a set of expanded lines
     virtual QStringList doGetExpandedLines( qint64 first_line, int number ) const = 0;
+    // Internal function called to get a window of a set of expanded lines
+    // (this default implementation cuts the whole lines)
+    virtual QStringList doGetExpandedLinesWindow( qint64 first_line,
+            int number, int first_col, int nb_cols ) const;
     // Internal function called to get the number of lines
     virtual qint64 doGetNbLine() const = 0;
     // Internal function called to get the maximum length
     virtual int doGetMaxLength() const = 0;
     // Internal function called to get the line length
     virtual int doGetLineLength( qint64 line ) const = 0;
+    // Internal function called to get the generation of the lines
+    virtual int doGetLinesGeneration() const = 0;
 
     static inline QString untabify( const QString& line ) {
+        if ( ! line.contains( QChar( '\t' ) ) )
+            return line;
+
         QString untabified_line;
+        untabified_line.reserve( line.length() );
         int total_spaces = 0;
 
         for ( int j = 0; j < line.length(); j++ ) {
@@ -93,7 +113,12 @@ class AbstractLogData : public QObject {
     }
 
     static inline QString untabify( const char* line ) {
+        // Most lines have no tab and are converted in one go
+        if ( strchr( line, '\t' ) == NULL )
+            return QString::fromLatin1( line );
+
         QString untabified_line;
+        untabified_line.reserve( qstrlen( line ) );
         int total_spaces = 0;
 
         for ( const char* i = line; *i != '\0'; i++ ) {
@@ -105,7 +130,7 @@ class AbstractLogData : public QObject {
                 total_spaces += spaces - 1;
             }
             else {
-                untabified_line.append( *i );
+                untabified_line.append( QLatin1Char( *i ) );
             }
         }
 
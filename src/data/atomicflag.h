@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ATOMICFLAG_H
+#define ATOMICFLAG_H
+
+#include <atomic>
+
+// Represents a boolean flag which can be raised from one thread
+// (typically the UI) and polled from another one (typically a worker)
+// without any locking.
+// It is used as a cancellation token by the asynchronous operations.
+class AtomicFlag
+{
+  public:
+    AtomicFlag() : flag_( false ) {}
+
+    // Raise the flag
+    void set() { flag_.store( true ); }
+    // Lower the flag
+    void clear() { flag_.store( false ); }
+    // Returns whether the flag is raised
+    bool isSet() const { return flag_.load(); }
+
+    operator bool() const { return isSet(); }
+
+  private:
+    // Non copyable
+    AtomicFlag( const AtomicFlag& );
+    AtomicFlag& operator=( const AtomicFlag& );
+
+    std::atomic<bool> flag_;
+};
+
+#endif
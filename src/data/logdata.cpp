@@ -20,15 +20,109 @@
 // This file implements LogData, the content of a log file.
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 
 #include <cassert>
 
 #include <QFileInfo>
 
+#ifdef Q_OS_UNIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
 #include "log.h"
 
 #include "logdata.h"
 #include "logfiltereddata.h"
+#include "perfcounters.h"
+#include "tracer.h"
+
+namespace {
+    // Largest amount of data (bytes) read between two lines asked
+    // by getLinesAt for them to be read together
+    const qint64 maxGapInRead = 64 * 1024;
+    // Lines longer than this (in bytes) are only read by parts
+    const qint64 longLineLength = 64 * 1024;
+    // Size of the segments of the long lines (bytes)
+    const int longLineSegment = 64 * 1024;
+    // Number of long lines whose segments are kept
+    const int maxLongLines = 32;
+    // Refreshes per second when the file changes, unless set
+    const int defaultMaxRefreshRate = 20;
+    // Size of the block at the end of the data indexed which is checked
+    // when the file changes (bytes)
+    const qint64 tailBlockSize = 4096;
+    // Time (ms) a file can be missing before it is considered removed
+    // (rather than being rotated)
+    const int removalDelay = 2000;
+
+    // Identity of a file: its device and inode
+    typedef QPair<qint64, qint64> FileIdentity;
+    const FileIdentity unknownIdentity( -1, -1 );
+
+    // Returns the identity of the file designated by the path,
+    // unknownIdentity if it doesn't exist or if the system cannot tell.
+    FileIdentity fileIdentity( const QString& fileName )
+    {
+#ifdef Q_OS_UNIX
+        struct stat file_stat;
+        if ( ::stat( QFile::encodeName( fileName ).constData(),
+                    &file_stat ) == 0 )
+            return FileIdentity( file_stat.st_dev, file_stat.st_ino );
+#else
+        Q_UNUSED( fileName );
+#endif
+        return unknownIdentity;
+    }
+
+    // Returns a hash of the block of the file ending at the passed
+    // position, to check the data indexed are still there when the file
+    // grows (0 if nothing can be read).
+    uint tailHash( const QString& fileName, qint64 end )
+    {
+        const qint64 begin = qMax<qint64>( end - tailBlockSize, 0 );
+
+        QFile file( fileName );
+        if ( end <= 0 || ! file.open( QIODevice::ReadOnly )
+                || ! file.seek( begin ) )
+            return 0;
+
+        const QByteArray block = file.read( end - begin );
+        return ( block.size() == end - begin ) ? qHash( block ) : 0;
+    }
+
+    // Returns the expanded column after the passed data, starting from
+    // the passed column
+    int advanceColumn( const QByteArray& data, int column )
+    {
+        const char* p = data.constData();
+        const char* const end = p + data.size();
+        const char* tab;
+
+        while ( ( tab = static_cast<const char*>(
+                        memchr( p, '\t', end - p ) ) ) != NULL ) {
+            column += tab - p;
+            column += AbstractLogData::tabStop - column % AbstractLogData::tabStop;
+            p = tab + 1;
+        }
+
+        return column + ( end - p );
+    }
+}
+
+// The operations alive are the one running and the one waiting for it
+LogData::LogDataOperation::LogDataOperation( const QString& fileName )
+    : filename_( fileName )
+{
+    PerfCounters::addToGauge( PerfCounters::IndexingQueue, 1 );
+}
+
+LogData::LogDataOperation::~LogDataOperation()
+{
+    PerfCounters::addToGauge( PerfCounters::IndexingQueue, -1 );
+}
 
 // Implementation of the 'start' functions for each operation
 
@@ -57,20 +151,34 @@ void LogData::PartialIndexOperation::doStart(
 
 // Constructs an empty log file.
 // It must be displayed without error.
-LogData::LogData() : AbstractLogData(), fileWatcher_(), linePosition_(),
-    fileMutex_(), dataMutex_(), workerThread_()
+LogData::LogData() : AbstractLogData(), fileWatcher_(), refreshTimer_(),
+    lastRefresh_(), linePosition_(),
+    timestampIndex_(), longLines_( maxLongLines ), fileMutex_(), dataMutex_(),
+    workerThread_()
 {
     // Start with an "empty" log
     file_         = nullptr;
     fileSize_     = 0;
     nbLines_      = 0;
     maxLength_    = 0;
+    indexGeneration_  = 0;
+    fileIdentity_         = unknownIdentity;
+    indexingFileIdentity_ = unknownIdentity;
+    tailHash_             = 0;
     currentOperation_ = nullptr;
     nextOperation_    = nullptr;
+    refreshInterval_  = 1000 / defaultMaxRefreshRate;
+    changeTime_         = -1;
+    indexingChangeTime_ = -1;
+    indexedChangeTime_  = -1;
 
     // Initialise the file watcher
     connect( &fileWatcher_, SIGNAL( fileChanged( const QString& ) ),
             this, SLOT( fileChangedOnDisk() ) );
+    refreshTimer_.setSingleShot( true );
+    connect( &refreshTimer_, SIGNAL( timeout() ),
+            this, SLOT( refreshTick() ) );
+    lastRefresh_.start();
     // Forward the update signal
     connect( &workerThread_, SIGNAL( indexingProgressed( int ) ),
             this, SIGNAL( loadingProgressed( int ) ) );
@@ -99,6 +207,9 @@ void LogData::attachFile( const QString& fileName )
         // Remove the current file from the watch list
         fileWatcher_.removeFile( file_->fileName() );
     }
+    refreshTimer_.stop();
+    changeTime_ = -1;
+    missingSince_.invalidate();
 
     workerThread_.interrupt();
 
@@ -123,6 +234,132 @@ QDateTime LogData::getLastModifiedDate() const
     return lastModifiedDate_;
 }
 
+int LogData::getIndexGeneration() const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return indexGeneration_;
+}
+
+QStringList LogData::getLinesAt( const QList<qint64>& lines ) const
+{
+    QStringList list;
+
+    foreach ( const QByteArray& line, readLinesAt( lines ) )
+        list.append( QString( line ) );
+
+    return list;
+}
+
+QStringList LogData::getExpandedLinesAt( const QList<qint64>& lines ) const
+{
+    QStringList list;
+
+    foreach ( const QByteArray& line, readLinesAt( lines ) )
+        list.append( untabify( line.constData() ) );
+
+    return list;
+}
+
+// The long lines are read by parts, the others together.
+QStringList LogData::getExpandedLinesWindowAt( const QList<qint64>& lines,
+        int first_col, int nb_cols ) const
+{
+    QStringList list;
+    QList<qint64> short_lines;
+    QVector<bool> is_long( lines.size() );
+
+    {
+        QMutexLocker locker( &dataMutex_ );
+        for ( int i = 0; i < lines.size(); i++ ) {
+            is_long[i] = isLongLine( lines[i] );
+            if ( ! is_long[i] )
+                short_lines.append( lines[i] );
+        }
+    }
+
+    const QList<QByteArray> short_data = readLinesAt( short_lines );
+
+    int j = 0;
+    for ( int i = 0; i < lines.size(); i++ ) {
+        if ( is_long[i] )
+            list.append( readLongLineWindow( lines[i], first_col, nb_cols ) );
+        else
+            list.append( untabify( short_data[j++].constData() )
+                    .mid( first_col, nb_cols ) );
+    }
+
+    return list;
+}
+
+bool LogData::hasTimestamps() const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return ! timestampIndex_.isEmpty();
+}
+
+qint64 LogData::getTimestamp( qint64 line ) const
+{
+    TimestampParser parser;
+    {
+        QMutexLocker locker( &dataMutex_ );
+        parser = timestampIndex_.parser();
+    }
+
+    if ( parser.isValid() )
+        return parser.parse( getLineString( line ) );
+    else
+        return -1;
+}
+
+qint64 LogData::parseUserTime( const QString& text, qint64 referenceLine ) const
+{
+    // Use the closest timestamp if the line has none (e.g. multi-line message)
+    qint64 reference = getTimestamp( referenceLine );
+    if ( reference < 0 ) {
+        QMutexLocker locker( &dataMutex_ );
+        reference = timestampIndex_.timeAt( referenceLine );
+    }
+
+    return TimestampParser::parseUserTime( text, reference );
+}
+
+// The samples are found by a binary search, we then only have to scan the
+// (at most samplingInterval) lines between them.
+qint64 LogData::getLineFromTimestamp( qint64 time ) const
+{
+    // Number of lines read at once
+    static const int nbLinesInChunk = 1000;
+
+    TimestampIndex index;
+    {
+        // getLines() locks the mutex itself, we work on a (cheap) copy
+        QMutexLocker locker( &dataMutex_ );
+        index = timestampIndex_;
+    }
+
+    if ( index.isEmpty() )
+        return -1;
+
+    const qint64 nbLines = getNbLine();
+    const qint64 first = index.lineBefore( time );
+    qint64 last = index.lineAfter( time );
+    if ( last < 0 )
+        last = nbLines;
+
+    for ( qint64 i = first; i < last; i += nbLinesInChunk ) {
+        const QStringList lines =
+            getLines( i, (int) qMin( (qint64) nbLinesInChunk, last - i ) );
+        for ( int j = 0; j < lines.size(); j++ ) {
+            if ( index.parser().parse( lines[j] ) >= time )
+                return i + j;
+        }
+    }
+
+    return last;
+}
+
 // Return an initialised LogFilteredData. The search is not started.
 LogFilteredData* LogData::getNewFilteredData() const
 {
@@ -134,10 +371,29 @@ LogFilteredData* LogData::getNewFilteredData() const
 void LogData::reload()
 {
     workerThread_.interrupt();
+    // Everything is reindexed anyway
+    refreshTimer_.stop();
+    changeTime_ = -1;
+    missingSince_.invalidate();
 
     enqueueOperation( std::make_shared<FullIndexOperation>() );
 }
 
+qint64 LogData::getChangeTime() const
+{
+    return indexedChangeTime_;
+}
+
+void LogData::setMaxRefreshRate( int refreshesPerSecond )
+{
+    refreshInterval_ = 1000 / qBound( 1, refreshesPerSecond, 1000 );
+}
+
+void LogData::setPollingMode( FileWatcher::PollingMode mode )
+{
+    fileWatcher_.setPollingMode( mode );
+}
+
 //
 // Private functions
 //
@@ -174,6 +430,17 @@ void LogData::startOperation()
             fileSize_     = 0;
             nbLines_      = 0;
             maxLength_    = 0;
+            tailHash_     = 0;
+        }
+
+        // Taken before indexing, a file replacing it in the meantime
+        // will be seen as a rotation
+        if ( ! dynamic_cast<const PartialIndexOperation*>(
+                    currentOperation_.get() ) ) {
+            const QString name = currentOperation_->getFilename().isNull() ?
+                ( file_ ? file_->fileName() : QString() ) :
+                currentOperation_->getFilename();
+            indexingFileIdentity_ = fileIdentity( name );
         }
 
         // And let the operation do its stuff
@@ -185,28 +452,95 @@ void LogData::startOperation()
 // Slots
 //
 
+// The notifications received until the tick are coalesced, the file
+// is then reindexed from where the previous tick stopped.
 void LogData::fileChangedOnDisk()
 {
     LOG(logDEBUG) << "signalFileChanged";
 
-    fileWatcher_.removeFile( file_->fileName() );
+    if ( changeTime_ < 0 )
+        changeTime_ = Tracer::now();
+
+    if ( ! refreshTimer_.isActive() ) {
+        const qint64 delay = refreshInterval_ - lastRefresh_.elapsed();
+        refreshTimer_.start( qMax( delay, 0LL ) );
+    }
+}
+
+void LogData::refreshTick()
+{
+    LOG(logDEBUG) << "LogData::refreshTick";
+
+    lastRefresh_.restart();
 
     const QString name = file_->fileName();
     QFileInfo info( name );
 
+    // While a file is rotated, it can be missing for a moment, what
+    // has been indexed is kept until it is back or until it has been
+    // missing long enough to be considered removed (then handled as
+    // a truncation).
+    if ( ! info.exists() ) {
+        if ( ! missingSince_.isValid() )
+            missingSince_.start();
+
+        const qint64 missingFor = missingSince_.elapsed();
+        if ( missingFor < removalDelay ) {
+            LOG(logINFO) << "File missing, waiting for it to reappear";
+            refreshTimer_.start( removalDelay - missingFor );
+            return;
+        }
+        else if ( fileSize_ == 0 ) {
+            // Nothing left to clear
+            return;
+        }
+        LOG(logINFO) << "File removed";
+    }
+    else {
+        missingSince_.invalidate();
+    }
+
+    fileWatcher_.removeFile( name );
+
     std::shared_ptr<LogDataOperation> newOperation;
 
+    const FileIdentity identity = fileIdentity( name );
+
     LOG(logDEBUG) << "current fileSize=" << fileSize_;
     LOG(logDEBUG) << "info file_->size()=" << info.size();
-    if ( info.size() < fileSize_ ) {
+    if ( identity != unknownIdentity && fileIdentity_ != unknownIdentity
+            && identity != fileIdentity_ ) {
+        // Another file with the same name, whatever its size
+        fileChangedOnDisk_ = Rotated;
+        LOG(logINFO) << "File rotated";
+
+        // TODO: read what has been written to the rotated file since the
+        // last refresh before switching to the new one (it needs LogData
+        // to index several files as one), it is only reported for now.
+        if ( indexedFile_.isOpen() && indexedFile_.size() > fileSize_ )
+            LOG(logWARNING) << indexedFile_.size() - fileSize_
+                << " bytes written to the rotated file are not displayed";
+
+        newOperation = std::make_shared<FullIndexOperation>();
+    }
+    else if ( info.size() < fileSize_ ) {
         fileChangedOnDisk_ = Truncated;
         LOG(logINFO) << "File truncated";
         newOperation = std::make_shared<FullIndexOperation>();
     }
+    else if ( tailHash( name, fileSize_ ) != tailHash_ ) {
+        // Same file, not shorter, but what has been indexed has been
+        // overwritten: it is handled like a new file
+        fileChangedOnDisk_ = Rotated;
+        LOG(logINFO) << "File rewritten";
+        newOperation = std::make_shared<FullIndexOperation>();
+    }
     else if ( fileChangedOnDisk_ != DataAdded ) {
         fileChangedOnDisk_ = DataAdded;
         LOG(logINFO) << "New data on disk";
         newOperation = std::make_shared<PartialIndexOperation>( fileSize_ );
+        indexingChangeTime_ = changeTime_;
+        changeTime_ = -1;
     }
 
     if ( newOperation )
@@ -222,12 +556,25 @@ void LogData::indexingFinished( bool success )
 {
     LOG(logDEBUG) << "Entering LogData::indexingFinished.";
 
+    // Anything but appending new lines can change the content
+    const bool partial = dynamic_cast<const PartialIndexOperation*>(
+            currentOperation_.get() );
+
     // We use the newly created file data or restore the old ones.
     // (Qt implicit copy makes this fast!)
     {
         QMutexLocker locker( &dataMutex_ );
-        workerThread_.getIndexingData( &fileSize_, &maxLength_, &linePosition_ );
+        workerThread_.getIndexingData( &fileSize_, &maxLength_,
+                &linePosition_, &timestampIndex_ );
         nbLines_ = linePosition_.size();
+
+        if ( success && ! partial ) {
+            ++indexGeneration_;
+            fileIdentity_ = indexingFileIdentity_;
+        }
+
+        indexedChangeTime_ = ( success && partial ) ? indexingChangeTime_ : -1;
+        indexingChangeTime_ = -1;
     }
 
     LOG(logDEBUG) << "indexingFinished: " << success <<
@@ -253,12 +600,31 @@ void LogData::indexingFinished( bool success )
         QFileInfo fileInfo( *file_ );
         if ( fileInfo.exists() )
             lastModifiedDate_ = fileInfo.lastModified();
+
+#ifdef Q_OS_UNIX
+        // Keep the file indexed open, it stays reachable once rotated
+        if ( ! partial ) {
+            indexedFile_.close();
+            indexedFile_.setFileName( file_->fileName() );
+            if ( fileInfo.exists() && ! indexedFile_.open( QIODevice::ReadOnly ) )
+                LOG(logWARNING) << "Cannot keep "
+                    << file_->fileName().toStdString() << " open";
+        }
+#endif
     }
 
     if ( file_ ) {
         // And we watch the file for updates
         fileChangedOnDisk_ = Unchanged;
         fileWatcher_.addFile( file_->fileName() );
+        tailHash_ = tailHash( file_->fileName(), fileSize_ );
+
+        // The file was not watched while indexing, what has been written
+        // in the meantime is refreshed without waiting for another write
+        // (which might never come).
+        QFileInfo fileInfo( *file_ );
+        if ( success && fileInfo.exists() && fileInfo.size() != fileSize_ )
+            fileChangedOnDisk();
     }
 
     emit loadingFinished( success );
@@ -293,11 +659,29 @@ int LogData::doGetLineLength( qint64 line ) const
 {
     if ( line >= nbLines_ ) { return 0; /* exception? */ }
 
+    {
+        // The length of the long lines is known without expanding them
+        QMutexLocker data_locker( &dataMutex_ );
+        if ( isLongLine( line ) ) {
+            QMutexLocker file_locker( &fileMutex_ );
+            file_->open( QIODevice::ReadOnly );
+            const int length = longLine( line )->length;
+            file_->close();
+
+            return length;
+        }
+    }
+
     int length = doGetExpandedLineString( line ).length();
 
     return length;
 }
 
+int LogData::doGetLinesGeneration() const
+{
+    return getIndexGeneration();
+}
+
 QString LogData::doGetLineString( qint64 line ) const
 {
     if ( line >= nbLines_ ) { return QString(); /* exception? */ }
@@ -360,6 +744,9 @@ QStringList LogData::doGetLines( qint64 first_line, int number ) const
         return QStringList(); /* exception? */
     }
 
+    PerfTimer timer( PerfCounters::LineReadTime );
+    PerfCounters::add( PerfCounters::LinesRead, number );
+
     dataMutex_.lock();
 
     fileMutex_.lock();
@@ -390,6 +777,67 @@ QStringList LogData::doGetLines( qint64 first_line, int number ) const
     return list;
 }
 
+// Each run of lines separated by less than maxGapInRead is read in one go,
+// the lines are then cut from it.
+QList<QByteArray> LogData::readLinesAt( const QList<qint64>& lines ) const
+{
+    QList<QByteArray> result;
+    int nbReads = 0;
+
+    if ( lines.isEmpty() )
+        return result;
+
+    PerfTimer timer( PerfCounters::LineReadTime );
+    PerfCounters::add( PerfCounters::LinesRead, lines.size() );
+
+    QMutexLocker data_locker( &dataMutex_ );
+    QMutexLocker file_locker( &fileMutex_ );
+
+    file_->open( QIODevice::ReadOnly );
+
+    int i = 0;
+    while ( i < lines.size() ) {
+        if ( lines[i] < 0 || lines[i] >= nbLines_ ) {
+            LOG(logWARNING) << "LogData::readLinesAt Line out of bound asked for";
+            result.append( QByteArray() );
+            i++;
+            continue;
+        }
+
+        // Extend the run while the next line is close enough
+        int last = i;
+        while ( ( last + 1 < lines.size() )
+                && ( lines[last + 1] > lines[last] )
+                && ( lines[last + 1] < nbLines_ )
+                && ( linePosition_[lines[last + 1] - 1]
+                    - linePosition_[lines[last]] <= maxGapInRead ) )
+            last++;
+
+        const qint64 first_byte =
+            ( lines[i] == 0 ) ? 0 : linePosition_[lines[i] - 1];
+        const qint64 last_byte = linePosition_[lines[last]];
+        file_->seek( first_byte );
+        const QByteArray blob = file_->read( last_byte - first_byte );
+        nbReads++;
+
+        for ( int j = i; j <= last; j++ ) {
+            const qint64 beginning = ( ( lines[j] == 0 ) ?
+                    0 : linePosition_[lines[j] - 1] ) - first_byte;
+            const qint64 end = linePosition_[lines[j]] - first_byte;
+            result.append( blob.mid( beginning, end - beginning - 1 ) );
+        }
+
+        i = last + 1;
+    }
+
+    file_->close();
+
+    LOG(logDEBUG4) << "LogData::readLinesAt " << lines.size()
+        << " lines in " << nbReads << " reads";
+
+    return result;
+}
+
 QStringList LogData::doGetExpandedLines( qint64 first_line, int number ) const
 {
     QStringList list;
@@ -404,6 +852,9 @@ QStringList LogData::doGetExpandedLines( qint64 first_line, int number ) const
         return QStringList(); /* exception? */
     }
 
+    PerfTimer timer( PerfCounters::LineReadTime );
+    PerfCounters::add( PerfCounters::LinesRead, number );
+
     dataMutex_.lock();
 
     fileMutex_.lock();
@@ -433,3 +884,122 @@ QStringList LogData::doGetExpandedLines( qint64 first_line, int number ) const
 
     return list;
 }
+
+QStringList LogData::doGetExpandedLinesWindow( qint64 first_line, int number,
+        int first_col, int nb_cols ) const
+{
+    const qint64 last_line = first_line + number - 1;
+
+    if ( number == 0 ) {
+        return QStringList();
+    }
+
+    if ( last_line >= nbLines_ ) {
+        LOG(logWARNING) << "LogData::doGetExpandedLinesWindow Lines out of bound asked for";
+        return QStringList(); /* exception? */
+    }
+
+    QList<qint64> lines;
+    for ( qint64 line = first_line; line <= last_line; line++ )
+        lines.append( line );
+
+    return getExpandedLinesWindowAt( lines, first_col, nb_cols );
+}
+
+bool LogData::isLongLine( qint64 line ) const
+{
+    if ( line < 0 || line >= nbLines_ )
+        return false;
+
+    const qint64 begin = ( line == 0 ) ? 0 : linePosition_[line - 1];
+    return ( linePosition_[line] - begin - 1 ) > longLineLength;
+}
+
+const LogData::LongLine* LogData::longLine( qint64 line ) const
+{
+    const qint64 begin = ( line == 0 ) ? 0 : linePosition_[line - 1];
+    const qint64 end   = linePosition_[line] - 1;
+
+    // The line number might now be another line (after a reload)
+    const LongLine* cached = longLines_.object( line );
+    if ( cached != NULL && cached->begin == begin && cached->end == end )
+        return cached;
+
+    LOG(logDEBUG) << "LogData::longLine building the segments of line " << line;
+
+    LongLine* long_line = new LongLine;
+    long_line->begin = begin;
+    long_line->end   = end;
+
+    int column = 0;
+    file_->seek( begin );
+    for ( qint64 pos = begin; pos < end; pos += longLineSegment ) {
+        long_line->columns.append( column );
+        column = advanceColumn(
+                file_->read( qMin<qint64>( longLineSegment, end - pos ) ),
+                column );
+    }
+    long_line->length = column;
+
+    longLines_.insert( line, long_line );
+
+    return long_line;
+}
+
+// Only the segments containing the window are read.
+QString LogData::readLongLineWindow( qint64 line,
+        int first_col, int nb_cols ) const
+{
+    PerfTimer timer( PerfCounters::LineReadTime );
+    PerfCounters::add( PerfCounters::LinesRead );
+
+    QMutexLocker data_locker( &dataMutex_ );
+    QMutexLocker file_locker( &fileMutex_ );
+
+    if ( line < 0 || line >= nbLines_ )
+        return QString();
+
+    first_col = qMax( first_col, 0 );
+    const int last_col = first_col + nb_cols;
+
+    file_->open( QIODevice::ReadOnly );
+
+    const LongLine* long_line = longLine( line );
+
+    // Start at the segment containing the first column
+    const int segment = std::upper_bound( long_line->columns.begin(),
+            long_line->columns.end(), first_col )
+        - long_line->columns.begin() - 1;
+    if ( segment < 0 ) {
+        file_->close();
+        return QString();
+    }
+
+    const qint64 start = long_line->begin + (qint64) segment * longLineSegment;
+    int column = long_line->columns[segment];
+
+    // A byte is at least one column
+    file_->seek( start );
+    const QByteArray data = file_->read( qMin<qint64>(
+                long_line->end - start, last_col - column ) );
+
+    file_->close();
+
+    QString window;
+    window.reserve( nb_cols );
+    for ( int i = 0; i < data.size() && column < last_col; i++ ) {
+        if ( data[i] == '\t' ) {
+            const int next = column + tabStop - column % tabStop;
+            for ( ; column < next; column++ )
+                if ( column >= first_col && column < last_col )
+                    window.append( QLatin1Char( ' ' ) );
+        }
+        else {
+            if ( column >= first_col )
+                window.append( QLatin1Char( data[i] ) );
+            column++;
+        }
+    }
+
+    return window;
+}
@@ -28,6 +28,10 @@
 #include <QVector>
 #include <QMutex>
 #include <QDateTime>
+#include <QCache>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QPair>
 
 #include "abstractlogdata.h"
 #include "logdataworkerthread.h"
@@ -46,7 +50,10 @@ class LogData : public AbstractLogData {
     // Destroy an object
     ~LogData();
 
-    enum MonitoredFileStatus { Unchanged, DataAdded, Truncated };
+    // Rotated means another file has replaced the one indexed
+    // (e.g. by logrotate), or the data indexed have been overwritten,
+    // and is being indexed instead.
+    enum MonitoredFileStatus { Unchanged, DataAdded, Truncated, Rotated };
 
     // Attaches (or reattaches) the LogData to a file on disk
     // It starts the asynchronous indexing and returns (almost) immediately
@@ -67,6 +74,48 @@ class LogData : public AbstractLogData {
     QDateTime getLastModifiedDate() const;
     // Throw away all the file data and reload/reindex.
     void reload();
+    // Set how many times per second at most the file is reindexed when
+    // it changes on disk, the changes in between are handled together.
+    void setMaxRefreshRate( int refreshesPerSecond );
+    // Set when the file is polled for changes (see FileWatcher)
+    void setPollingMode( FileWatcher::PollingMode mode );
+    // Returns the time (Tracer::now()) the lines added by the last
+    // indexing have first been notified, -1 if the last indexing was
+    // not the refresh of a file growing on disk.
+    qint64 getChangeTime() const;
+    // Returns a number which changes every time the file is fully
+    // reindexed (its content might then be different), appending data
+    // to the file does not change it.
+    // Used by the clients caching information about the lines.
+    int getIndexGeneration() const;
+
+    // Returns the passed lines (in increasing order, e.g. the lines of
+    // a filtered view), the lines close to each other are read together
+    // so only a few reads are needed.
+    // Lines out of bound are returned empty.
+    QStringList getLinesAt( const QList<qint64>& lines ) const;
+    // Same as getLinesAt but with the tabs expanded
+    QStringList getExpandedLinesAt( const QList<qint64>& lines ) const;
+    // Same as getExpandedLinesAt but only returns the columns
+    // [first_col, first_col + nb_cols[ of each line, only the part
+    // needed of the very long lines is read.
+    QStringList getExpandedLinesWindowAt( const QList<qint64>& lines,
+            int first_col, int nb_cols ) const;
+
+    // Returns whether the lines of the file start with a timestamp
+    // (in a format detected when the file was indexed).
+    bool hasTimestamps() const;
+    // Returns the timestamp of the passed line or -1 if it has none
+    // (see TimestampParser for the representation).
+    qint64 getTimestamp( qint64 line ) const;
+    // Parses a time typed by the user, a time without date is taken
+    // on the same day as the passed line.  Returns -1 if invalid.
+    qint64 parseUserTime( const QString& text, qint64 referenceLine ) const;
+    // Returns the first line timestamped at or after the passed time
+    // (or the number of lines if there is none), found by a binary
+    // search of the timestamp index.  Returns -1 if the file has no
+    // timestamps.
+    qint64 getLineFromTimestamp( qint64 time ) const;
 
   signals:
     // Sent during the 'attach' process to signal progress
@@ -79,8 +128,11 @@ class LogData : public AbstractLogData {
     void fileChanged( LogData::MonitoredFileStatus status );
 
   private slots:
-    // Consider reloading the file when it changes on disk updated
+    // Schedule the next refresh tick when the file changes on disk
     void fileChangedOnDisk();
+    // Consider reloading the file, for all the changes on disk
+    // since the last tick
+    void refreshTick();
     // Called when the worker thread signals the current operation ended
     void indexingFinished( bool success );
 
@@ -90,9 +142,9 @@ class LogData : public AbstractLogData {
     // one is ongoing (operations are asynchronous)
     class LogDataOperation {
       public:
-        LogDataOperation( const QString& fileName ) : filename_( fileName ) {}
+        LogDataOperation( const QString& fileName );
         // Permit each child to have its destructor
-        virtual ~LogDataOperation() {};
+        virtual ~LogDataOperation();
 
         void start( LogDataWorkerThread& workerThread ) const
         { doStart( workerThread ); }
@@ -147,15 +199,55 @@ class LogData : public AbstractLogData {
 
     FileWatcher fileWatcher_;
     MonitoredFileStatus fileChangedOnDisk_;
+    // Rate limiting of the refreshes
+    QTimer refreshTimer_;
+    QElapsedTimer lastRefresh_;
+    int refreshInterval_;
+    // Started when the file is found missing (invalid while it exists)
+    QElapsedTimer missingSince_;
+    // First notification (Tracer::now()) not yet handled by a refresh,
+    // of the data being indexed and of the data indexed (-1 if none)
+    qint64 changeTime_;
+    qint64 indexingChangeTime_;
+    qint64 indexedChangeTime_;
 
     // Implementation of virtual functions
     virtual QString doGetLineString( qint64 line ) const;
     virtual QString doGetExpandedLineString( qint64 line ) const;
     virtual QStringList doGetLines( qint64 first, int number ) const;
     virtual QStringList doGetExpandedLines( qint64 first, int number ) const;
+    virtual QStringList doGetExpandedLinesWindow( qint64 first, int number,
+            int first_col, int nb_cols ) const;
     virtual qint64 doGetNbLine() const;
     virtual int doGetMaxLength() const;
     virtual int doGetLineLength( qint64 line ) const;
+    virtual int doGetLinesGeneration() const;
+
+    // Read the passed lines (without their end of line), grouping them
+    // in as few reads as possible.
+    QList<QByteArray> readLinesAt( const QList<qint64>& lines ) const;
+
+    // A very long line, cut in segments of a fixed number of bytes
+    // for which the expanded column of the start is known, so a part
+    // of the line can be read without reading what comes before.
+    struct LongLine {
+        // Position of the line in the file (end excluding the LF)
+        qint64 begin;
+        qint64 end;
+        // Expanded column at the start of each segment
+        QVector<int> columns;
+        // Expanded length of the line
+        int length;
+    };
+
+    // Returns whether the passed line is long enough to be read in parts
+    // (dataMutex_ must be held).
+    bool isLongLine( qint64 line ) const;
+    // Returns the segments of the passed long line, built the first time
+    // (dataMutex_ and fileMutex_ must be held and the file open).
+    const LongLine* longLine( qint64 line ) const;
+    // Read the columns [first_col, first_col + nb_cols[ of a long line
+    QString readLongLineWindow( qint64 line, int first_col, int nb_cols ) const;
 
     void enqueueOperation( std::shared_ptr<const LogDataOperation> newOperation );
     void startOperation();
@@ -167,12 +259,26 @@ class LogData : public AbstractLogData {
     qint64 nbLines_;
     int maxLength_;
     QDateTime lastModifiedDate_;
+    // Identity (device and inode, see fileIdentity) of the file indexed
+    // and of the one being indexed by a full indexing
+    QPair<qint64, qint64> fileIdentity_;
+    QPair<qint64, qint64> indexingFileIdentity_;
+    // The file indexed, kept open to know what is written to it after
+    // it has been rotated (Unix only)
+    QFile indexedFile_;
+    // Hash (see tailHash) of the end of the data indexed
+    uint tailHash_;
+    int indexGeneration_;
+    TimestampIndex timestampIndex_;
+    // Segments of the long lines recently displayed
+    mutable QCache<qint64, LongLine> longLines_;
     std::shared_ptr<const LogDataOperation> currentOperation_;
     std::shared_ptr<const LogDataOperation> nextOperation_;
 
     // To protect the file:
     mutable QMutex fileMutex_;
-    // To protect linePosition_, fileSize_ and maxLength_:
+    // To protect linePosition_, fileSize_, maxLength_, indexGeneration_,
+    // timestampIndex_ and longLines_:
     mutable QMutex dataMutex_;
     // (are mutable to allow 'const' function to touch it,
     // while remaining const)
@@ -17,53 +17,92 @@
  * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
+
 #include <QFile>
 
 #include "log.h"
 
 #include "logdata.h"
 #include "logdataworkerthread.h"
+#include "perfcounters.h"
+#include "tracer.h"
 
 // Size of the chunk to read (5 MiB)
 const int IndexOperation::sizeChunk = 5*1024*1024;
 
+// Size of the beginning of the file used to detect the timestamp format
+static const int timestampDetectionSize = 64*1024;
+// Number of characters of a line passed to the timestamp parser
+static const int timestampMaxLength = 64;
+
 void IndexingData::getAll( qint64* size, int* length,
-        LinePositionArray* linePosition )
+        LinePositionArray* linePosition, TimestampIndex* timestamps )
 {
     QMutexLocker locker( &dataMutex_ );
 
     *size         = indexedSize_;
     *length       = maxLength_;
     *linePosition = linePosition_;
+    *timestamps   = timestampIndex_;
 }
 
 void IndexingData::setAll( qint64 size, int length,
-        const LinePositionArray& linePosition )
+        const LinePositionArray& linePosition,
+        const TimestampIndex& timestamps )
 {
     QMutexLocker locker( &dataMutex_ );
 
-    indexedSize_  = size;
-    maxLength_    = length;
-    linePosition_ = linePosition;
+    indexedSize_    = size;
+    maxLength_      = length;
+    linePosition_   = linePosition;
+    timestampIndex_ = timestamps;
 }
 
 void IndexingData::addAll( qint64 size, int length,
-        const LinePositionArray& linePosition )
+        const LinePositionArray& linePosition,
+        const TimestampIndex& timestamps )
 {
     QMutexLocker locker( &dataMutex_ );
 
+    // The first line added replaces the fake one if there is one
+    const qint64 firstLine = linePosition_.size()
+        - ( linePosition_.hasFakeFinalLF() ? 1 : 0 );
+    timestampIndex_.append( timestamps, firstLine );
+
     indexedSize_  += size;
     maxLength_     = qMax( maxLength_, length );
     linePosition_ += linePosition;
 }
 
+TimestampParser IndexingData::getTimestampParser()
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return timestampIndex_.parser();
+}
+
+qint64 IndexingData::getNextTimestampSample()
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    const qint64 lastSample = timestampIndex_.lastSampleLine();
+    if ( lastSample < 0 )
+        return 0;
+
+    // Same first line as addAll
+    const qint64 firstLine = linePosition_.size()
+        - ( linePosition_.hasFakeFinalLF() ? 1 : 0 );
+    return lastSample + TimestampIndex::samplingInterval - firstLine;
+}
+
 LogDataWorkerThread::LogDataWorkerThread()
     : QThread(), mutex_(), operationRequestedCond_(),
-    nothingToDoCond_(), fileName_(), indexingData_()
+    fileName_(), indexingData_()
 {
-    terminate_          = false;
-    interruptRequested_ = false;
-    operationRequested_ = NULL;
+    terminate_           = false;
+    operationRequested_  = NULL;
+    operationInProgress_ = NULL;
 }
 
 LogDataWorkerThread::~LogDataWorkerThread()
@@ -71,9 +110,13 @@ LogDataWorkerThread::~LogDataWorkerThread()
     {
         QMutexLocker locker( &mutex_ );
         terminate_ = true;
+        if ( operationInProgress_ )
+            operationInProgress_->interrupt();
         operationRequestedCond_.wakeAll();
     }
     wait();
+
+    delete operationRequested_;
 }
 
 void LogDataWorkerThread::attachFile( const QString& fileName )
@@ -89,12 +132,12 @@ void LogDataWorkerThread::indexAll()
 
     LOG(logDEBUG) << "FullIndex requested";
 
-    // If an operation is ongoing, we will block
-    while ( (operationRequested_ != NULL) )
-        nothingToDoCond_.wait( &mutex_ );
+    // A full index supersedes whatever is running or pending
+    if ( operationInProgress_ )
+        operationInProgress_->interrupt();
 
-    interruptRequested_ = false;
-    operationRequested_ = new FullIndexOperation( fileName_, &interruptRequested_ );
+    delete operationRequested_;
+    operationRequested_ = new FullIndexOperation( fileName_ );
     operationRequestedCond_.wakeAll();
 }
 
@@ -104,29 +147,34 @@ void LogDataWorkerThread::indexAdditionalLines( qint64 position )
 
     LOG(logDEBUG) << "AddLines requested";
 
-    // If an operation is ongoing, we will block
-    while ( (operationRequested_ != NULL) )
-        nothingToDoCond_.wait( &mutex_ );
+    // A pending full index will pick up the new lines anyway
+    if ( dynamic_cast<FullIndexOperation*>( operationRequested_ ) ) {
+        LOG(logDEBUG) << "Full index pending, ignoring the AddLines";
+        return;
+    }
 
-    interruptRequested_ = false;
-    operationRequested_ = new PartialIndexOperation( fileName_, &interruptRequested_, position );
+    delete operationRequested_;
+    operationRequested_ = new PartialIndexOperation( fileName_, position );
     operationRequestedCond_.wakeAll();
 }
 
 void LogDataWorkerThread::interrupt()
 {
+    QMutexLocker locker( &mutex_ );  // to protect operationInProgress_
+
     LOG(logDEBUG) << "Load interrupt requested";
 
-    // No mutex here, setting a bool is probably atomic!
-    interruptRequested_ = true;
+    if ( operationInProgress_ )
+        operationInProgress_->interrupt();
 }
 
 // This will do an atomic copy of the object
 // (hopefully fast as we use Qt containers)
 void LogDataWorkerThread::getIndexingData(
-        qint64* indexedSize, int* maxLength, LinePositionArray* linePosition )
+        qint64* indexedSize, int* maxLength, LinePositionArray* linePosition,
+        TimestampIndex* timestamps )
 {
-    indexingData_.getAll( indexedSize, maxLength, linePosition );
+    indexingData_.getAll( indexedSize, maxLength, linePosition, timestamps );
 }
 
 // This is the thread's main loop
@@ -143,23 +191,28 @@ void LogDataWorkerThread::run()
         if ( terminate_ )
             return;      // We must die
 
-        if ( operationRequested_ ) {
-            connect( operationRequested_, SIGNAL( indexingProgressed( int ) ),
-                    this, SIGNAL( indexingProgressed( int ) ) );
+        // Take the operation, the mutex is released while it runs
+        // so new requests can be queued without blocking the caller.
+        operationInProgress_ = operationRequested_;
+        operationRequested_  = NULL;
 
-            // Run the operation
-            if ( operationRequested_->start( indexingData_ ) ) {
-                LOG(logDEBUG) << "... finished copy in workerThread.";
-                emit indexingFinished( true );
-            }
-            else {
-                emit indexingFinished( false );
-            }
+        connect( operationInProgress_, SIGNAL( indexingProgressed( int ) ),
+                this, SIGNAL( indexingProgressed( int ) ) );
 
-            delete operationRequested_;
-            operationRequested_ = NULL;
-            nothingToDoCond_.wakeAll();
-        }
+        locker.unlock();
+
+        // Run the operation
+        const bool success = operationInProgress_->start( indexingData_ );
+
+        locker.relock();
+
+        delete operationInProgress_;
+        operationInProgress_ = NULL;
+
+        if ( success )
+            LOG(logDEBUG) << "... finished copy in workerThread.";
+
+        emit indexingFinished( success );
     }
 }
 
@@ -167,26 +220,34 @@ void LogDataWorkerThread::run()
 // Operations implementation
 //
 
-IndexOperation::IndexOperation( QString& fileName, bool* interruptRequest )
-    : fileName_( fileName )
+IndexOperation::IndexOperation( const QString& fileName )
+    : fileName_( fileName ), interruptRequested_()
 {
-    interruptRequest_ = interruptRequest;
 }
 
-PartialIndexOperation::PartialIndexOperation( QString& fileName,
-        bool* interruptRequest, qint64 position )
-    : IndexOperation( fileName, interruptRequest )
+PartialIndexOperation::PartialIndexOperation( const QString& fileName,
+        qint64 position )
+    : IndexOperation( fileName )
 {
     initialPosition_ = position;
 }
 
 qint64 IndexOperation::doIndex( LinePositionArray& linePosition, int* maxLength,
-        qint64 initialPosition )
+        TimestampIndex* timestamps, qint64 initialPosition,
+        qint64 firstSample )
 {
     int max_length = *maxLength;
     qint64 pos = initialPosition; // Absolute position of the start of current line
     qint64 end = 0;               // Absolute position of the end of current line
     int additional_spaces = 0;    // Additional spaces due to tabs
+    const TimestampParser parser = timestamps->parser();
+    // Next line to sample, the first line of a partial indexing might
+    // start in the middle of a line so is not used.
+    qint64 next_sample = qMax<qint64>( firstSample,
+            ( initialPosition == 0 ) ? 0 : 1 );
+
+    PerfTimer timer( PerfCounters::IndexingTime );
+    TraceScope trace( "doIndex" );
 
     QFile file( fileName_ );
     if ( file.open( QIODevice::ReadOnly ) ) {
@@ -194,38 +255,57 @@ qint64 IndexOperation::doIndex( LinePositionArray& linePosition, int* maxLength,
         // (read big chunks to speed up reading from disk)
         file.seek( pos );
         while ( !file.atEnd() ) {
-            if ( *interruptRequest_ )   // a bool is always read/written atomically isn't it?
+            if ( interruptRequested_ )
                 break;
 
+            TraceScope chunk_trace( "indexChunk" );
+
             // Read a chunk of 5MB
             const qint64 block_beginning = file.pos();
             const QByteArray block = file.read( sizeChunk );
+            const qint64 nb_lines_before = linePosition.size();
 
             // Count the number of lines in each chunk
             qint64 pos_within_block = 0;
             while ( pos_within_block != -1 ) {
                 pos_within_block = qMax( pos - block_beginning, 0LL);
-                // Looking for the next \n, expanding tabs in the process
-                do {
-                    if ( pos_within_block < block.length() ) {
-                        const char c = block.at(pos_within_block);
-                        if ( c == '\n' )
-                            break;
-                        else if ( c == '\t' )
-                            additional_spaces += AbstractLogData::tabStop -
-                                ( ( ( block_beginning - pos ) + pos_within_block
-                                    + additional_spaces ) % AbstractLogData::tabStop ) - 1;
-
-                        pos_within_block++;
-                    }
-                    else {
-                        pos_within_block = -1;
-                    }
-                } while ( pos_within_block != -1 );
+                // Looking for the next \n, then expanding the tabs before
+                // it (both with memchr, long lines are common)
+                const char* const data = block.constData();
+                const qint64 remaining = qMax( block.length() - pos_within_block, 0LL );
+                const char* const eol = static_cast<const char*>(
+                        memchr( data + pos_within_block, '\n', remaining ) );
+                const char* const search_end = eol ? eol : data + block.length();
+
+                const char* tab = data + pos_within_block;
+                while ( ( tab = static_cast<const char*>(
+                                memchr( tab, '\t', search_end - tab ) ) ) != NULL ) {
+                    additional_spaces += AbstractLogData::tabStop -
+                        ( ( ( block_beginning - pos ) + ( tab - data )
+                            + additional_spaces ) % AbstractLogData::tabStop ) - 1;
+                    tab++;
+                }
+
+                pos_within_block = eol ? ( eol - data ) : -1;
 
                 // When a end of line has been found...
                 if ( pos_within_block != -1 ) {
                     end = pos_within_block + block_beginning;
+
+                    // Sample the timestamps (try the following lines
+                    // until one has a timestamp)
+                    if ( parser.isValid() && linePosition.size() >= next_sample
+                            && pos >= block_beginning ) {
+                        const qint64 time = parser.parse( QString::fromLatin1(
+                                    block.constData() + ( pos - block_beginning ),
+                                    qMin( end - pos, (qint64) timestampMaxLength ) ) );
+                        if ( time >= 0 ) {
+                            timestamps->addSample( linePosition.size(), time );
+                            next_sample = linePosition.size()
+                                + TimestampIndex::samplingInterval;
+                        }
+                    }
+
                     const int length = end-pos + additional_spaces;
                     if ( length > max_length )
                         max_length = length;
@@ -235,6 +315,10 @@ qint64 IndexOperation::doIndex( LinePositionArray& linePosition, int* maxLength,
                 }
             }
 
+            PerfCounters::add( PerfCounters::LinesIndexed,
+                    linePosition.size() - nb_lines_before );
+            PerfCounters::add( PerfCounters::BytesIndexed, block.length() );
+
             // Update the caller for progress indication
             int progress = ( file.size() > 0 ) ? pos*100 / file.size() : 100;
             emit indexingProgressed( progress );
@@ -271,21 +355,24 @@ bool FullIndexOperation::start( IndexingData& sharedData )
     LOG(logDEBUG) << "FullIndexOperation: Starting the count...";
     int maxLength = 0;
     LinePositionArray linePosition = LinePositionArray();
+    TimestampIndex timestamps;
 
     emit indexingProgressed( 0 );
 
-    qint64 size = doIndex( linePosition, &maxLength, 0 );
+    timestamps.setParser( detectTimestampFormat() );
+
+    qint64 size = doIndex( linePosition, &maxLength, &timestamps, 0, 0 );
 
-    if ( *interruptRequest_ == false )
+    if ( ! interruptRequested_.isSet() )
     {
         // Commit the results to the shared data (atomically)
-        sharedData.setAll( size, maxLength, linePosition );
+        sharedData.setAll( size, maxLength, linePosition, timestamps );
     }
 
     LOG(logDEBUG) << "FullIndexOperation: ... finished counting."
-        "interrupt = " << *interruptRequest_;
+        "interrupt = " << interruptRequested_.isSet();
 
-    return ( *interruptRequest_ ? false : true );
+    return ( ! interruptRequested_.isSet() );
 }
 
 bool PartialIndexOperation::start( IndexingData& sharedData )
@@ -297,18 +384,44 @@ bool PartialIndexOperation::start( IndexingData& sharedData )
         << initialPosition_ << " ...";
     int maxLength = 0;
     LinePositionArray linePosition = LinePositionArray();
+    TimestampIndex timestamps;
 
     emit indexingProgressed( 0 );
 
-    qint64 size = doIndex( linePosition, &maxLength, initialPosition_ );
+    // Use the format found when the file was fully indexed
+    timestamps.setParser( sharedData.getTimestampParser() );
 
-    if ( *interruptRequest_ == false )
+    // Carry on with the sampling interval of the lines already indexed
+    qint64 size = doIndex( linePosition, &maxLength, &timestamps,
+            initialPosition_, sharedData.getNextTimestampSample() );
+
+    if ( ! interruptRequested_.isSet() )
     {
         // Commit the results to the shared data (atomically)
-        sharedData.addAll( size - initialPosition_, maxLength, linePosition );
+        sharedData.addAll( size - initialPosition_, maxLength, linePosition,
+                timestamps );
     }
 
     LOG(logDEBUG) << "PartialIndexOperation: ... finished counting.";
 
-    return ( *interruptRequest_ ? false : true );
+    return ( ! interruptRequested_.isSet() );
+}
+
+TimestampParser FullIndexOperation::detectTimestampFormat()
+{
+    QStringList lines;
+
+    QFile file( fileName_ );
+    if ( file.open( QIODevice::ReadOnly ) ) {
+        const QByteArray beginning = file.read( timestampDetectionSize );
+
+        foreach ( const QByteArray& line, beginning.split( '\n' ) )
+            lines << QString::fromLatin1( line.left( timestampMaxLength ) );
+
+        // The last line is probably incomplete
+        if ( file.size() > beginning.size() )
+            lines.removeLast();
+    }
+
+    return TimestampParser( TimestampParser::detect( lines ) );
 }
@@ -26,46 +26,65 @@
 #include <QWaitCondition>
 #include <QVector>
 
+#include "atomicflag.h"
+#include "timestampindex.h"
+
 // This class is a list of end of lines position,
 // in addition to a list of qint64 (positions within the files)
 // it can keep track of whether the final LF was added (for non-LF terminated
 // files) and remove it when more data are added.
+// The positions are stored in blocks of blockSize, so the number of lines
+// is not limited by the (int) size of a QVector, and copying the array
+// only copies the blocks when they are modified.
 class LinePositionArray
 {
   public:
     // Default constructor
-    LinePositionArray() : array()
-    { fakeFinalLF_ = false; }
+    LinePositionArray() : blocks_()
+    { size_ = 0; fakeFinalLF_ = false; }
     // Copy constructor
     inline LinePositionArray( const LinePositionArray& orig )
-        : array(orig.array)
-    { fakeFinalLF_ = orig.fakeFinalLF_; }
+        : blocks_(orig.blocks_)
+    { size_ = orig.size_; fakeFinalLF_ = orig.fakeFinalLF_; }
 
     // Add a new line position at the given position
     inline void append( qint64 pos )
-    { array.append( pos ); }
+    {
+        if ( size_ % blockSize == 0 )
+            blocks_.append( QVector<qint64>() );
+        blocks_.last().append( pos );
+        ++size_;
+    }
     // Size of the array
-    inline int size()
-    { return array.size(); }
+    inline qint64 size() const
+    { return size_; }
     // Extract an element
-    inline qint64 at( int i ) const
-    { return array.at( i ); }
-    inline qint64 operator[]( int i ) const
-    { return array.at( i ); }
+    inline qint64 at( qint64 i ) const
+    { return blocks_.at( i / blockSize ).at( i % blockSize ); }
+    inline qint64 operator[]( qint64 i ) const
+    { return at( i ); }
     // Set the presence of a fake final LF
     // Must be used after 'append'-ing a fake LF at the end.
     void setFakeFinalLF( bool finalLF=true )
     { fakeFinalLF_ = finalLF; }
+    // Returns whether the final LF is fake (will be removed by '+=')
+    bool hasFakeFinalLF() const
+    { return fakeFinalLF_; }
 
     // Add another list to this one, removing any fake LF on this list.
     LinePositionArray& operator+= ( const LinePositionArray& other )
     {
         // If our final LF is fake, we remove it
-        if ( fakeFinalLF_ )
-            this->array.pop_back();
+        if ( fakeFinalLF_ && size_ > 0 ) {
+            blocks_.last().pop_back();
+            if ( blocks_.last().isEmpty() )
+                blocks_.pop_back();
+            --size_;
+        }
 
         // Append the arrays
-        this->array += other.array;
+        for ( qint64 i = 0; i < other.size_; i++ )
+            append( other.at( i ) );
 
         // In case the 'other' object has a fake LF
         this->fakeFinalLF_ = other.fakeFinalLF_;
@@ -74,7 +93,11 @@ class LinePositionArray
     }
 
   private:
-    QVector<qint64> array;
+    // Number of positions per block
+    static const int blockSize = 64 * 1024;
+
+    QVector< QVector<qint64> > blocks_;
+    qint64 size_;
     bool fakeFinalLF_;
 };
 
@@ -83,21 +106,32 @@ class LinePositionArray
 class IndexingData
 {
   public:
-    IndexingData() : dataMutex_(), linePosition_(), maxLength_(0), indexedSize_(0) { }
+    IndexingData() : dataMutex_(), linePosition_(), maxLength_(0),
+        indexedSize_(0), timestampIndex_() { }
 
     // Atomically get all the indexing data
     void getAll( qint64* size, int* length,
-            LinePositionArray* linePosition );
+            LinePositionArray* linePosition, TimestampIndex* timestamps );
 
     // Atomically set all the indexing data
     // (overwriting the existing)
     void setAll( qint64 size, int length,
-            const LinePositionArray& linePosition );
+            const LinePositionArray& linePosition,
+            const TimestampIndex& timestamps );
 
     // Atomically add to all the existing 
     // indexing data.
+    // The line numbers of the timestamps are relative to the first
+    // line added.
     void addAll( qint64 size, int length,
-            const LinePositionArray& linePosition );
+            const LinePositionArray& linePosition,
+            const TimestampIndex& timestamps );
+
+    // Returns the timestamp parser detected by the last full indexing
+    TimestampParser getTimestampParser();
+    // Returns the next line to sample for the timestamps, relative to
+    // the first line the next addAll will add.
+    qint64 getNextTimestampSample();
 
   private:
     QMutex dataMutex_;
@@ -105,13 +139,14 @@ class IndexingData
     LinePositionArray linePosition_;
     int maxLength_;
     qint64 indexedSize_;
+    TimestampIndex timestampIndex_;
 };
 
 class IndexOperation : public QObject
 {
   Q_OBJECT
   public:
-    IndexOperation( QString& fileName, bool* interruptRequest );
+    IndexOperation( const QString& fileName );
 
     virtual ~IndexOperation() { }
 
@@ -119,32 +154,42 @@ class IndexOperation : public QObject
     // and false if it has been cancelled (results not copied)
     virtual bool start( IndexingData& result ) = 0;
 
+    // Request the operation to stop as soon as possible, returns
+    // immediately (can be called from any thread).
+    void interrupt() { interruptRequested_.set(); }
+
   signals:
     void indexingProgressed( int );
 
   protected:
     static const int sizeChunk;
 
-    // Returns the total size indexed
+    // Returns the total size indexed, timestamps are sampled using
+    // their parser (if valid), starting at the line firstSample.
     qint64 doIndex( LinePositionArray& linePosition, int* maxLength,
-            qint64 initialPosition );
+            TimestampIndex* timestamps, qint64 initialPosition,
+            qint64 firstSample );
 
     QString fileName_;
-    bool* interruptRequest_;
+    AtomicFlag interruptRequested_;
 };
 
 class FullIndexOperation : public IndexOperation
 {
   public:
-    FullIndexOperation( QString& fileName, bool* interruptRequest )
-        : IndexOperation( fileName, interruptRequest ) { }
+    FullIndexOperation( const QString& fileName )
+        : IndexOperation( fileName ) { }
     virtual bool start( IndexingData& result );
+
+  private:
+    // Looks at the beginning of the file for a known timestamp format
+    TimestampParser detectTimestampFormat();
 };
 
 class PartialIndexOperation : public IndexOperation
 {
   public:
-    PartialIndexOperation( QString& fileName, bool* interruptRequest, qint64 position );
+    PartialIndexOperation( const QString& fileName, qint64 position );
     virtual bool start( IndexingData& result );
 
   private:
@@ -169,16 +214,20 @@ class LogDataWorkerThread : public QThread
     void attachFile( const QString& fileName );
     // Instructs the thread to start a new full indexing of the file, sending
     // signals as it progresses.
+    // Any operation in progress is interrupted and any pending one is
+    // dropped, this function never blocks.
     void indexAll();
     // Instructs the thread to start a partial indexing (starting at
-    // the index passed).
+    // the index passed), after the operation in progress if any.
+    // This function never blocks.
     void indexAdditionalLines( qint64 position );
-    // Interrupts the indexing if one is in progress
+    // Interrupts the indexing if one is in progress (does not block)
     void interrupt();
 
     // Returns a copy of the current indexing data
     void getIndexingData( qint64* indexedSize,
-            int* maxLength, LinePositionArray* linePosition );
+            int* maxLength, LinePositionArray* linePosition,
+            TimestampIndex* timestamps );
 
   signals:
     // Sent during the indexing process to signal progress
@@ -192,18 +241,17 @@ class LogDataWorkerThread : public QThread
     void run();
 
   private:
-    void doIndexAll();
-
     // Mutex to protect operationRequested_ and friends
     QMutex mutex_;
     QWaitCondition operationRequestedCond_;
-    QWaitCondition nothingToDoCond_;
     QString fileName_;
 
     // Set when the thread must die
     bool terminate_;
-    bool interruptRequested_;
+    // Next operation to run (owned)
     IndexOperation* operationRequested_;
+    // Operation being run by the thread (owned)
+    IndexOperation* operationInProgress_;
 
     // Shared indexing data
     IndexingData indexingData_;
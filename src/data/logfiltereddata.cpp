@@ -31,14 +31,18 @@
 #include "logdata.h"
 #include "marks.h"
 #include "logfiltereddata.h"
+#include "tracer.h"
 
 // Creates an empty set. It must be possible to display it without error.
 // FIXME
 LogFilteredData::LogFilteredData() : AbstractLogData(),
     matchingLineList( QList<MatchingLine>() ),
     currentRegExp_(),
+    histogram_(),
+    slowLines_(),
     visibility_(),
     filteredItemsCache_(),
+    dataMutex_( QMutex::Recursive ),
     workerThread_( nullptr ),
     marks_( new Marks() )
 {
@@ -46,9 +50,14 @@ LogFilteredData::LogFilteredData() : AbstractLogData(),
     /* Prevent any more searching */
     maxLength_ = 0;
     maxLengthMarks_ = 0;
+    nbLinesProcessed_ = 0;
+    nbMatchesFound_ = 0;
+    searchBudgetExhausted_ = false;
+    searchGeneration_ = 0;
     searchDone_ = true;
     visibility_ = MarksAndMatches;
 
+    linesGeneration_ = 0;
     filteredItemsCacheDirty_ = true;
 }
 
@@ -57,8 +66,11 @@ LogFilteredData::LogFilteredData( const LogData* logData )
     : AbstractLogData(),
     matchingLineList( SearchResultArray() ),
     currentRegExp_(),
+    histogram_(),
+    slowLines_(),
     visibility_(),
     filteredItemsCache_(),
+    dataMutex_( QMutex::Recursive ),
     workerThread_( logData ),
     marks_( new Marks() )
 {
@@ -66,6 +78,9 @@ LogFilteredData::LogFilteredData( const LogData* logData )
     maxLength_ = 0;
     maxLengthMarks_ = 0;
     nbLinesProcessed_ = 0;
+    nbMatchesFound_ = 0;
+    searchBudgetExhausted_ = false;
+    searchGeneration_ = 0;
 
     sourceLogData_ = logData;
 
@@ -73,11 +88,12 @@ LogFilteredData::LogFilteredData( const LogData* logData )
 
     visibility_ = MarksAndMatches;
 
+    linesGeneration_ = 0;
     filteredItemsCacheDirty_ = true;
 
     // Forward the update signal
-    connect( &workerThread_, SIGNAL( searchProgressed( int, int ) ),
-            this, SLOT( handleSearchProgressed( int, int ) ) );
+    connect( &workerThread_, SIGNAL( searchProgressed( int, int, int ) ),
+            this, SLOT( handleSearchProgressed( int, int, int ) ) );
 
     // Starts the worker thread
     workerThread_.start();
@@ -94,24 +110,40 @@ LogFilteredData::~LogFilteredData()
 //
 
 // Run the search and send newDataAvailable() signals.
-void LogFilteredData::runSearch( const QRegExp& regExp )
+void LogFilteredData::runSearch( const QRegExp& regExp, qint64 startLine )
 {
     LOG(logDEBUG) << "Entering runSearch";
 
     // Reset the search
+    QMutexLocker locker( &dataMutex_ );
     currentRegExp_ = regExp;
     matchingLineList.clear();
     maxLength_ = 0;
     maxLengthMarks_ = 0;
+    nbLinesProcessed_ = 0;
+    nbMatchesFound_ = 0;
+    histogram_.clear();
+    slowLines_.clear();
+    searchBudgetExhausted_ = false;
+    filteredItemsCacheDirty_ = true;
+    ++linesGeneration_;
 
-    workerThread_.search( currentRegExp_ );
+    searchGeneration_ = workerThread_.search( currentRegExp_, startLine );
 }
 
 void LogFilteredData::updateSearch()
 {
     LOG(logDEBUG) << "Entering updateSearch";
 
-    workerThread_.updateSearch( currentRegExp_, nbLinesProcessed_ );
+    // The lines not searched would be searched again (and the slow
+    // lines tried again), the search has to be run anew instead
+    if ( searchBudgetExhausted_ ) {
+        LOG(logDEBUG) << "Search stopped by its budget, not updated";
+        return;
+    }
+
+    searchGeneration_ =
+        workerThread_.updateSearch( currentRegExp_, nbLinesProcessed_ );
 }
 
 void LogFilteredData::interruptSearch()
@@ -123,13 +155,52 @@ void LogFilteredData::interruptSearch()
 
 void LogFilteredData::clearSearch()
 {
+    // Whatever is still coming from the worker is now obsolete
+    searchGeneration_ = 0;
+
+    QMutexLocker locker( &dataMutex_ );
     currentRegExp_ = QRegExp();
     matchingLineList.clear();
+    nbMatchesFound_ = 0;
+    histogram_.clear();
+    slowLines_.clear();
+    searchBudgetExhausted_ = false;
     maxLength_ = 0;
     filteredItemsCacheDirty_ = true;
+    ++linesGeneration_;
+}
+
+void LogFilteredData::setSearchRange( qint64 beginLine, qint64 endLine )
+{
+    workerThread_.setSearchRange( beginLine, endLine );
+}
+
+void LogFilteredData::setSearchMode( SearchMode mode, int maxMatches )
+{
+    workerThread_.setSearchMode( mode, maxMatches );
+}
+
+void LogFilteredData::setSearchDirection( SearchDirection direction )
+{
+    workerThread_.setSearchDirection( direction );
 }
 
-qint64 LogFilteredData::getMatchingLineNumber( int matchNum ) const
+void LogFilteredData::setBacktrackingLimited( bool limited )
+{
+    workerThread_.setBacktrackingLimited( limited );
+}
+
+void LogFilteredData::setSearchIndexEnabled( bool enabled )
+{
+    workerThread_.setSearchIndexEnabled( enabled );
+}
+
+void LogFilteredData::buildSearchIndex()
+{
+    workerThread_.buildSearchIndex();
+}
+
+qint64 LogFilteredData::getMatchingLineNumber( qint64 matchNum ) const
 {
     qint64 matchingLine = findLogDataLine( matchNum );
 
@@ -155,13 +226,38 @@ int LogFilteredData::getNbMatches() const
     return matchingLineList.size();
 }
 
+qint64 LogFilteredData::getNbMatchesFound() const
+{
+    return nbMatchesFound_;
+}
+
 int LogFilteredData::getNbMarks() const
 {
     return marks_->size();
 }
 
+qint64 LogFilteredData::getMarkedLineNumber( int index ) const
+{
+    return marks_->getLineMarkedByIndex( index );
+}
+
+const MatchHistogram& LogFilteredData::getMatchHistogram() const
+{
+    return histogram_;
+}
+
+const QList<qint64>& LogFilteredData::getSlowLines() const
+{
+    return slowLines_;
+}
+
+bool LogFilteredData::isSearchBudgetExhausted() const
+{
+    return searchBudgetExhausted_;
+}
+
 LogFilteredData::FilteredLineType
-    LogFilteredData::filteredLineTypeByIndex( int index ) const
+    LogFilteredData::filteredLineTypeByIndex( qint64 index ) const
 {
     // If we are only showing one type, the line is there because
     // it is of this type.
@@ -186,10 +282,12 @@ void LogFilteredData::addMark( qint64 line, QChar mark )
     assert( marks_ );
 
     if ( ( line >= 0 ) && ( line < sourceLogData_->getNbLine() ) ) {
+        QMutexLocker locker( &dataMutex_ );
         marks_->addMark( line, mark );
         maxLengthMarks_ = qMax( maxLengthMarks_,
                 sourceLogData_->getLineLength( line ) );
         filteredItemsCacheDirty_ = true;
+        ++linesGeneration_;
     }
     else
         LOG(logERROR) << "LogFilteredData::addMark\
@@ -214,8 +312,10 @@ void LogFilteredData::deleteMark( QChar mark )
 {
     assert( marks_ );
 
+    QMutexLocker locker( &dataMutex_ );
     marks_->deleteMark( mark );
     filteredItemsCacheDirty_ = true;
+    ++linesGeneration_;
 
     // FIXME: maxLengthMarks_
 }
@@ -224,8 +324,10 @@ void LogFilteredData::deleteMark( qint64 line )
 {
     assert( marks_ );
 
+    QMutexLocker locker( &dataMutex_ );
     marks_->deleteMark( line );
     filteredItemsCacheDirty_ = true;
+    ++linesGeneration_;
 
     // Now update the max length if needed
     if ( sourceLogData_->getLineLength( line ) >= maxLengthMarks_ ) {
@@ -244,31 +346,91 @@ void LogFilteredData::clearMarks()
 {
     assert( marks_ );
 
+    QMutexLocker locker( &dataMutex_ );
     marks_->clear();
     filteredItemsCacheDirty_ = true;
+    ++linesGeneration_;
     maxLengthMarks_ = 0;
 }
 
 void LogFilteredData::setVisibility( Visibility visi )
 {
+    QMutexLocker locker( &dataMutex_ );
     visibility_ = visi;
+    ++linesGeneration_;
 }
 
 //
 // Slots
 //
-void LogFilteredData::handleSearchProgressed( int nbMatches, int progress )
+void LogFilteredData::handleSearchProgressed( int nbMatches, int progress,
+        int generation )
 {
     LOG(logDEBUG) << "LogFilteredData::handleSearchProgressed matches="
-        << nbMatches << " progress=" << progress;
+        << nbMatches << " progress=" << progress
+        << " generation=" << generation;
+
+    if ( generation != searchGeneration_ ) {
+        LOG(logDEBUG) << "Stale progress ignored (current generation is "
+            << searchGeneration_ << ")";
+        return;
+    }
 
     // searchDone_ = true;
-    workerThread_.getSearchResult( &maxLength_, &matchingLineList, &nbLinesProcessed_ );
+    QMutexLocker locker( &dataMutex_ );
+    const int oldNbMatches = matchingLineList.size();
+    const qint64 oldLastMatch = ( oldNbMatches > 0 ) ?
+        matchingLineList.last().lineNumber() : -1;
+    const qint64 oldNbLinesProcessed = nbLinesProcessed_;
+
+    workerThread_.getSearchResult( &maxLength_, &matchingLineList,
+            &nbLinesProcessed_, &nbMatchesFound_, &histogram_ );
+    workerThread_.getSlowLines( &slowLines_, &searchBudgetExhausted_ );
     filteredItemsCacheDirty_ = true;
 
+    // When following a file, the new matches are usually appended to the
+    // old ones, the lines already displayed are unchanged and the views
+    // can keep what they have rendered.
+    if ( ! isAppendOnly( oldNbMatches, oldLastMatch, oldNbLinesProcessed ) )
+        ++linesGeneration_;
+    locker.unlock();
+
     emit searchProgressed( nbMatches, progress );
 }
 
+bool LogFilteredData::isAppendOnly( int oldNbMatches, qint64 oldLastMatch,
+        qint64 oldNbLinesProcessed ) const
+{
+    const int nbMatches = matchingLineList.size();
+
+    if ( nbMatches < oldNbMatches )
+        return false;
+
+    // The old matches must be kept, the last line processed is searched
+    // again (it might have been incomplete) so it cannot be one of them.
+    if ( oldNbMatches > 0
+            && ( matchingLineList[ oldNbMatches - 1 ].lineNumber() != oldLastMatch
+                || oldLastMatch >= oldNbLinesProcessed - 1 ) )
+        return false;
+
+    // And the new ones must come after everything displayed
+    if ( visibility_ != MatchesOnly && nbMatches > oldNbMatches
+            && marks_->size() > 0
+            && marks_->getLineMarkedByIndex( marks_->size() - 1 ) >=
+                matchingLineList[ oldNbMatches ].lineNumber() )
+        return false;
+
+    return true;
+}
+
+// Same as findLogDataLine, for the functions which can be called
+// from another thread.
+qint64 LogFilteredData::lockedFindLogDataLine( qint64 lineNum ) const
+{
+    QMutexLocker locker( &dataMutex_ );
+    return findLogDataLine( lineNum );
+}
+
 qint64 LogFilteredData::findLogDataLine( qint64 lineNum ) const
 {
     qint64 line = 0;
@@ -303,7 +465,7 @@ qint64 LogFilteredData::findLogDataLine( qint64 lineNum ) const
 // Implementation of the virtual function.
 QString LogFilteredData::doGetLineString( qint64 lineNum ) const
 {
-    qint64 line = findLogDataLine( lineNum );
+    const qint64 line = lockedFindLogDataLine( lineNum );
 
     QString string = sourceLogData_->getLineString( line );
     return string;
@@ -312,7 +474,7 @@ QString LogFilteredData::doGetLineString( qint64 lineNum ) const
 // Implementation of the virtual function.
 QString LogFilteredData::doGetExpandedLineString( qint64 lineNum ) const
 {
-    qint64 line = findLogDataLine( lineNum );
+    const qint64 line = lockedFindLogDataLine( lineNum );
 
     QString string = sourceLogData_->getExpandedLineString( line );
     return string;
@@ -321,30 +483,50 @@ QString LogFilteredData::doGetExpandedLineString( qint64 lineNum ) const
 // Implementation of the virtual function.
 QStringList LogFilteredData::doGetLines( qint64 first_line, int number ) const
 {
-    QStringList list;
-
-    for ( int i = first_line; i < first_line + number; i++ ) {
-        list.append( doGetLineString( i ) );
+    QList<qint64> lines;
+    {
+        // The lines are read without holding the lock
+        QMutexLocker locker( &dataMutex_ );
+        for ( qint64 i = first_line; i < first_line + number; i++ )
+            lines.append( findLogDataLine( i ) );
     }
 
-    return list;
+    return sourceLogData_->getLinesAt( lines );
 }
 
 // Implementation of the virtual function.
 QStringList LogFilteredData::doGetExpandedLines( qint64 first_line, int number ) const
 {
-    QStringList list;
+    QList<qint64> lines;
+    {
+        // The lines are read without holding the lock
+        QMutexLocker locker( &dataMutex_ );
+        for ( qint64 i = first_line; i < first_line + number; i++ )
+            lines.append( findLogDataLine( i ) );
+    }
+
+    return sourceLogData_->getExpandedLinesAt( lines );
+}
 
-    for ( int i = first_line; i < first_line + number; i++ ) {
-        list.append( doGetExpandedLineString( i ) );
+// Implementation of the virtual function.
+QStringList LogFilteredData::doGetExpandedLinesWindow( qint64 first_line,
+        int number, int first_col, int nb_cols ) const
+{
+    QList<qint64> lines;
+    {
+        // The lines are read without holding the lock
+        QMutexLocker locker( &dataMutex_ );
+        for ( qint64 i = first_line; i < first_line + number; i++ )
+            lines.append( findLogDataLine( i ) );
     }
 
-    return list;
+    return sourceLogData_->getExpandedLinesWindowAt( lines, first_col, nb_cols );
 }
 
 // Implementation of the virtual function.
 qint64 LogFilteredData::doGetNbLine() const
 {
+    QMutexLocker locker( &dataMutex_ );
     qint64 nbLines;
 
     if ( visibility_ == MatchesOnly )
@@ -380,8 +562,15 @@ int LogFilteredData::doGetMaxLength() const
 // Implementation of the virtual function.
 int LogFilteredData::doGetLineLength( qint64 lineNum ) const
 {
-    qint64 line = findLogDataLine( lineNum );
-    return sourceLogData_->getExpandedLineString( line ).length();
+    const qint64 line = lockedFindLogDataLine( lineNum );
+    return sourceLogData_->getLineLength( line );
+}
+
+// Implementation of the virtual function.
+int LogFilteredData::doGetLinesGeneration() const
+{
+    QMutexLocker locker( &dataMutex_ );
+    return linesGeneration_;
 }
 
 // TODO: We might be a bit smarter and not regenerate the whole thing when
@@ -389,6 +578,9 @@ int LogFilteredData::doGetLineLength( qint64 lineNum ) const
 void LogFilteredData::regenerateFilteredItemsCache() const
 {
     LOG(logDEBUG) << "regenerateFilteredItemsCache";
+    TraceScope trace( "regenerateFilteredItemsCache" );
+
+    QMutexLocker locker( &dataMutex_ );
 
     filteredItemsCache_.clear();
     filteredItemsCache_.reserve( matchingLineList.size() + marks_->size() );
@@ -28,6 +28,7 @@
 #include <QVector>
 #include <QStringList>
 #include <QRegExp>
+#include <QMutex>
 
 #include "abstractlogdata.h"
 #include "logfiltereddataworkerthread.h"
@@ -52,20 +53,49 @@ class LogFilteredData : public AbstractLogData {
     ~LogFilteredData();
 
     // Starts the async search, sending newDataAvailable() when new data found.
-    // If a search is already in progress this function will block until
-    // it is done, so the application should call interruptSearch() first.
-    void runSearch( const QRegExp& regExp );
+    // If a search is already in progress it is superseded by the new one,
+    // this function never blocks and the results of the old search are
+    // discarded.
+    // The search starts at startLine (e.g. the line displayed) and goes
+    // in the direction set by setSearchDirection() (wrapping around when
+    // going forward), the results are always kept in file order.
+    void runSearch( const QRegExp& regExp, qint64 startLine = 0 );
     // Add to the existing search, starting at the line when the search was
     // last stopped. Used when the file on disk has been added too.
+    // Does nothing if the search has been stopped by its budget.
     void updateSearch();
     // Interrupt the running search if one is in progress.
     // Nothing is done if no search is in progress.
+    // Returns immediately, the last searchProgressed() is sent
+    // when the search has actually stopped.
     void interruptSearch();
     // Clear the search and the list of results.
     void clearSearch();
+    // Restricts the next searches to the lines in [beginLine, endLine[
+    // of the source data (endLine being -1 for the end of the file).
+    void setSearchRange( qint64 beginLine, qint64 endLine = -1 );
+    // Set what the next searches keep of the matches: all of them
+    // (SearchAllMatches), only their number (SearchCountOnly, no line is
+    // then available) or the first maxMatches of them in the file
+    // (SearchFirstMatches, the search stops there).
+    void setSearchMode( SearchMode mode, int maxMatches = 0 );
+    // Set the order in which the next searches go through the file,
+    // SearchBackward finds the newest lines first.  In both cases the
+    // results are kept in file order.
+    void setSearchDirection( SearchDirection direction );
+    // Set whether the next searches limit the backtracking of the regexp
+    // (Qt5 only), the lines it would take too long to match then do not
+    // match (see RegExpBudget::limitedRegExp).
+    void setBacktrackingLimited( bool limited );
+    // Enable/disable the in-memory index of the file content used to
+    // skip the parts of the file that cannot match a search.
+    void setSearchIndexEnabled( bool enabled );
+    // Complete the index in the background if enabled and no search
+    // is in progress.
+    void buildSearchIndex();
     // Returns the line number in the original LogData where the element
     // 'index' was found.
-    qint64 getMatchingLineNumber( int index ) const;
+    qint64 getMatchingLineNumber( qint64 index ) const;
     // Returns whether the line number passed is in our list of matching ones.
     bool isLineInMatchingList( qint64 lineNumber );
 
@@ -73,13 +103,27 @@ class LogFilteredData : public AbstractLogData {
     qint64 getNbTotalLines() const;
     // Returns the number of matches (independently of the visibility)
     int getNbMatches() const;
+    // Returns the number of matches found by the search, including the
+    // ones which are only counted (SearchCountOnly).
+    qint64 getNbMatchesFound() const;
     // Returns the number of marks (independently of the visibility)
     int getNbMarks() const;
+    // Returns the line number of the mark 'index' (in file order).
+    qint64 getMarkedLineNumber( int index ) const;
+    // Returns the distribution of the matches in the file
+    // (valid until the next searchProgressed).
+    const MatchHistogram& getMatchHistogram() const;
+    // Returns the lines the regular expression has been too slow to match
+    // (see RegExpBudget), in the order they were searched.
+    const QList<qint64>& getSlowLines() const;
+    // Returns whether the search has been abandoned because of the time
+    // spent on the slow lines.
+    bool isSearchBudgetExhausted() const;
 
     // Returns the reason why the line at the passed index is in the filtered
     // data.  It can be because it is either a mark or a match.
     enum FilteredLineType { Match, Mark };
-    FilteredLineType filteredLineTypeByIndex( int index ) const;
+    FilteredLineType filteredLineTypeByIndex( qint64 index ) const;
 
     // Marks interface (delegated to a Marks object)
 
@@ -109,7 +153,7 @@ class LogFilteredData : public AbstractLogData {
     void searchProgressed( int nbMatches, int progress );
 
   private slots:
-    void handleSearchProgressed( int NbMatches, int progress );
+    void handleSearchProgressed( int nbMatches, int progress, int generation );
 
   private:
     class FilteredItem;
@@ -119,9 +163,12 @@ class LogFilteredData : public AbstractLogData {
     QString doGetExpandedLineString( qint64 line ) const;
     QStringList doGetLines( qint64 first, int number ) const;
     QStringList doGetExpandedLines( qint64 first, int number ) const;
+    QStringList doGetExpandedLinesWindow( qint64 first, int number,
+            int first_col, int nb_cols ) const;
     qint64 doGetNbLine() const;
     int doGetMaxLength() const;
     int doGetLineLength( qint64 line ) const;
+    int doGetLinesGeneration() const;
 
     QList<MatchingLine> matchingLineList;
 
@@ -132,6 +179,14 @@ class LogFilteredData : public AbstractLogData {
     int maxLengthMarks_;
     // Number of lines of the LogData that has been searched for:
     qint64 nbLinesProcessed_;
+    // Number of matches including those not stored
+    qint64 nbMatchesFound_;
+    MatchHistogram histogram_;
+    QList<qint64> slowLines_;
+    bool searchBudgetExhausted_;
+    // Generation of the search we are displaying, progress sent by
+    // any other (superseded) search is ignored.
+    int searchGeneration_;
 
     Visibility visibility_;
 
@@ -141,12 +196,25 @@ class LogFilteredData : public AbstractLogData {
     mutable QVector<FilteredItem> filteredItemsCache_;
     mutable bool filteredItemsCacheDirty_;
 
+    // The lines can be read from another thread (QuickFind), this
+    // protects the lists and the cache above.  As they are only modified
+    // by the UI thread, it must be locked to modify them, to regenerate
+    // the cache and by the functions reading the lines (doGetXXX).
+    mutable QMutex dataMutex_;
+    // Changed with any of the lists (see getLinesGeneration)
+    int linesGeneration_;
+
     LogFilteredDataWorkerThread workerThread_;
     std::unique_ptr<Marks> marks_;
 
     // Utility functions
     qint64 findLogDataLine( qint64 lineNum ) const;
+    qint64 lockedFindLogDataLine( qint64 lineNum ) const;
     void regenerateFilteredItemsCache() const;
+    // Returns whether the new search results only add lines after the
+    // ones computed from the passed old results (dataMutex_ held)
+    bool isAppendOnly( int oldNbMatches, qint64 oldLastMatch,
+            qint64 oldNbLinesProcessed ) const;
 };
 
 // A class representing a Mark or Match.
@@ -17,24 +17,30 @@
  * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
 #include <QFile>
 
 #include "log.h"
 
 #include "logfiltereddataworkerthread.h"
 #include "logdata.h"
+#include "perfcounters.h"
+#include "tracer.h"
 
 // Number of lines in each chunk to read
 const int SearchOperation::nbLinesInChunk = 5000;
 
 void SearchData::getAll( int* length, SearchResultArray* matches,
-        qint64* lines) const
+        qint64* lines, qint64* nbMatches, MatchHistogram* histogram ) const
 {
     QMutexLocker locker( &dataMutex_ );
 
-    *length  = maxLength_;
-    *matches = matches_;
-    *lines   = nbLinesProcessed_;
+    *length    = maxLength_;
+    *matches   = matches_;
+    *lines     = nbLinesProcessed_;
+    *nbMatches = matches_.count() + nbMatchesCounted_;
+    *histogram = histogram_;
 }
 
 void SearchData::setAll( int length,
@@ -47,20 +53,74 @@ void SearchData::setAll( int length,
 }
 
 void SearchData::addAll( int length,
-        const SearchResultArray& matches, qint64 lines )
+        const SearchResultArray& matches, qint64 lines,
+        const MatchHistogram& histogram )
 {
     QMutexLocker locker( &dataMutex_ );
 
     maxLength_        = qMax( maxLength_, length );
-    matches_          += matches;
-    nbLinesProcessed_ = lines;
+    nbLinesProcessed_ = qMax( nbLinesProcessed_, lines );
+    histogram_.merge( histogram );
+
+    if ( matches.isEmpty() )
+        return;
+
+    if ( matches_.isEmpty() || matches_.last() < matches.first() ) {
+        matches_ += matches;
+    }
+    else if ( matches.last() < matches_.first() ) {
+        // Backward search, QList prepends in constant time
+        for ( int i = matches.size() - 1; i >= 0; i-- )
+            matches_.prepend( matches[i] );
+    }
+    else {
+        // These matches come from earlier in the file (wrapped search),
+        // insert them where they belong.
+        int index = std::lower_bound( matches_.begin(), matches_.end(),
+                matches.first() ) - matches_.begin();
+        foreach ( const MatchingLine& match, matches )
+            matches_.insert( index++, match );
+    }
+}
+
+void SearchData::addCount( qint64 nbMatches, qint64 lastMatch )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    nbMatchesCounted_ += nbMatches;
+    lastMatchCounted_  = qMax( lastMatchCounted_, lastMatch );
 }
 
-int SearchData::getNbMatches() const
+qint64 SearchData::getNbMatches() const
 {
     QMutexLocker locker( &dataMutex_ );
 
-    return matches_.count();
+    return matches_.count() + nbMatchesCounted_;
+}
+
+qint64 SearchData::getNbLinesProcessed() const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return nbLinesProcessed_;
+}
+
+void SearchData::addSlowLines( const QList<qint64>& lines,
+        bool budgetExhausted )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    slowLines_ += lines;
+    budgetExhausted_ = budgetExhausted_ || budgetExhausted;
+}
+
+void SearchData::getSlowLines( QList<qint64>* lines,
+        bool* budgetExhausted ) const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    *lines           = slowLines_;
+    *budgetExhausted = budgetExhausted_;
 }
 
 // This function starts searching from the end since we use it
@@ -69,12 +129,21 @@ void SearchData::deleteMatch( qint64 line )
 {
     QMutexLocker locker( &dataMutex_ );
 
+    // Only the last match counted is known (that's all an update needs)
+    if ( nbMatchesCounted_ > 0 && lastMatchCounted_ == line ) {
+        nbMatchesCounted_--;
+        lastMatchCounted_ = -1;
+        histogram_.remove( line );
+        return;
+    }
+
     SearchResultArray::iterator i = matches_.end();
     while ( i != matches_.begin() ) {
         i--;
-        const int this_line = i->lineNumber();
+        const qint64 this_line = i->lineNumber();
         if ( this_line == line ) {
             matches_.erase(i);
+            histogram_.remove( line );
             break;
         }
         // Exit if we have passed the line number to look for.
@@ -89,17 +158,32 @@ void SearchData::clear()
 
     maxLength_ = 0;
     matches_.clear();
+    nbLinesProcessed_ = 0;
+    nbMatchesCounted_ = 0;
+    lastMatchCounted_ = -1;
+    histogram_.clear();
+    slowLines_.clear();
+    budgetExhausted_ = false;
 }
 
 
 
 LogFilteredDataWorkerThread::LogFilteredDataWorkerThread(
         const LogData* sourceLogData )
-    : QThread(), mutex_(), operationRequestedCond_(), nothingToDoCond_(), searchData_()
+    : QThread(), mutex_(), operationRequestedCond_(), searchIndex_(),
+    searchData_()
 {
-    terminate_          = false;
-    interruptRequested_ = false;
-    operationRequested_ = NULL;
+    terminate_           = false;
+    operationRequested_  = NULL;
+    operationInProgress_ = NULL;
+    generation_          = 0;
+    rangeBegin_          = 0;
+    rangeEnd_            = -1;
+    searchMode_          = SearchAllMatches;
+    maxMatches_          = 0;
+    searchDirection_     = SearchForward;
+    backtrackingLimited_ = false;
+    searchIndexEnabled_  = false;
 
     sourceLogData_ = sourceLogData;
 }
@@ -109,64 +193,164 @@ LogFilteredDataWorkerThread::~LogFilteredDataWorkerThread()
     {
         QMutexLocker locker( &mutex_ );
         terminate_ = true;
+        if ( operationInProgress_ )
+            operationInProgress_->interrupt();
         operationRequestedCond_.wakeAll();
     }
     wait();
+
+    delete operationRequested_;
 }
 
-void LogFilteredDataWorkerThread::search( const QRegExp& regExp )
+int LogFilteredDataWorkerThread::search( const QRegExp& regExp,
+        qint64 startLine )
 {
     QMutexLocker locker( &mutex_ );  // to protect operationRequested_
 
     LOG(logDEBUG) << "Search requested";
 
-    // If an operation is ongoing, we will block
-    while ( (operationRequested_ != NULL) )
-        nothingToDoCond_.wait( &mutex_ );
+    // The new search supersedes everything
+    if ( operationInProgress_ )
+        operationInProgress_->interrupt();
 
-    interruptRequested_ = false;
+    delete operationRequested_;
     operationRequested_ = new FullSearchOperation( sourceLogData_,
-            regExp, &interruptRequested_ );
+            regExp, ++generation_,
+            searchIndexEnabled_ ? &searchIndex_ : NULL, startLine,
+            rangeBegin_, rangeEnd_ );
+    operationRequested_->setSearchMode( searchMode_, maxMatches_ );
+    operationRequested_->setSearchDirection( searchDirection_ );
+    operationRequested_->setBacktrackingLimited( backtrackingLimited_ );
     operationRequestedCond_.wakeAll();
+
+    return generation_;
 }
 
-void LogFilteredDataWorkerThread::updateSearch( const QRegExp& regExp, qint64 position )
+int LogFilteredDataWorkerThread::updateSearch( const QRegExp& regExp, qint64 position )
 {
     QMutexLocker locker( &mutex_ );  // to protect operationRequested_
 
-    LOG(logDEBUG) << "Search requested";
+    LOG(logDEBUG) << "Search update requested";
+
+    // A pending full search will include the new lines anyway
+    if ( dynamic_cast<FullSearchOperation*>( operationRequested_ ) ) {
+        LOG(logDEBUG) << "Full search pending, ignoring the update";
+        return generation_;
+    }
 
-    // If an operation is ongoing, we will block
-    while ( (operationRequested_ != NULL) )
-        nothingToDoCond_.wait( &mutex_ );
+    // Don't wait for the index to be built
+    if ( dynamic_cast<IndexBuildOperation*>( operationInProgress_ ) )
+        operationInProgress_->interrupt();
 
-    interruptRequested_ = false;
+    delete operationRequested_;
     operationRequested_ = new UpdateSearchOperation( sourceLogData_,
-            regExp, &interruptRequested_, position );
+            regExp, generation_,
+            searchIndexEnabled_ ? &searchIndex_ : NULL, position,
+            rangeBegin_, rangeEnd_ );
+    operationRequested_->setSearchMode( searchMode_, maxMatches_ );
+    operationRequested_->setBacktrackingLimited( backtrackingLimited_ );
     operationRequestedCond_.wakeAll();
+
+    return generation_;
 }
 
 void LogFilteredDataWorkerThread::interrupt()
 {
+    QMutexLocker locker( &mutex_ );  // to protect operationInProgress_
+
     LOG(logDEBUG) << "Search interruption requested";
 
-    // No mutex here, setting a bool is probably atomic!
-    interruptRequested_ = true;
+    if ( operationInProgress_ )
+        operationInProgress_->interrupt();
 
-    // We wait for the interruption to be done
-    {
-        QMutexLocker locker( &mutex_ );
-        while ( (operationRequested_ != NULL) )
-            nothingToDoCond_.wait( &mutex_ );
+    delete operationRequested_;
+    operationRequested_ = NULL;
+}
+
+void LogFilteredDataWorkerThread::setSearchRange( qint64 beginLine,
+        qint64 endLine )
+{
+    QMutexLocker locker( &mutex_ );
+
+    LOG(logDEBUG) << "Search range set to " << beginLine << "-" << endLine;
+
+    rangeBegin_ = beginLine;
+    rangeEnd_   = endLine;
+}
+
+void LogFilteredDataWorkerThread::setSearchMode( SearchMode mode,
+        int maxMatches )
+{
+    QMutexLocker locker( &mutex_ );
+
+    LOG(logDEBUG) << "Search mode set to " << mode
+        << " (max matches " << maxMatches << ")";
+
+    searchMode_ = mode;
+    maxMatches_ = maxMatches;
+}
+
+void LogFilteredDataWorkerThread::setSearchDirection(
+        SearchDirection direction )
+{
+    QMutexLocker locker( &mutex_ );
+
+    LOG(logDEBUG) << "Search direction set to " << direction;
+
+    searchDirection_ = direction;
+}
+
+void LogFilteredDataWorkerThread::setBacktrackingLimited( bool limited )
+{
+    QMutexLocker locker( &mutex_ );
+
+    LOG(logDEBUG) << "Backtracking limited: " << limited;
+
+    backtrackingLimited_ = limited;
+}
+
+void LogFilteredDataWorkerThread::setSearchIndexEnabled( bool enabled )
+{
+    QMutexLocker locker( &mutex_ );
+
+    LOG(logDEBUG) << "Search index enabled: " << enabled;
+
+    searchIndexEnabled_ = enabled;
+
+    // Free the memory now if no operation can be using it
+    if ( ( ! enabled ) && ( operationInProgress_ == NULL )
+            && ( operationRequested_ == NULL ) )
+        searchIndex_.reset( 0 );
+}
+
+void LogFilteredDataWorkerThread::buildSearchIndex()
+{
+    QMutexLocker locker( &mutex_ );
+
+    if ( searchIndexEnabled_ && ( operationInProgress_ == NULL )
+            && ( operationRequested_ == NULL ) ) {
+        LOG(logDEBUG) << "Search index build requested";
+
+        operationRequested_ =
+            new IndexBuildOperation( sourceLogData_, &searchIndex_ );
+        operationRequestedCond_.wakeAll();
     }
 }
 
 // This will do an atomic copy of the object
 // (hopefully fast as we use Qt containers)
 void LogFilteredDataWorkerThread::getSearchResult(
-        int* maxLength, SearchResultArray* searchMatches, qint64* nbLinesProcessed )
+        int* maxLength, SearchResultArray* searchMatches, qint64* nbLinesProcessed,
+        qint64* nbMatches, MatchHistogram* histogram )
+{
+    searchData_.getAll( maxLength, searchMatches, nbLinesProcessed,
+            nbMatches, histogram );
+}
+
+void LogFilteredDataWorkerThread::getSlowLines(
+        QList<qint64>* slowLines, bool* budgetExhausted )
 {
-    searchData_.getAll( maxLength, searchMatches, nbLinesProcessed );
+    searchData_.getSlowLines( slowLines, budgetExhausted );
 }
 
 // This is the thread's main loop
@@ -183,20 +367,27 @@ void LogFilteredDataWorkerThread::run()
         if ( terminate_ )
             return;      // We must die
 
-        if ( operationRequested_ ) {
-            connect( operationRequested_, SIGNAL( searchProgressed( int, int ) ),
-                    this, SIGNAL( searchProgressed( int, int ) ) );
+        // Take the operation, the mutex is released while it runs
+        // so new requests can be queued without blocking the caller.
+        operationInProgress_ = operationRequested_;
+        operationRequested_  = NULL;
 
-            // Run the search operation
-            operationRequested_->start( searchData_ );
+        connect( operationInProgress_, SIGNAL( searchProgressed( int, int, int ) ),
+                this, SIGNAL( searchProgressed( int, int, int ) ) );
 
-            LOG(logDEBUG) << "... finished copy in workerThread.";
+        locker.unlock();
 
-            emit searchFinished();
-            delete operationRequested_;
-            operationRequested_ = NULL;
-            nothingToDoCond_.wakeAll();
-        }
+        // Run the search operation
+        operationInProgress_->start( searchData_ );
+
+        LOG(logDEBUG) << "... finished copy in workerThread.";
+
+        locker.relock();
+
+        delete operationInProgress_;
+        operationInProgress_ = NULL;
+
+        emit searchFinished();
     }
 }
 
@@ -205,50 +396,198 @@ void LogFilteredDataWorkerThread::run()
 //
 
 SearchOperation::SearchOperation( const LogData* sourceLogData,
-        const QRegExp& regExp, bool* interruptRequest )
-    : regexp_( regExp ), sourceLogData_( sourceLogData )
+        const QRegExp& regExp, int generation, TrigramIndex* index )
+    : interruptRequested_(), regexp_( regExp ),
+#if QT_VERSION >= 0x050000
+    limitedRegexp_(),
+#endif
+    sourceLogData_( sourceLogData ), generation_( generation ),
+    index_( index ), budget_()
+{
+    mode_                = SearchAllMatches;
+    maxMatches_          = 0;
+    direction_           = SearchForward;
+    backtrackingLimited_ = false;
+    nbLinesToSearch_     = 0;
+    nbLinesSearched_     = 0;
+
+    // Queued or running
+    PerfCounters::addToGauge( PerfCounters::SearchQueue, 1 );
+}
+
+SearchOperation::~SearchOperation()
 {
-    interruptRequested_ = interruptRequest;
+    PerfCounters::addToGauge( PerfCounters::SearchQueue, -1 );
 }
 
-void SearchOperation::doSearch( SearchData& searchData, qint64 initialLine )
+void SearchOperation::setBacktrackingLimited( bool limited )
+{
+#if QT_VERSION >= 0x050000
+    backtrackingLimited_ = limited
+        && RegExpBudget::limitedRegExp( regexp_, &limitedRegexp_ );
+#else
+    if ( limited )
+        LOG(logWARNING) << "The backtracking cannot be limited with Qt4";
+#endif
+}
+
+void SearchOperation::checkIndex()
+{
+    const int sourceGeneration = sourceLogData_->getIndexGeneration();
+
+    if ( index_ && index_->sourceGeneration() != sourceGeneration ) {
+        LOG(logDEBUG) << "File reindexed, resetting the search index";
+        index_->reset( sourceGeneration );
+    }
+}
+
+void SearchOperation::reportSlowLines( SearchData& searchData ) const
+{
+    if ( ! budget_.slowLines().isEmpty() )
+        searchData.addSlowLines( budget_.slowLines(), budget_.isExhausted() );
+}
+
+bool SearchOperation::isLineMatching( const QString& line )
+{
+#if QT_VERSION >= 0x050000
+    if ( backtrackingLimited_ )
+        return limitedRegexp_.match( line ).hasMatch();
+#endif
+
+    return ( regexp_.indexIn( line ) != -1 );
+}
+
+// The chunks are aligned on multiples of nbLinesInChunk, which are the
+// blocks of the index.
+// When only counting, the matching lines are neither stored nor measured
+// (which means reading them again), when the number of matches is limited
+// the search stops on the last one.
+bool SearchOperation::doSearch( SearchData& searchData,
+        qint64 beginLine, qint64 endLine, bool fromStart )
 {
     const qint64 nbSourceLines = sourceLogData_->getNbLine();
+    const TrigramIndex::Query query( regexp_ );
+    const bool countOnly = ( mode_ == SearchCountOnly );
+    const qint64 maxMatches = ( mode_ == SearchFirstMatches && maxMatches_ > 0 ) ?
+        maxMatches_ : -1;
     int maxLength = 0;
-    int nbMatches = searchData.getNbMatches();
     SearchResultArray currentList = SearchResultArray();
+    // The histogram is built as we go, no need for another pass
+    MatchHistogram histogram;
+
+    checkIndex();
+
+    qint64 i = beginLine;
+    while ( i < endLine ) {
+        if ( interruptRequested_ )
+            return false;
 
-    for ( qint64 i = initialLine; i < nbSourceLines; i += nbLinesInChunk ) {
-        if ( *interruptRequested_ )
+        const qint64 nbMatches = searchData.getNbMatches();
+        if ( maxMatches >= 0 && nbMatches >= maxMatches ) {
+            LOG(logDEBUG) << "Limit of " << maxMatches << " matches reached";
             break;
+        }
 
-        const int percentage = ( i - initialLine ) * 100 / ( nbSourceLines - initialLine );
-        emit searchProgressed( nbMatches, percentage );
-
-        const QStringList lines = sourceLogData_->getLines( i,
-                qMin( nbLinesInChunk, (int) ( nbSourceLines - i ) ) );
-        LOG(logDEBUG) << "Chunk starting at " << i <<
-            ", " << lines.size() << " lines read.";
-
-        int j = 0;
-        for ( ; j < lines.size(); j++ ) {
-            if ( regexp_.indexIn( lines[j] ) != -1 ) {
-                const int length = sourceLogData_->getExpandedLineString(i+j).length();
-                if ( length > maxLength )
-                    maxLength = length;
-                MatchingLine match( i+j );
-                currentList.append( match );
-                nbMatches++;
+        const int percentage = ( nbLinesToSearch_ > 0 ) ?
+            nbLinesSearched_ * 100 / nbLinesToSearch_ : 0;
+        emit searchProgressed( nbMatches, percentage, generation_ );
+
+        QElapsedTimer chunkTimer;
+        chunkTimer.start();
+        TraceScope trace( "searchChunk" );
+
+        qint64 chunkEnd = qMin(
+                ( i / nbLinesInChunk + 1 ) * nbLinesInChunk, endLine );
+        const int block = i / nbLinesInChunk;
+        // The last line of the file can still change (if not LF-terminated)
+        // so its block is never indexed.
+        const bool wholeBlock = ( ( chunkEnd - i ) == nbLinesInChunk )
+            && ( chunkEnd < nbSourceLines );
+        qint64 nbCounted = 0;
+        qint64 lastCounted = -1;
+
+        if ( wholeBlock && index_ && ! query.isEmpty()
+                && ! index_->mayMatch( block, query ) ) {
+            LOG(logDEBUG) << "Chunk starting at " << i << " skipped (index)";
+        }
+        else {
+            const QStringList lines = sourceLogData_->getLines( i, (int) ( chunkEnd - i ) );
+            LOG(logDEBUG) << "Chunk starting at " << i <<
+                ", " << lines.size() << " lines read.";
+
+            if ( wholeBlock && index_ && ! index_->isIndexed( block ) )
+                index_->indexBlock( block, lines );
+
+            // The interruption is checked on every line as they can be
+            // slow to match (the time spent on each is measured).
+            budget_.startLine();
+            for ( int j = 0; j < lines.size(); j++ ) {
+                if ( interruptRequested_ )
+                    return false;
+
+                const bool matching = isLineMatching( lines[j] );
+
+                if ( ! budget_.lineDone( i+j ) ) {
+                    LOG(logWARNING) << "Regexp budget exhausted, search stopped";
+                    return false;
+                }
+
+                if ( matching ) {
+                    histogram.add( i+j );
+
+                    if ( countOnly ) {
+                        nbCounted++;
+                        lastCounted = i+j;
+                        continue;
+                    }
+
+                    const int length = sourceLogData_->getExpandedLineString(i+j).length();
+                    if ( length > maxLength )
+                        maxLength = length;
+                    MatchingLine match( i+j );
+                    currentList.append( match );
+                    // Reading the line is not matching it
+                    budget_.startLine();
+
+                    // (a limited outward search goes forward)
+                    if ( maxMatches >= 0 && direction_ != SearchBackward
+                            && nbMatches + currentList.size() >= maxMatches ) {
+                        // Stop on this line
+                        chunkEnd = i + j + 1;
+                        break;
+                    }
+                }
+            }
+        }
+        nbLinesSearched_ += chunkEnd - i;
+
+        PerfCounters::record( PerfCounters::SearchChunkTime,
+                chunkTimer.nsecsElapsed() / 1000 );
+        PerfCounters::add( PerfCounters::LinesSearched, chunkEnd - i );
+        PerfCounters::add( PerfCounters::MatchesFound,
+                nbCounted + currentList.size() );
+
+        // Going backward, the matches to keep are the last ones of the chunk
+        if ( maxMatches >= 0 && direction_ == SearchBackward ) {
+            while ( nbMatches + currentList.size() > maxMatches ) {
+                histogram.remove( currentList.first().lineNumber() );
+                currentList.removeFirst();
             }
         }
 
         // After each block, copy the data to shared data
         // and update the client
-        searchData.addAll( maxLength, currentList, i+j );
+        if ( nbCounted > 0 )
+            searchData.addCount( nbCounted, lastCounted );
+        searchData.addAll( maxLength, currentList, fromStart ? chunkEnd : 0,
+                histogram );
         currentList.clear();
+        histogram.clear();
+
+        i = chunkEnd;
     }
 
-    emit searchProgressed( nbMatches, 100 );
+    return true;
 }
 
 // Called in the worker thread's context
@@ -257,13 +596,86 @@ void FullSearchOperation::start( SearchData& searchData )
     // Clear the shared data
     searchData.clear();
 
-    doSearch( searchData, 0 );
+    const qint64 nbSourceLines = sourceLogData_->getNbLine();
+    const qint64 lastLine = ( rangeEnd_ < 0 ) ?
+        nbSourceLines : qMin( rangeEnd_, nbSourceLines );
+    const qint64 firstLine = qBound( 0LL, rangeBegin_, lastLine );
+    // The first matches are the first ones in the file whatever the order
+    const SearchDirection direction =
+        ( mode_ == SearchFirstMatches && direction_ == SearchOutward ) ?
+        SearchForward : direction_;
+    // Start at the beginning of a chunk to make the most of the index
+    const qint64 startLine =
+        ( mode_ == SearchFirstMatches && direction == SearchForward ) ? firstLine :
+        qMax( firstLine,
+            qBound( 0LL, startLine_, lastLine ) / nbLinesInChunk * nbLinesInChunk );
+
+    nbLinesToSearch_ = lastLine - firstLine;
+    nbLinesSearched_ = 0;
+
+    bool finished = true;
+
+    if ( direction == SearchBackward ) {
+        // Search the chunks from the last one to the first one
+        qint64 chunkEnd = lastLine;
+        while ( finished && chunkEnd > firstLine ) {
+            const qint64 chunkBegin = qMax( firstLine,
+                    ( chunkEnd - 1 ) / nbLinesInChunk * nbLinesInChunk );
+            finished = doSearch( searchData, chunkBegin, chunkEnd,
+                    ( chunkBegin == firstLine ) );
+            chunkEnd = chunkBegin;
+        }
+    }
+    else if ( direction == SearchOutward ) {
+        // Chunks [startLine, below[ and [above, startLine[ are done,
+        // the view is updated as the gaps on both sides are filled.
+        qint64 below = startLine;
+        qint64 above = startLine;
+        bool goDown  = true;
+        while ( finished && ( below < lastLine || above > firstLine ) ) {
+            if ( ( goDown && below < lastLine ) || above <= firstLine ) {
+                const qint64 chunkEnd = qMin(
+                        ( below / nbLinesInChunk + 1 ) * nbLinesInChunk, lastLine );
+                finished = doSearch( searchData, below, chunkEnd,
+                        ( above <= firstLine ) );
+                below = chunkEnd;
+            }
+            else {
+                const qint64 chunkBegin = qMax( firstLine,
+                        ( above - 1 ) / nbLinesInChunk * nbLinesInChunk );
+                finished = doSearch( searchData, chunkBegin, above,
+                        ( chunkBegin == firstLine ) );
+                above = chunkBegin;
+            }
+            goDown = ! goDown;
+        }
+    }
+    else {
+        // Search from the start line (usually where the user is looking)
+        // to the end, then wrap around to the beginning of the range.
+        // (the lines before the range count as processed)
+        finished = doSearch( searchData, startLine, lastLine,
+                    ( startLine == firstLine ) )
+            && doSearch( searchData, firstLine, startLine, true );
+    }
+
+    if ( finished ) {
+        // The whole file is now searched
+        searchData.addAll( 0, SearchResultArray(), nbSourceLines );
+    }
+
+    reportSlowLines( searchData );
+
+    emit searchProgressed( searchData.getNbMatches(), 100, generation_ );
 }
 
 // Called in the worker thread's context
 void UpdateSearchOperation::start( SearchData& searchData )
 {
-    qint64 initial_line = initialPosition_;
+    // The search may have progressed since the update was requested
+    // (it was then still running, maybe out of order)
+    qint64 initial_line =
+        qMax( initialPosition_, searchData.getNbLinesProcessed() );
 
     if ( initial_line >= 1 ) {
         // We need to re-search the last line because it might have
@@ -273,5 +685,41 @@ void UpdateSearchOperation::start( SearchData& searchData )
         searchData.deleteMatch( initial_line );
     }
 
-    doSearch( searchData, initial_line );
+    const qint64 nbSourceLines = sourceLogData_->getNbLine();
+    const qint64 lastLine = ( rangeEnd_ < 0 ) ?
+        nbSourceLines : qMin( rangeEnd_, nbSourceLines );
+    initial_line = qMax( initial_line, rangeBegin_ );
+
+    nbLinesToSearch_ = qMax( lastLine - initial_line, 0LL );
+    nbLinesSearched_ = 0;
+
+    if ( doSearch( searchData, initial_line, lastLine, true ) ) {
+        // The new lines past the range don't need searching
+        searchData.addAll( 0, SearchResultArray(), nbSourceLines );
+    }
+
+    reportSlowLines( searchData );
+
+    emit searchProgressed( searchData.getNbMatches(), 100, generation_ );
+}
+
+// Called in the worker thread's context
+void IndexBuildOperation::start( SearchData& )
+{
+    checkIndex();
+
+    const qint64 nbSourceLines = sourceLogData_->getNbLine();
+
+    // Same blocks as doSearch() (the one with the last line is not indexed)
+    for ( qint64 i = 0; i + nbLinesInChunk < nbSourceLines; i += nbLinesInChunk ) {
+        if ( interruptRequested_ )
+            break;
+
+        const int block = i / nbLinesInChunk;
+        if ( ! index_->isIndexed( block ) )
+            index_->indexBlock( block,
+                    sourceLogData_->getLines( i, nbLinesInChunk ) );
+    }
+
+    LOG(logDEBUG) << "IndexBuildOperation finished";
 }
@@ -27,40 +27,91 @@
 #include <QRegExp>
 #include <QList>
 
+#include "atomicflag.h"
+#include "trigramindex.h"
+#include "matchhistogram.h"
+#include "regexpbudget.h"
+
 class LogData;
 
 // Class encapsulating a single matching line
 // Contains the line number the line was found in and its content.
 class MatchingLine {
   public:
-    MatchingLine( int line ) { lineNumber_ = line; };
+    MatchingLine( qint64 line ) { lineNumber_ = line; };
 
     // Accessors
-    int lineNumber() const { return lineNumber_; }
+    qint64 lineNumber() const { return lineNumber_; }
+
+    // Matches are ordered by line number
+    bool operator<( const MatchingLine& other ) const
+    { return lineNumber_ < other.lineNumber_; }
 
   private:
-    int lineNumber_;
+    qint64 lineNumber_;
 };
 
 typedef QList<MatchingLine> SearchResultArray;
 
+// What a search keeps of the lines matching.
+enum SearchMode {
+    // Every matching line (the default)
+    SearchAllMatches,
+    // Only the number of matches and their histogram, the lines are
+    // neither stored nor measured.
+    SearchCountOnly,
+    // The first matching lines (in file order) up to a maximum,
+    // the search stops there.
+    SearchFirstMatches,
+};
+
+// Order in which a search goes through the file.
+enum SearchDirection {
+    // From the start line to the end, then wrapping around
+    SearchForward,
+    // From the end to the beginning, the newest lines first
+    // (a limited search then keeps the last matches).
+    SearchBackward,
+    // From the chunk of the start line, alternately the next chunk
+    // below and above it, moving away until the whole range is done
+    // (a limited search goes forward instead).
+    SearchOutward,
+};
+
 // This class is a mutex protected set of search result data.
 // It is thread safe.
 class SearchData
 {
   public:
-    SearchData() : dataMutex_(), matches_(), maxLength_(0) { }
+    SearchData() : dataMutex_(), matches_(), maxLength_(0),
+        nbLinesProcessed_(0), nbMatchesCounted_(0), lastMatchCounted_(-1),
+        histogram_(), slowLines_(), budgetExhausted_(false) { }
 
     // Atomically get all the search data
     void getAll( int* length, SearchResultArray* matches,
-            qint64* nbLinesProcessed ) const;
+            qint64* nbLinesProcessed, qint64* nbMatches,
+            MatchHistogram* histogram ) const;
     // Atomically set all the search data
     // (overwriting the existing)
     void setAll( int length, const SearchResultArray& matches );
     // Atomically add to all the existing search data.
-    void addAll( int length, const SearchResultArray& matches, qint64 nbLinesProcessed );
-    // Get the number of matches
-    int getNbMatches() const;
+    // The matches are inserted so that the list stays sorted, the number
+    // of lines processed (from the start of the file) never decreases.
+    // The histogram of the matches passed is merged with the existing one.
+    void addAll( int length, const SearchResultArray& matches, qint64 nbLinesProcessed,
+            const MatchHistogram& histogram = MatchHistogram() );
+    // Add matches which are counted but not stored (count only search),
+    // lastMatch being the line of the last of them.
+    void addCount( qint64 nbMatches, qint64 lastMatch );
+    // Get the number of matches (stored or only counted)
+    qint64 getNbMatches() const;
+    // Get the number of lines processed from the start of the file
+    qint64 getNbLinesProcessed() const;
+    // Record the lines the regexp has been slow to match and whether
+    // the search has been abandoned because of them.
+    void addSlowLines( const QList<qint64>& lines, bool budgetExhausted );
+    // Atomically get the slow lines (in the order found)
+    void getSlowLines( QList<qint64>* lines, bool* budgetExhausted ) const;
     // Delete the match for the passed line (if it exist)
     void deleteMatch( qint64 line );
     // Atomically clear the data.
@@ -72,56 +123,136 @@ class SearchData
     SearchResultArray matches_;
     int maxLength_;
     qint64 nbLinesProcessed_;
+    qint64 nbMatchesCounted_;
+    qint64 lastMatchCounted_;
+    MatchHistogram histogram_;
+    QList<qint64> slowLines_;
+    bool budgetExhausted_;
 };
 
 class SearchOperation : public QObject
 {
   Q_OBJECT
   public:
+    // The index passed (not owned) is used to skip the blocks of lines
+    // that cannot match and completed with the blocks searched,
+    // it can be NULL.
     SearchOperation( const LogData* sourceLogData,
-            const QRegExp& regExp, bool* interruptRequest );
+            const QRegExp& regExp, int generation, TrigramIndex* index );
 
-    virtual ~SearchOperation() { }
+    virtual ~SearchOperation();
 
     // Start the search operation, returns true if it has been done
     // and false if it has been cancelled (results not copied)
     virtual void start( SearchData& result ) = 0;
 
+    // Request the operation to stop as soon as possible, returns
+    // immediately (can be called from any thread).
+    void interrupt() { interruptRequested_.set(); }
+
+    // Returns the generation of the search this operation belongs to
+    int generation() const { return generation_; }
+
+    // Set what is kept of the matches (before starting),
+    // maxMatches is only used by SearchFirstMatches.
+    void setSearchMode( SearchMode mode, int maxMatches )
+    { mode_ = mode; maxMatches_ = maxMatches; }
+    // Set the order the chunks are searched (before starting)
+    void setSearchDirection( SearchDirection direction )
+    { direction_ = direction; }
+    // Match the lines with a limited backtracking (before starting), see
+    // RegExpBudget::limitedRegExp, the regexp is used as is if it cannot
+    // be limited (or with Qt4).
+    void setBacktrackingLimited( bool limited );
+
   signals:
-    void searchProgressed( int percent, int nbMatches );
+    void searchProgressed( int nbMatches, int percent, int generation );
 
   protected:
     static const int nbLinesInChunk;
 
-    // Implement the common part of the search, passing
-    // the shared results and the line to begin the search from.
-    void doSearch( SearchData& result, qint64 initialLine );
-
-    bool* interruptRequested_;
+    // Implement the common part of the search, passing the shared results
+    // and the range of lines [beginLine, endLine[ to search.
+    // fromStart tells whether everything before beginLine has already
+    // been searched, in which case the number of lines processed is
+    // updated as we go.
+    // Returns false if the search has been interrupted (or has exhausted
+    // its regexp budget).
+    bool doSearch( SearchData& result, qint64 beginLine, qint64 endLine,
+            bool fromStart );
+
+    // Throw away the index if the file has been reindexed since it was built
+    void checkIndex();
+    // Pass the slow lines found to the shared results
+    void reportSlowLines( SearchData& result ) const;
+    // Returns whether the line matches the regexp
+    bool isLineMatching( const QString& line );
+
+    AtomicFlag interruptRequested_;
     const QRegExp regexp_;
+#if QT_VERSION >= 0x050000
+    // Used instead of regexp_ when the backtracking is limited
+    QRegularExpression limitedRegexp_;
+#endif
+    bool backtrackingLimited_;
     const LogData* sourceLogData_;
+    const int generation_;
+    TrigramIndex* index_;
+    SearchMode mode_;
+    int maxMatches_;
+    SearchDirection direction_;
+    // Time spent matching the lines
+    RegExpBudget budget_;
+
+    // Used for the progress reporting
+    qint64 nbLinesToSearch_;
+    qint64 nbLinesSearched_;
 };
 
+// The full and update searches only look at the lines in
+// [rangeBegin, rangeEnd[, rangeEnd being -1 for the end of the file.
 class FullSearchOperation : public SearchOperation
 {
   public:
     FullSearchOperation( const LogData* sourceLogData, const QRegExp& regExp,
-            bool* interruptRequest )
-        : SearchOperation( sourceLogData, regExp, interruptRequest ) {}
+            int generation, TrigramIndex* index, qint64 startLine,
+            qint64 rangeBegin, qint64 rangeEnd )
+        : SearchOperation( sourceLogData, regExp, generation, index ),
+        startLine_( startLine ), rangeBegin_( rangeBegin ),
+        rangeEnd_( rangeEnd ) {}
     virtual void start( SearchData& result );
+
+  private:
+    qint64 startLine_;
+    qint64 rangeBegin_;
+    qint64 rangeEnd_;
 };
 
 class UpdateSearchOperation : public SearchOperation
 {
   public:
     UpdateSearchOperation( const LogData* sourceLogData, const QRegExp& regExp,
-            bool* interruptRequest, qint64 position )
-        : SearchOperation( sourceLogData, regExp, interruptRequest ),
-        initialPosition_( position ) {}
+            int generation, TrigramIndex* index, qint64 position,
+            qint64 rangeBegin, qint64 rangeEnd )
+        : SearchOperation( sourceLogData, regExp, generation, index ),
+        initialPosition_( position ), rangeBegin_( rangeBegin ),
+        rangeEnd_( rangeEnd ) {}
     virtual void start( SearchData& result );
 
   private:
     qint64 initialPosition_;
+    qint64 rangeBegin_;
+    qint64 rangeEnd_;
+};
+
+// Completes the trigram index without searching anything
+// (the results are left untouched and no progress is sent).
+class IndexBuildOperation : public SearchOperation
+{
+  public:
+    IndexBuildOperation( const LogData* sourceLogData, TrigramIndex* index )
+        : SearchOperation( sourceLogData, QRegExp(), 0, index ) {}
+    virtual void start( SearchData& result );
 };
 
 // Create and manage the thread doing loading/indexing for
@@ -137,22 +268,58 @@ class LogFilteredDataWorkerThread : public QThread
     LogFilteredDataWorkerThread( const LogData* sourceLogData );
     ~LogFilteredDataWorkerThread();
 
-    // Start the search with the passed regexp
-    void search( const QRegExp& regExp );
+    // Start the search with the passed regexp, superseding the search
+    // in progress (interrupted) and any pending one (dropped).
+    // The search begins at startLine and goes through the file in the
+    // direction set (see SearchDirection), so that results near startLine
+    // (or at the end of the file) are available first.
+    // Returns immediately with the generation of the new search, which
+    // tags every searchProgressed signal it sends.
+    int search( const QRegExp& regExp, qint64 startLine = 0 );
     // Continue the previous search starting at the passed position
-    // in the source file (line number)
-    void updateSearch( const QRegExp& regExp, qint64 position );
-    // Interrupts the search if one is in progress
+    // in the source file (line number), once the operation in progress
+    // is finished.  Returns immediately with the generation the update
+    // belongs to.
+    int updateSearch( const QRegExp& regExp, qint64 position );
+    // Interrupts the search if one is in progress and drop any pending one,
+    // returns immediately.
     void interrupt();
+    // Restricts the next searches (and updates) to the lines in
+    // [beginLine, endLine[, endLine being -1 for the end of the file
+    // (which then includes the lines added later).
+    void setSearchRange( qint64 beginLine, qint64 endLine );
+    // Set what the next searches (and updates) keep of the matches,
+    // maxMatches being the limit of SearchFirstMatches.
+    void setSearchMode( SearchMode mode, int maxMatches );
+    // Set the order in which the next searches go through the file
+    // (the updates always search the new lines forward).
+    void setSearchDirection( SearchDirection direction );
+    // Set whether the next searches (and updates) match the lines with
+    // a limited backtracking (see RegExpBudget::limitedRegExp).
+    void setBacktrackingLimited( bool limited );
+
+    // Enable/disable the use of a trigram index of the file to skip the
+    // parts which cannot match a search.  The index is built by the
+    // searches as they go (and by buildSearchIndex()), it is kept in memory.
+    void setSearchIndexEnabled( bool enabled );
+    // Build the index of the parts of the file not indexed yet, in the
+    // background, if the thread has nothing else to do.
+    // Any search request interrupts it.
+    void buildSearchIndex();
 
     // Returns a copy of the current indexing data
     void getSearchResult( int* maxLength, SearchResultArray* searchMatches,
-           qint64* nbLinesProcessed );
+           qint64* nbLinesProcessed, qint64* nbMatches,
+           MatchHistogram* histogram );
+    // Returns the lines the regexp has been too slow to match and whether
+    // the search has been abandoned because of them.
+    void getSlowLines( QList<qint64>* slowLines, bool* budgetExhausted );
 
   signals:
-    // Sent during the indexing process to signal progress
-    // percent being the percentage of completion.
-    void searchProgressed( int percent, int nbMatches );
+    // Sent during the search process to signal progress
+    // percent being the percentage of completion, generation
+    // identifying the search sending it.
+    void searchProgressed( int nbMatches, int percent, int generation );
     // Sent when indexing is finished, signals the client
     // to copy the new data back.
     void searchFinished();
@@ -166,12 +333,27 @@ class LogFilteredDataWorkerThread : public QThread
     // Mutex to protect operationRequested_ and friends
     QMutex mutex_;
     QWaitCondition operationRequestedCond_;
-    QWaitCondition nothingToDoCond_;
 
     // Set when the thread must die
     bool terminate_;
-    bool interruptRequested_;
+    // Next operation to run (owned)
     SearchOperation* operationRequested_;
+    // Operation being run by the thread (owned)
+    SearchOperation* operationInProgress_;
+    // Generation of the latest search requested
+    int generation_;
+    // Range of lines searched
+    qint64 rangeBegin_;
+    qint64 rangeEnd_;
+    // What the searches keep
+    SearchMode searchMode_;
+    int maxMatches_;
+    SearchDirection searchDirection_;
+    bool backtrackingLimited_;
+
+    // Index used by the operations (only touched by the running one)
+    TrigramIndex searchIndex_;
+    bool searchIndexEnabled_;
 
     // Shared indexing data
     SearchData searchData_;
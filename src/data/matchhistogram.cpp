@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements the MatchHistogram class.
+
+#include "matchhistogram.h"
+
+const int MatchHistogram::maxBuckets = 512;
+
+MatchHistogram::MatchHistogram() : counts_()
+{
+    linesPerBucket_ = 1;
+    firstBucket_    = 0;
+}
+
+void MatchHistogram::add( qint64 line, int count )
+{
+    qint64 bucket = line / linesPerBucket_;
+
+    if ( counts_.isEmpty() ) {
+        firstBucket_ = bucket;
+        counts_.append( count );
+        return;
+    }
+
+    // Make sure the new bucket fits in the range we can keep
+    while ( qMax( bucket, firstBucket_ + counts_.size() - 1 )
+            - qMin( bucket, firstBucket_ ) + 1 > maxBuckets ) {
+        coarsen();
+        bucket = line / linesPerBucket_;
+    }
+
+    if ( bucket < firstBucket_ ) {
+        counts_.insert( 0, firstBucket_ - bucket, 0 );
+        firstBucket_ = bucket;
+    }
+    else if ( bucket >= firstBucket_ + counts_.size() ) {
+        counts_.resize( bucket - firstBucket_ + 1 );
+    }
+
+    counts_[ bucket - firstBucket_ ] += count;
+}
+
+void MatchHistogram::remove( qint64 line )
+{
+    const qint64 bucket = line / linesPerBucket_ - firstBucket_;
+
+    if ( bucket >= 0 && bucket < counts_.size() && counts_[bucket] > 0 )
+        counts_[bucket]--;
+}
+
+void MatchHistogram::merge( const MatchHistogram& other )
+{
+    if ( other.isEmpty() )
+        return;
+
+    // Bring both to the same resolution
+    MatchHistogram source = other;
+    while ( source.linesPerBucket_ < linesPerBucket_ )
+        source.coarsen();
+    while ( linesPerBucket_ < source.linesPerBucket_ )
+        coarsen();
+
+    for ( int i = 0; i < source.counts_.size(); i++ ) {
+        if ( source.counts_[i] > 0 )
+            add( ( source.firstBucket_ + i ) * source.linesPerBucket_,
+                    source.counts_[i] );
+    }
+}
+
+void MatchHistogram::clear()
+{
+    counts_.clear();
+    linesPerBucket_ = 1;
+    firstBucket_    = 0;
+}
+
+int MatchHistogram::maxCount() const
+{
+    int max = 0;
+
+    foreach ( int count, counts_ )
+        max = qMax( max, count );
+
+    return max;
+}
+
+void MatchHistogram::coarsen()
+{
+    const qint64 newFirstBucket = firstBucket_ / 2;
+
+    if ( ! counts_.isEmpty() ) {
+        const qint64 lastBucket = firstBucket_ + counts_.size() - 1;
+        QVector<int> counts( lastBucket / 2 - newFirstBucket + 1, 0 );
+
+        for ( int i = 0; i < counts_.size(); i++ )
+            counts[ ( firstBucket_ + i ) / 2 - newFirstBucket ] += counts_[i];
+
+        counts_ = counts;
+    }
+
+    firstBucket_    = newFirstBucket;
+    linesPerBucket_ *= 2;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MATCHHISTOGRAM_H
+#define MATCHHISTOGRAM_H
+
+#include <QVector>
+
+// Number of matches per bucket of consecutive lines, built by the search
+// as it goes.
+// The number of lines in a bucket is a power of two which doubles
+// (merging the buckets two by two) when needed to keep at most maxBuckets,
+// so two histograms built on different parts of the file (or with a
+// different resolution) can always be merged exactly.
+// This class is not thread-safe.
+class MatchHistogram
+{
+  public:
+    // Maximum number of buckets kept
+    static const int maxBuckets;
+
+    MatchHistogram();
+
+    // Count a match at the passed line
+    void add( qint64 line, int count = 1 );
+    // Uncount a match at the passed line (previously added)
+    void remove( qint64 line );
+    // Adds the counts of the other histogram to this one
+    void merge( const MatchHistogram& other );
+    // Removes all the buckets and resets the resolution
+    void clear();
+
+    bool isEmpty() const { return counts_.isEmpty(); }
+    // Number of lines per bucket
+    qint64 linesPerBucket() const { return linesPerBucket_; }
+    // First line of the first bucket
+    qint64 firstLine() const { return firstBucket_ * linesPerBucket_; }
+    // Number of buckets (from firstLine())
+    int nbBuckets() const { return counts_.size(); }
+    // Number of matches in the passed bucket
+    int count( int bucket ) const { return counts_[bucket]; }
+    // Highest number of matches in a bucket
+    int maxCount() const;
+
+  private:
+    // Halves the resolution
+    void coarsen();
+
+    qint64 linesPerBucket_;
+    // Number (from the start of the file) of the first bucket stored
+    qint64 firstBucket_;
+    QVector<int> counts_;
+};
+
+#endif
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements the PerfCounters and LatencyHistogram classes.
+
+#include <QStringList>
+
+#include "perfcounters.h"
+
+std::atomic<qint64> PerfCounters::counters_[PerfCounters::NbCounters];
+std::atomic<qint64> PerfCounters::gauges_[PerfCounters::NbGauges];
+std::atomic<qint64> PerfCounters::gaugeMax_[PerfCounters::NbGauges];
+LatencyHistogram PerfCounters::latencies_[PerfCounters::NbLatencies];
+
+namespace {
+    // Raise the atomic to the passed value if it is lower
+    void storeMax( std::atomic<qint64>& atomic, qint64 value )
+    {
+        qint64 current = atomic.load( std::memory_order_relaxed );
+        while ( value > current
+                && ! atomic.compare_exchange_weak( current, value,
+                    std::memory_order_relaxed ) ) {}
+    }
+
+    QString jsonObject( const QStringList& members )
+    {
+        return "{ " + members.join( ", " ) + " }";
+    }
+
+    QString jsonMember( const QString& name, const QString& value )
+    {
+        return "\"" + name + "\": " + value;
+    }
+
+    QString jsonMember( const QString& name, qint64 value )
+    {
+        return jsonMember( name, QString::number( value ) );
+    }
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::record( qint64 microseconds )
+{
+    int bucket = 0;
+    for ( qint64 d = microseconds; d > 0 && bucket < nbBuckets - 1; d >>= 1 )
+        bucket++;
+
+    buckets_[bucket].fetch_add( 1, std::memory_order_relaxed );
+    count_.fetch_add( 1, std::memory_order_relaxed );
+    total_.fetch_add( microseconds, std::memory_order_relaxed );
+    storeMax( max_, microseconds );
+}
+
+void LatencyHistogram::reset()
+{
+    for ( int i = 0; i < nbBuckets; i++ )
+        buckets_[i].store( 0, std::memory_order_relaxed );
+    count_.store( 0, std::memory_order_relaxed );
+    total_.store( 0, std::memory_order_relaxed );
+    max_.store( 0, std::memory_order_relaxed );
+}
+
+qint64 LatencyHistogram::percentile( int percent ) const
+{
+    qint64 total_count = 0;
+    for ( int i = 0; i < nbBuckets; i++ )
+        total_count += bucketCount( i );
+
+    if ( total_count == 0 )
+        return 0;
+
+    // Rank of the duration wanted (at least the first one)
+    const qint64 rank = qMax( 1LL, ( total_count * percent + 99 ) / 100 );
+
+    qint64 seen = 0;
+    for ( int i = 0; i < nbBuckets - 1; i++ ) {
+        seen += bucketCount( i );
+        if ( seen >= rank )
+            return bucketLimit( i );
+    }
+
+    return max();
+}
+
+void PerfCounters::addToGauge( Gauge gauge, qint64 delta )
+{
+    const qint64 level =
+        gauges_[gauge].fetch_add( delta, std::memory_order_relaxed ) + delta;
+    storeMax( gaugeMax_[gauge], level );
+}
+
+QString PerfCounters::name( Counter counter )
+{
+    switch ( counter ) {
+        case LinesIndexed:      return "linesIndexed";
+        case BytesIndexed:      return "bytesIndexed";
+        case LinesSearched:     return "linesSearched";
+        case MatchesFound:      return "matchesFound";
+        case LinesRead:         return "linesRead";
+        case RenderCacheHits:   return "renderCacheHits";
+        case RenderCacheMisses: return "renderCacheMisses";
+        case NbCounters:        break;
+    }
+
+    return QString();
+}
+
+QString PerfCounters::name( Gauge gauge )
+{
+    switch ( gauge ) {
+        case IndexingQueue: return "indexingQueue";
+        case SearchQueue:   return "searchQueue";
+        case NbGauges:      break;
+    }
+
+    return QString();
+}
+
+QString PerfCounters::name( Latency latency )
+{
+    switch ( latency ) {
+        case PaintTime:       return "paint";
+        case LineReadTime:    return "lineRead";
+        case IndexingTime:    return "indexing";
+        case SearchChunkTime: return "searchChunk";
+        case FollowLatency:   return "follow";
+        case NbLatencies:     break;
+    }
+
+    return QString();
+}
+
+qint64 PerfCounters::throughput( Counter counter, Latency latency )
+{
+    const qint64 time = latencies_[latency].total();
+
+    return ( time > 0 ) ? value( counter ) * 1000000LL / time : 0;
+}
+
+void PerfCounters::reset()
+{
+    for ( int i = 0; i < NbCounters; i++ )
+        counters_[i].store( 0, std::memory_order_relaxed );
+    for ( int i = 0; i < NbGauges; i++ )
+        gaugeMax_[i].store( gauges_[i].load( std::memory_order_relaxed ),
+                std::memory_order_relaxed );
+    for ( int i = 0; i < NbLatencies; i++ )
+        latencies_[i].reset();
+}
+
+QString PerfCounters::toJson()
+{
+    QStringList counters;
+    for ( int i = 0; i < NbCounters; i++ )
+        counters << jsonMember( name( Counter( i ) ), value( Counter( i ) ) );
+
+    QStringList gauges;
+    for ( int i = 0; i < NbGauges; i++ ) {
+        QStringList gauge;
+        gauge << jsonMember( "level", level( Gauge( i ) ) )
+            << jsonMember( "max", maxLevel( Gauge( i ) ) );
+        gauges << jsonMember( name( Gauge( i ) ), jsonObject( gauge ) );
+    }
+
+    QStringList latencies;
+    for ( int i = 0; i < NbLatencies; i++ ) {
+        const LatencyHistogram& histogram = latency( Latency( i ) );
+
+        QStringList buckets;
+        for ( int j = 0; j < LatencyHistogram::nbBuckets; j++ )
+            buckets << QString::number( histogram.bucketCount( j ) );
+
+        QStringList members;
+        members << jsonMember( "count", histogram.count() )
+            << jsonMember( "totalUs", histogram.total() )
+            << jsonMember( "maxUs", histogram.max() )
+            << jsonMember( "p50Us", histogram.percentile( 50 ) )
+            << jsonMember( "p90Us", histogram.percentile( 90 ) )
+            << jsonMember( "p99Us", histogram.percentile( 99 ) )
+            << jsonMember( "buckets", "[ " + buckets.join( ", " ) + " ]" );
+        latencies << jsonMember( name( Latency( i ) ), jsonObject( members ) );
+    }
+
+    QStringList throughputs;
+    throughputs
+        << jsonMember( "indexingLinesPerSecond",
+                throughput( LinesIndexed, IndexingTime ) )
+        << jsonMember( "indexingBytesPerSecond",
+                throughput( BytesIndexed, IndexingTime ) )
+        << jsonMember( "searchLinesPerSecond",
+                throughput( LinesSearched, SearchChunkTime ) );
+
+    QStringList document;
+    document << jsonMember( "counters", jsonObject( counters ) )
+        << jsonMember( "gauges", jsonObject( gauges ) )
+        << jsonMember( "latencies", jsonObject( latencies ) )
+        << jsonMember( "throughput", jsonObject( throughputs ) );
+
+    return jsonObject( document ) + "\n";
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <atomic>
+
+#include <QString>
+#include <QElapsedTimer>
+
+// Distribution of durations, in buckets of powers of two microseconds.
+// Durations can be recorded from any thread without locking, the
+// statistics read while others are recorded are only approximately
+// consistent with each other.
+class LatencyHistogram
+{
+  public:
+    // Bucket i counts the durations in [2^(i-1), 2^i[ us (< 1 us for
+    // bucket 0), the last one counts everything longer.
+    static const int nbBuckets = 32;
+
+    LatencyHistogram();
+
+    // Count a duration
+    void record( qint64 microseconds );
+    // Forget all the durations
+    void reset();
+
+    // Number of durations recorded
+    qint64 count() const { return count_.load( std::memory_order_relaxed ); }
+    // Sum of the durations (us)
+    qint64 total() const { return total_.load( std::memory_order_relaxed ); }
+    // Longest duration (us)
+    qint64 max() const { return max_.load( std::memory_order_relaxed ); }
+    // Number of durations in the passed bucket
+    qint64 bucketCount( int bucket ) const
+    { return buckets_[bucket].load( std::memory_order_relaxed ); }
+    // Upper bound of the bucket containing the passed percentile
+    // (0 to 100) of the durations, 0 if none has been recorded.
+    qint64 percentile( int percent ) const;
+
+    // Upper bound (excluded) of the passed bucket (us)
+    static qint64 bucketLimit( int bucket ) { return 1LL << bucket; }
+
+  private:
+    // Non copyable
+    LatencyHistogram( const LatencyHistogram& );
+    LatencyHistogram& operator=( const LatencyHistogram& );
+
+    std::atomic<qint64> buckets_[nbBuckets];
+    std::atomic<qint64> count_;
+    std::atomic<qint64> total_;
+    std::atomic<qint64> max_;
+};
+
+// The performance counters of the application.
+// They are always collected (updating one is a relaxed atomic operation
+// on a static variable) and can be looked at in the diagnostics dialog
+// or saved in JSON, instead of timing the debug output.
+class PerfCounters
+{
+  public:
+    // Monotonic counters
+    enum Counter {
+        LinesIndexed,
+        BytesIndexed,
+        LinesSearched,
+        MatchesFound,
+        LinesRead,
+        RenderCacheHits,
+        RenderCacheMisses,
+        NbCounters
+    };
+    // Current levels (which also keep their maximum)
+    enum Gauge {
+        IndexingQueue,
+        SearchQueue,
+        NbGauges
+    };
+    // Distributions of durations
+    enum Latency {
+        PaintTime,
+        LineReadTime,
+        IndexingTime,
+        SearchChunkTime,
+        // From the notification of new data to the end of the repaint
+        // showing it in a view following the file
+        FollowLatency,
+        NbLatencies
+    };
+
+    static void add( Counter counter, qint64 value = 1 )
+    { counters_[counter].fetch_add( value, std::memory_order_relaxed ); }
+    // Move the level of the gauge by the passed amount
+    static void addToGauge( Gauge gauge, qint64 delta );
+    static void record( Latency latency, qint64 microseconds )
+    { latencies_[latency].record( microseconds ); }
+
+    static qint64 value( Counter counter )
+    { return counters_[counter].load( std::memory_order_relaxed ); }
+    static qint64 level( Gauge gauge )
+    { return gauges_[gauge].load( std::memory_order_relaxed ); }
+    static qint64 maxLevel( Gauge gauge )
+    { return gaugeMax_[gauge].load( std::memory_order_relaxed ); }
+    static const LatencyHistogram& latency( Latency latency )
+    { return latencies_[latency]; }
+
+    static QString name( Counter counter );
+    static QString name( Gauge gauge );
+    static QString name( Latency latency );
+
+    // Rate per second of the counter over the time of the latency
+    // (e.g. lines indexed per second of indexing), 0 if none recorded.
+    static qint64 throughput( Counter counter, Latency latency );
+
+    // Reset the counters, the latencies and the maximum of the gauges
+    // (the levels are left alone as they are still current).
+    static void reset();
+
+    // Returns all the values as a JSON document
+    static QString toJson();
+
+  private:
+    static std::atomic<qint64> counters_[NbCounters];
+    static std::atomic<qint64> gauges_[NbGauges];
+    static std::atomic<qint64> gaugeMax_[NbGauges];
+    static LatencyHistogram latencies_[NbLatencies];
+};
+
+// Records the time spent in its scope in one of the latency histograms
+class PerfTimer
+{
+  public:
+    explicit PerfTimer( PerfCounters::Latency latency )
+        : latency_( latency ), timer_() { timer_.start(); }
+    ~PerfTimer()
+    { PerfCounters::record( latency_, timer_.nsecsElapsed() / 1000 ); }
+
+  private:
+    PerfCounters::Latency latency_;
+    QElapsedTimer timer_;
+};
+
+#endif
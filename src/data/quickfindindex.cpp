@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements the QuickFindIndex class.
+
+#include <algorithm>
+
+#include "log.h"
+
+#include "quickfindindex.h"
+
+const int QuickFindIndex::maxMatches = 1000000;
+
+QuickFindIndex::QuickFindIndex() : mutex_(), regexp_(), matches_(),
+    histogram_()
+{
+    dataGeneration_ = -1;
+    abandoned_      = false;
+    nbLinesIndexed_ = 0;
+}
+
+void QuickFindIndex::reset( const QRegExp& regExp, int dataGeneration )
+{
+    QMutexLocker locker( &mutex_ );
+
+    regexp_         = regExp;
+    dataGeneration_ = dataGeneration;
+    abandoned_      = false;
+    nbLinesIndexed_ = 0;
+    matches_.clear();
+    histogram_.clear();
+}
+
+void QuickFindIndex::append( const QVector<Match>& matches, qint64 lines )
+{
+    QMutexLocker locker( &mutex_ );
+
+    foreach ( const Match& match, matches )
+        histogram_.add( match.line() );
+    nbLinesIndexed_ = lines;
+
+    if ( ( ! abandoned_ )
+            && ( matches_.size() + matches.size() > maxMatches ) ) {
+        LOG(logDEBUG) << "QuickFindIndex: too many matches, abandoning";
+        abandoned_ = true;
+        matches_ = QVector<Match>();
+    }
+
+    if ( ! abandoned_ )
+        matches_ += matches;
+}
+
+bool QuickFindIndex::isFor( const QRegExp& regExp, int dataGeneration ) const
+{
+    QMutexLocker locker( &mutex_ );
+
+    return ( dataGeneration_ == dataGeneration ) && ( regexp_ == regExp );
+}
+
+bool QuickFindIndex::isAbandoned() const
+{
+    QMutexLocker locker( &mutex_ );
+
+    return abandoned_;
+}
+
+qint64 QuickFindIndex::nbLinesIndexed() const
+{
+    QMutexLocker locker( &mutex_ );
+
+    return nbLinesIndexed_;
+}
+
+QuickFindIndex::Result QuickFindIndex::findNext(
+        const QRegExp& regExp, int dataGeneration, qint64 nbLines,
+        qint64 line, int column, Match* match ) const
+{
+    QMutexLocker locker( &mutex_ );
+
+    if ( abandoned_ || dataGeneration_ != dataGeneration
+            || ! ( regexp_ == regExp ) || line >= nbLinesIndexed_ )
+        return Unknown;
+
+    QVector<Match>::const_iterator i = std::lower_bound(
+            matches_.begin(), matches_.end(), Match( line, column, column ) );
+
+    if ( i != matches_.end() ) {
+        *match = *i;
+        return Found;
+    }
+    else {
+        // Nothing after, unless the end of the file is not indexed yet
+        return ( nbLinesIndexed_ >= nbLines ) ? NotFound : Unknown;
+    }
+}
+
+QuickFindIndex::Result QuickFindIndex::findPrevious(
+        const QRegExp& regExp, int dataGeneration,
+        qint64 line, int column, Match* match ) const
+{
+    QMutexLocker locker( &mutex_ );
+
+    if ( abandoned_ || dataGeneration_ != dataGeneration
+            || ! ( regexp_ == regExp ) || line >= nbLinesIndexed_ )
+        return Unknown;
+
+    // First match after the ones we can take
+    const Match limit = ( column > 0 ) ?
+        Match( line, column + 1, column + 1 ) : Match( line, 0, 0 );
+    QVector<Match>::const_iterator i = std::lower_bound(
+            matches_.begin(), matches_.end(), limit );
+
+    if ( i != matches_.begin() ) {
+        --i;
+        *match = *i;
+        return Found;
+    }
+    else {
+        // The index always starts at the beginning of the file
+        return NotFound;
+    }
+}
+
+bool QuickFindIndex::getHistogram( const QRegExp& regExp, int dataGeneration,
+        MatchHistogram* histogram ) const
+{
+    QMutexLocker locker( &mutex_ );
+
+    if ( dataGeneration_ != dataGeneration || ! ( regexp_ == regExp ) )
+        return false;
+
+    *histogram = histogram_;
+    return true;
+}
+
+qint64 QuickFindIndex::rankOf( const QRegExp& regExp, int dataGeneration,
+        qint64 nbLines, qint64 line, int column,
+        qint64* nbMatches, bool* complete ) const
+{
+    QMutexLocker locker( &mutex_ );
+
+    if ( abandoned_ || dataGeneration_ != dataGeneration
+            || ! ( regexp_ == regExp ) || line >= nbLinesIndexed_ )
+        return -1;
+
+    *nbMatches = matches_.size();
+    *complete  = ( nbLinesIndexed_ >= nbLines );
+
+    QVector<Match>::const_iterator i = std::lower_bound(
+            matches_.begin(), matches_.end(), Match( line, column, column ) );
+
+    if ( i != matches_.end() && i->line() == line
+            && i->startColumn() == column )
+        return i - matches_.begin();
+    else
+        return -1;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUICKFINDINDEX_H
+#define QUICKFINDINDEX_H
+
+#include <QVector>
+#include <QRegExp>
+#include <QMutex>
+
+#include "matchhistogram.h"
+
+// Sorted list of the positions of every match of a QuickFind pattern,
+// built in the background from the start of the data (and extended when
+// lines are added) so that looking for the next/previous match or the
+// number of matches doesn't need to read the file.
+// The index is tied to a regexp and to a generation of the data (see
+// AbstractLogData::getLinesGeneration), the lookups only answer for the
+// same ones and for the part of the data already indexed.
+// It also keeps the distribution of the matches (MatchHistogram), which
+// goes on being counted after the list of matches has been abandoned.
+// This class is thread-safe.
+class QuickFindIndex
+{
+  public:
+    // Maximum number of matches indexed, the index is abandoned beyond
+    // (the searches then read the file as usual).
+    static const int maxMatches;
+
+    // A match in a line, the end column being included
+    class Match {
+      public:
+        Match() : line_( -1 ), startColumn_( -1 ), endColumn_( -1 ) {}
+        Match( qint64 line, int start_column, int end_column )
+            : line_( line ), startColumn_( start_column ),
+            endColumn_( end_column ) {}
+
+        qint64 line() const { return line_; }
+        int startColumn() const { return startColumn_; }
+        int endColumn() const { return endColumn_; }
+
+        bool operator<( const Match& other ) const {
+            return ( line_ < other.line_ ) || ( line_ == other.line_
+                    && startColumn_ < other.startColumn_ );
+        }
+
+      private:
+        qint64 line_;
+        int startColumn_;
+        int endColumn_;
+    };
+
+    // Result of a lookup
+    enum Result {
+        // The match has been found
+        Found,
+        // There is no match in this direction
+        NotFound,
+        // The index cannot tell (different regexp or data, or
+        // the part of the data is not indexed yet)
+        Unknown,
+    };
+
+    QuickFindIndex();
+
+    // Empty the index and tie it to the passed regexp and generation
+    void reset( const QRegExp& regExp, int dataGeneration );
+    // Add the matches found in the lines following the ones already
+    // indexed, lines being the number of lines now indexed.
+    // The list is abandoned if this makes too many matches.
+    void append( const QVector<Match>& matches, qint64 lines );
+
+    // Returns whether the index is for the passed regexp and generation
+    bool isFor( const QRegExp& regExp, int dataGeneration ) const;
+    // Returns whether the list of matches has been abandoned
+    // (too many matches)
+    bool isAbandoned() const;
+    // Number of lines (from the first one) indexed
+    qint64 nbLinesIndexed() const;
+
+    // Find the first match starting at or after the passed position,
+    // nbLines being the number of lines of the data (to know if the
+    // index is complete).
+    Result findNext( const QRegExp& regExp, int dataGeneration,
+            qint64 nbLines, qint64 line, int column, Match* match ) const;
+    // Find the last match before the passed position, on the same line
+    // the match can start up to the column (if it is not 0, as for
+    // QRegExp::lastIndexIn()).
+    Result findPrevious( const QRegExp& regExp, int dataGeneration,
+            qint64 line, int column, Match* match ) const;
+    // Returns the rank of the match starting at the passed position
+    // (-1 if unknown) and the number of matches indexed, complete is set
+    // if they are all the matches of the data.
+    qint64 rankOf( const QRegExp& regExp, int dataGeneration,
+            qint64 nbLines, qint64 line, int column,
+            qint64* nbMatches, bool* complete ) const;
+
+    // Copy the distribution of the matches indexed so far, returns
+    // false (and leaves histogram untouched) if the index is for
+    // another regexp or generation.
+    bool getHistogram( const QRegExp& regExp, int dataGeneration,
+            MatchHistogram* histogram ) const;
+
+  private:
+    mutable QMutex mutex_;
+
+    QRegExp regexp_;
+    int dataGeneration_;
+    bool abandoned_;
+    qint64 nbLinesIndexed_;
+    QVector<Match> matches_;
+    MatchHistogram histogram_;
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements the RegExpBudget class.
+
+#include <QVector>
+
+#include "log.h"
+
+#include "regexpbudget.h"
+
+const int RegExpBudget::defaultLineBudget   = 50;
+const int RegExpBudget::defaultSearchBudget = 5000;
+const int RegExpBudget::maxSlowLines        = 100;
+const int RegExpBudget::backtrackingLimit   = 1000000;
+
+namespace {
+    const qint64 nsInMs = 1000000LL;
+}
+
+RegExpBudget::RegExpBudget( int lineBudget, int searchBudget )
+    : timer_(), lineBudget_( lineBudget * nsInMs ),
+    searchBudget_( searchBudget * nsInMs ), slowLines_()
+{
+    lineStart_ = 0;
+    slowTime_  = 0;
+    exhausted_ = false;
+
+    timer_.start();
+}
+
+void RegExpBudget::startLine()
+{
+    lineStart_ = timer_.nsecsElapsed();
+}
+
+bool RegExpBudget::lineDone( qint64 line )
+{
+    const qint64 now   = timer_.nsecsElapsed();
+    const qint64 spent = now - lineStart_;
+    lineStart_ = now;
+
+    if ( spent > lineBudget_ ) {
+        LOG(logWARNING) << "Line " << line << " took "
+            << spent / nsInMs << " ms to match";
+
+        if ( slowLines_.size() < maxSlowLines )
+            slowLines_.append( line );
+
+        slowTime_ += spent;
+        if ( slowTime_ > searchBudget_ )
+            exhausted_ = true;
+    }
+
+    return ! exhausted_;
+}
+
+bool RegExpBudget::isPatternRisky( const QString& pattern )
+{
+    // For each group opened, whether it contains a repetition
+    QVector<bool> openGroups;
+    // Whether the previous token is a group containing a repetition
+    bool repeatingGroup = false;
+
+    int i = 0;
+    while ( i < pattern.size() ) {
+        const QChar c = pattern.at( i );
+        bool closingRepeatingGroup = false;
+
+        if ( c == '\\' ) {
+            // Escaped character
+            i += 2;
+        }
+        else if ( c == '[' ) {
+            // Skip the character class (a ']' first is a literal)
+            i++;
+            if ( i < pattern.size() && pattern.at( i ) == '^' )
+                i++;
+            if ( i < pattern.size() && pattern.at( i ) == ']' )
+                i++;
+            while ( i < pattern.size() && pattern.at( i ) != ']' ) {
+                if ( pattern.at( i ) == '\\' )
+                    i++;
+                i++;
+            }
+            i++;
+        }
+        else if ( c == '(' ) {
+            openGroups.append( false );
+            i++;
+        }
+        else if ( c == ')' ) {
+            if ( ! openGroups.isEmpty() ) {
+                closingRepeatingGroup = openGroups.last();
+                openGroups.pop_back();
+                // What repeats in a group repeats in the enclosing one
+                if ( closingRepeatingGroup && ! openGroups.isEmpty() )
+                    openGroups.last() = true;
+            }
+            i++;
+        }
+        else if ( c == '*' || c == '+' || c == '{' ) {
+            bool unbounded = true;
+            int next = i + 1;
+
+            if ( c == '{' ) {
+                const int end = pattern.indexOf( '}', i );
+                if ( end < 0 ) {
+                    // Not a repetition
+                    i++;
+                    repeatingGroup = false;
+                    continue;
+                }
+                // "{n,}" has no maximum
+                unbounded = ( pattern.at( end - 1 ) == ',' );
+                next = end + 1;
+            }
+
+            if ( repeatingGroup && unbounded )
+                return true;
+
+            if ( ! openGroups.isEmpty() )
+                openGroups.last() = true;
+            i = next;
+        }
+        else {
+            i++;
+        }
+
+        repeatingGroup = closingRepeatingGroup;
+    }
+
+    return false;
+}
+
+#if QT_VERSION >= 0x050000
+bool RegExpBudget::limitedRegExp( const QRegExp& regexp,
+        QRegularExpression* limited )
+{
+    if ( regexp.patternSyntax() != QRegExp::RegExp2 )
+        return false;
+
+    QRegularExpression::PatternOptions options =
+        QRegularExpression::NoPatternOption;
+    if ( regexp.caseSensitivity() == Qt::CaseInsensitive )
+        options |= QRegularExpression::CaseInsensitiveOption;
+
+    // The limit must be at the very start of the pattern
+    limited->setPattern( QString( "(*LIMIT_MATCH=%1)" )
+            .arg( backtrackingLimit ) + regexp.pattern() );
+    limited->setPatternOptions( options );
+
+    if ( ! limited->isValid() ) {
+        LOG(logWARNING) << "Cannot limit the backtracking of "
+            << regexp.pattern().toStdString() << ": "
+            << limited->errorString().toStdString();
+        return false;
+    }
+
+    return true;
+}
+#endif
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REGEXPBUDGET_H
+#define REGEXPBUDGET_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QList>
+#include <QRegExp>
+#if QT_VERSION >= 0x050000
+#include <QRegularExpression>
+#endif
+
+// Limits the time a search can spend on the lines a regular expression
+// is slow to match (catastrophic backtracking, e.g. "(a+)+$" on a long
+// line of 'a').
+// QRegExp cannot be stopped while it matches a line, so the time spent
+// on each line is measured after the fact: the lines over the line budget
+// are flagged as slow and the search is abandoned once the slow lines
+// have used the whole search budget.
+// As a single line can take hours, the risky patterns should be caught
+// before searching (isPatternRisky) and, with Qt5, matched with a limited
+// backtracking (limitedRegExp).
+// This class is not thread-safe.
+class RegExpBudget
+{
+  public:
+    // Time (ms) the matching of a line can take before it is flagged
+    static const int defaultLineBudget;
+    // Total time (ms) the slow lines of a search can take
+    static const int defaultSearchBudget;
+    // Maximum number of slow lines remembered
+    static const int maxSlowLines;
+    // Maximum number of backtracking steps of a limited regexp per line
+    static const int backtrackingLimit;
+
+    RegExpBudget( int lineBudget = defaultLineBudget,
+            int searchBudget = defaultSearchBudget );
+
+    // Start measuring a line, to be called before the first line and
+    // after any work which must not be accounted to the next line.
+    void startLine();
+    // Account the time since the previous startLine() or lineDone() to
+    // the passed line, returns false once the budget is exhausted.
+    bool lineDone( qint64 line );
+
+    // Returns whether the search has exhausted its budget
+    bool isExhausted() const { return exhausted_; }
+    // Returns the first slow lines (up to maxSlowLines)
+    const QList<qint64>& slowLines() const { return slowLines_; }
+
+    // Returns whether the regular expression (QRegExp::RegExp2 syntax) has
+    // a repeated group which itself contains a repetition, the usual
+    // cause of catastrophic backtracking (the analysis is only syntactic
+    // and errs on the side of caution).
+    static bool isPatternRisky( const QString& pattern );
+
+#if QT_VERSION >= 0x050000
+    // Build a PCRE version of the regexp (QRegExp::RegExp2 syntax) whose
+    // backtracking is limited per line: a line over the limit does not
+    // match instead of taking forever.
+    // Returns false if the regexp cannot be converted or if the PCRE used
+    // by Qt does not support the limit.
+    static bool limitedRegExp( const QRegExp& regexp,
+            QRegularExpression* limited );
+#endif
+
+  private:
+    QElapsedTimer timer_;
+    qint64 lineStart_;
+    const qint64 lineBudget_;
+    const qint64 searchBudget_;
+    // Time spent (ns) on the slow lines
+    qint64 slowTime_;
+    QList<qint64> slowLines_;
+    bool exhausted_;
+};
+
+#endif
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements the TimestampParser and TimestampIndex classes.
+// The parsing is done by hand rather than with QDateTime::fromString
+// which is much slower and cannot cope with the trailing text.
+
+#include <algorithm>
+
+#include <QDate>
+
+#include "log.h"
+
+#include "timestampindex.h"
+
+const qint64 TimestampParser::msInDay = 24LL * 3600 * 1000;
+const int TimestampIndex::samplingInterval = 4096;
+
+namespace {
+
+// Syslog timestamps have no year, they are all put in this (leap) year.
+const int syslogYear = 2000;
+
+const char* const monthNames[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+    "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+// Reads exactly 'digits' digits at pos, returns false if there aren't
+bool readNumber( const QString& s, int* pos, int digits, int* value )
+{
+    if ( *pos + digits > s.length() )
+        return false;
+
+    int v = 0;
+    for ( int i = 0; i < digits; i++ ) {
+        const QChar c = s.at( *pos + i );
+        if ( ! c.isDigit() )
+            return false;
+        v = v * 10 + c.digitValue();
+    }
+
+    *pos += digits;
+    *value = v;
+    return true;
+}
+
+bool readChar( const QString& s, int* pos, char c )
+{
+    if ( *pos < s.length() && s.at( *pos ) == c ) {
+        ++*pos;
+        return true;
+    }
+    else
+        return false;
+}
+
+bool readMonthName( const QString& s, int* pos, int* month )
+{
+    const QString name = s.mid( *pos, 3 );
+
+    for ( int i = 0; i < 12; i++ ) {
+        if ( name == monthNames[i] ) {
+            *pos += 3;
+            *month = i + 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// hh:mm:ss with optional milliseconds (.123 or ,123)
+// returns the number of milliseconds since midnight or -1
+qint64 readTime( const QString& s, int* pos )
+{
+    int hours, minutes, seconds;
+
+    if ( ! ( readNumber( s, pos, 2, &hours ) && readChar( s, pos, ':' )
+                && readNumber( s, pos, 2, &minutes ) && readChar( s, pos, ':' )
+                && readNumber( s, pos, 2, &seconds ) ) )
+        return -1;
+
+    if ( hours > 23 || minutes > 59 || seconds > 60 )
+        return -1;
+
+    qint64 ms = ( ( hours * 60LL + minutes ) * 60 + seconds ) * 1000;
+
+    if ( readChar( s, pos, '.' ) || readChar( s, pos, ',' ) ) {
+        // Only the first three digits are relevant
+        int scale = 100;
+        while ( *pos < s.length() && s.at( *pos ).isDigit() ) {
+            ms += s.at( *pos ).digitValue() * scale;
+            scale /= 10;
+            ++*pos;
+        }
+    }
+
+    return ms;
+}
+
+qint64 toTimestamp( int year, int month, int day, qint64 timeOfDay )
+{
+    const QDate date( year, month, day );
+
+    if ( timeOfDay < 0 || ! date.isValid() )
+        return -1;
+    else
+        return date.toJulianDay() * TimestampParser::msInDay + timeOfDay;
+}
+
+}
+
+qint64 TimestampParser::parse( const QString& line ) const
+{
+    return parse( line, format_ );
+}
+
+qint64 TimestampParser::parse( const QString& line, Format format )
+{
+    int pos = 0;
+    int year, month, day;
+
+    // Timestamps are often bracketed
+    readChar( line, &pos, '[' );
+
+    switch ( format ) {
+        case Iso:
+            if ( readNumber( line, &pos, 4, &year ) && readChar( line, &pos, '-' )
+                    && readNumber( line, &pos, 2, &month ) && readChar( line, &pos, '-' )
+                    && readNumber( line, &pos, 2, &day )
+                    && ( readChar( line, &pos, ' ' ) || readChar( line, &pos, 'T' ) ) )
+                return toTimestamp( year, month, day, readTime( line, &pos ) );
+            break;
+        case Apache:
+            if ( readNumber( line, &pos, 2, &day ) && readChar( line, &pos, '/' )
+                    && readMonthName( line, &pos, &month ) && readChar( line, &pos, '/' )
+                    && readNumber( line, &pos, 4, &year ) && readChar( line, &pos, ':' ) )
+                return toTimestamp( year, month, day, readTime( line, &pos ) );
+            break;
+        case Syslog:
+            // The day is space padded
+            if ( readMonthName( line, &pos, &month ) && readChar( line, &pos, ' ' ) ) {
+                readChar( line, &pos, ' ' );
+                if ( readNumber( line, &pos, 2, &day )
+                        || readNumber( line, &pos, 1, &day ) ) {
+                    if ( readChar( line, &pos, ' ' ) )
+                        return toTimestamp( syslogYear, month, day,
+                                readTime( line, &pos ) );
+                }
+            }
+            break;
+        case TimeOnly:
+            return readTime( line, &pos );
+        default:
+            break;
+    }
+
+    return -1;
+}
+
+TimestampParser::Format TimestampParser::detect( const QStringList& lines )
+{
+    static const Format formats[] = { Iso, Apache, Syslog, TimeOnly };
+
+    int nbLines = 0;
+    foreach ( const QString& line, lines ) {
+        if ( ! line.isEmpty() )
+            nbLines++;
+    }
+
+    Format bestFormat = Unknown;
+    int bestCount = 0;
+    for ( unsigned i = 0; i < sizeof( formats ) / sizeof( formats[0] ); i++ ) {
+        int count = 0;
+        foreach ( const QString& line, lines ) {
+            if ( parse( line, formats[i] ) >= 0 )
+                count++;
+        }
+        if ( count > bestCount ) {
+            bestCount  = count;
+            bestFormat = formats[i];
+        }
+    }
+
+    // Multi-line messages are common but a few lines starting
+    // with something looking like a time are not enough.
+    if ( bestCount * 4 < nbLines )
+        bestFormat = Unknown;
+
+    LOG(logDEBUG) << "TimestampParser::detect: format " << bestFormat
+        << " found in " << bestCount << "/" << nbLines << " lines";
+
+    return bestFormat;
+}
+
+qint64 TimestampParser::parseUserTime( const QString& text, qint64 reference )
+{
+    QString time = text.trimmed();
+
+    // Full dates
+    foreach ( Format format, QList<Format>() << Iso << Apache << Syslog ) {
+        const qint64 timestamp = parse( time, format );
+        if ( timestamp >= 0 )
+            return timestamp;
+    }
+
+    // Seconds are optional in what the user types
+    if ( time.length() == 5 )
+        time += ":00";
+
+    const qint64 timeOfDay = parse( time, TimeOnly );
+    if ( timeOfDay >= 0 ) {
+        const qint64 day = ( reference > 0 ) ? reference / msInDay : 0;
+        return day * msInDay + timeOfDay;
+    }
+
+    return -1;
+}
+
+void TimestampIndex::addSample( qint64 line, qint64 time )
+{
+    lines_.append( line );
+    times_.append( time );
+}
+
+void TimestampIndex::append( const TimestampIndex& other, qint64 lineOffset )
+{
+    if ( ! parser_.isValid() )
+        parser_ = other.parser_;
+
+    for ( int i = 0; i < other.lines_.size(); i++ )
+        addSample( other.lines_[i] + lineOffset, other.times_[i] );
+}
+
+// The samples are assumed in time order, a binary search is enough.
+qint64 TimestampIndex::lineBefore( qint64 time ) const
+{
+    const int i = std::lower_bound( times_.begin(), times_.end(), time )
+        - times_.begin();
+
+    return ( i > 0 ) ? lines_[i - 1] : 0;
+}
+
+qint64 TimestampIndex::lineAfter( qint64 time ) const
+{
+    const int i = std::lower_bound( times_.begin(), times_.end(), time )
+        - times_.begin();
+
+    return ( i < lines_.size() ) ? lines_[i] : -1;
+}
+
+qint64 TimestampIndex::timeAt( qint64 line ) const
+{
+    if ( times_.isEmpty() )
+        return -1;
+
+    const int i = std::upper_bound( lines_.begin(), lines_.end(), line )
+        - lines_.begin();
+
+    return times_[ qMax( i - 1, 0 ) ];
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMESTAMPINDEX_H
+#define TIMESTAMPINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Recognises the timestamps found at the beginning of log lines.
+// A timestamp is represented by a number of milliseconds which is only
+// meant to be compared with others from the same parser
+// (day number * 86400000 + milliseconds in the day).
+class TimestampParser
+{
+  public:
+    // Supported formats
+    enum Format {
+        Unknown,
+        Iso,        // 2014-03-01 12:00:05[.123] (or 2014-03-01T12:00:05)
+        Apache,     // [01/Mar/2014:12:00:05
+        Syslog,     // Mar  1 12:00:05
+        TimeOnly,   // 12:00:05[.123]
+    };
+
+    // Milliseconds in a day
+    static const qint64 msInDay;
+
+    TimestampParser( Format format = Unknown ) : format_( format ) {}
+
+    Format format() const { return format_; }
+    bool isValid() const { return format_ != Unknown; }
+
+    // Returns the timestamp found at the beginning of the line
+    // (only the first characters are considered), -1 if none
+    qint64 parse( const QString& line ) const;
+
+    // Returns the format recognised in most of the passed lines
+    static Format detect( const QStringList& lines );
+
+    // Parses a time entered by the user in any supported format, if it
+    // has no date, the date of the reference timestamp is used.
+    // Returns -1 if the string cannot be understood.
+    static qint64 parseUserTime( const QString& text, qint64 reference );
+
+  private:
+    static qint64 parse( const QString& line, Format format );
+
+    Format format_;
+};
+
+// A sparse index of the timestamps of a file: one line out of
+// samplingInterval (approximately, lines without a timestamp are
+// skipped) is associated with its timestamp.
+// The file is supposed to be (mostly) time ordered.
+class TimestampIndex
+{
+  public:
+    // Sample one line every...
+    static const int samplingInterval;
+
+    TimestampIndex() : parser_(), lines_(), times_() {}
+
+    const TimestampParser& parser() const { return parser_; }
+    void setParser( const TimestampParser& parser ) { parser_ = parser; }
+
+    // Returns whether the index contains any sample
+    bool isEmpty() const { return lines_.isEmpty(); }
+    // Returns the line of the last sample (-1 if none)
+    qint64 lastSampleLine() const
+    { return lines_.isEmpty() ? -1 : lines_.last(); }
+
+    // Adds a sample, line numbers must be increasing
+    void addSample( qint64 line, qint64 time );
+    // Appends the samples of another index, offsetting its line numbers
+    void append( const TimestampIndex& other, qint64 lineOffset );
+
+    // Returns the line of the last sample whose timestamp is before
+    // the passed time (0 if none).
+    qint64 lineBefore( qint64 time ) const;
+    // Returns the line of the first sample whose timestamp is at or after
+    // the passed time (-1 if none).
+    qint64 lineAfter( qint64 time ) const;
+    // Returns the timestamp of the last sample at or before the passed
+    // line (or of the first sample), -1 if the index is empty.
+    qint64 timeAt( qint64 line ) const;
+
+  private:
+    TimestampParser parser_;
+    QVector<qint64> lines_;
+    QVector<qint64> times_;
+};
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements the Tracer class.
+
+#include <memory>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+#include <QThreadStorage>
+#include <QVector>
+
+#include "log.h"
+
+#include "tracer.h"
+
+std::atomic<bool> Tracer::enabled_( false );
+
+namespace {
+    struct TraceEvent {
+        const char* name;
+        qint64 start;
+        // -1 for an instant event
+        qint64 duration;
+    };
+
+    // The events of one thread, the mutex is only contended when
+    // the trace is being saved.
+    class ThreadBuffer {
+      public:
+        ThreadBuffer( int id, const QString& name )
+            : mutex_(), events_( Tracer::eventsPerThread ), id_( id ),
+            name_( name ) { nbEvents_ = 0; }
+
+        void add( const TraceEvent& event )
+        {
+            QMutexLocker locker( &mutex_ );
+            events_[ nbEvents_ % events_.size() ] = event;
+            ++nbEvents_;
+        }
+
+        void clear()
+        {
+            QMutexLocker locker( &mutex_ );
+            nbEvents_ = 0;
+        }
+
+        // Returns the events kept, the oldest first
+        QVector<TraceEvent> events() const
+        {
+            QMutexLocker locker( &mutex_ );
+            const qint64 first = qMax( 0LL, nbEvents_ - events_.size() );
+            QVector<TraceEvent> result;
+            result.reserve( nbEvents_ - first );
+            for ( qint64 i = first; i < nbEvents_; i++ )
+                result.append( events_[ i % events_.size() ] );
+            return result;
+        }
+
+        int id() const { return id_; }
+        const QString& name() const { return name_; }
+
+      private:
+        mutable QMutex mutex_;
+        QVector<TraceEvent> events_;
+        qint64 nbEvents_;
+        const int id_;
+        const QString name_;
+    };
+
+    // All the buffers, kept after their thread is finished so the events
+    // can still be saved.
+    QMutex buffersMutex;
+    QList<std::shared_ptr<ThreadBuffer>> buffers;
+
+    QThreadStorage<std::shared_ptr<ThreadBuffer>> currentThreadBuffer;
+
+    QElapsedTimer startedTimer()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }
+
+    QString threadName()
+    {
+        QThread* thread = QThread::currentThread();
+        const QCoreApplication* application = QCoreApplication::instance();
+
+        if ( application && thread == application->thread() )
+            return "Main";
+        else if ( ! thread->objectName().isEmpty() )
+            return thread->objectName();
+        else
+            return thread->metaObject()->className();
+    }
+
+    ThreadBuffer* currentBuffer()
+    {
+        if ( ! currentThreadBuffer.hasLocalData() ) {
+            QMutexLocker locker( &buffersMutex );
+            std::shared_ptr<ThreadBuffer> buffer = std::make_shared<ThreadBuffer>(
+                    buffers.size() + 1, threadName() );
+            buffers.append( buffer );
+            currentThreadBuffer.setLocalData( buffer );
+        }
+
+        return currentThreadBuffer.localData().get();
+    }
+
+    QString jsonString( const QString& string )
+    {
+        QString escaped = string;
+        escaped.replace( '\\', "\\\\" ).replace( '"', "\\\"" );
+        return "\"" + escaped + "\"";
+    }
+}
+
+void Tracer::setEnabled( bool enabled )
+{
+    LOG(logDEBUG) << "Tracer::setEnabled " << enabled;
+
+    // Start the clock now rather than in the first event
+    now();
+    enabled_.store( enabled );
+}
+
+qint64 Tracer::now()
+{
+    static const QElapsedTimer timer = startedTimer();
+
+    return timer.nsecsElapsed() / 1000;
+}
+
+void Tracer::complete( const char* name, qint64 start, qint64 duration )
+{
+    const TraceEvent event = { name, start, duration };
+    currentBuffer()->add( event );
+}
+
+void Tracer::instant( const char* name )
+{
+    if ( isEnabled() ) {
+        const TraceEvent event = { name, now(), -1 };
+        currentBuffer()->add( event );
+    }
+}
+
+void Tracer::clear()
+{
+    QMutexLocker locker( &buffersMutex );
+
+    foreach ( const std::shared_ptr<ThreadBuffer>& buffer, buffers )
+        buffer->clear();
+}
+
+QString Tracer::toJson()
+{
+    QList<std::shared_ptr<ThreadBuffer>> all_buffers;
+    {
+        QMutexLocker locker( &buffersMutex );
+        all_buffers = buffers;
+    }
+
+    QStringList events;
+    foreach ( const std::shared_ptr<ThreadBuffer>& buffer, all_buffers ) {
+        const QString thread = QString( "\"pid\": 1, \"tid\": %1" )
+            .arg( buffer->id() );
+
+        events << QString( "{ \"name\": \"thread_name\", \"ph\": \"M\", %1, "
+                "\"args\": { \"name\": %2 } }" )
+            .arg( thread ).arg( jsonString( buffer->name() ) );
+
+        foreach ( const TraceEvent& event, buffer->events() ) {
+            if ( event.duration >= 0 )
+                events << QString( "{ \"name\": %1, \"ph\": \"X\", "
+                        "\"ts\": %2, \"dur\": %3, %4 }" )
+                    .arg( jsonString( event.name ) ).arg( event.start )
+                    .arg( event.duration ).arg( thread );
+            else
+                events << QString( "{ \"name\": %1, \"ph\": \"i\", "
+                        "\"s\": \"t\", \"ts\": %2, %3 }" )
+                    .arg( jsonString( event.name ) ).arg( event.start )
+                    .arg( thread );
+        }
+    }
+
+    return "{ \"traceEvents\": [\n" + events.join( ",\n" )
+        + "\n], \"displayTimeUnit\": \"ms\" }\n";
+}
+
+bool Tracer::save( const QString& fileName )
+{
+    QFile file( fileName );
+
+    if ( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        LOG(logWARNING) << "Cannot write the trace to " << fileName.toStdString();
+        return false;
+    }
+
+    file.write( toJson().toUtf8() );
+    return true;
+}
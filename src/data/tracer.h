@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+
+#include <QString>
+
+// Records what the threads are doing, as timed events kept in a ring
+// buffer per thread, which can be saved in the Chrome trace format
+// (to be opened with chrome://tracing or Perfetto).
+// Tracing is off by default, the scopes then cost a relaxed atomic load.
+class Tracer
+{
+  public:
+    // Number of events kept for each thread (the oldest are dropped)
+    static const int eventsPerThread = 65536;
+
+    static bool isEnabled() { return enabled_.load( std::memory_order_relaxed ); }
+    static void setEnabled( bool enabled );
+
+    // Time since the tracer was first used (us)
+    static qint64 now();
+
+    // Record an event of the calling thread, the name must be a string
+    // literal (only the pointer is kept).
+    static void complete( const char* name, qint64 start, qint64 duration );
+    static void instant( const char* name );
+
+    // Forget the events recorded so far
+    static void clear();
+
+    // Returns the events of all the threads in the Chrome trace format
+    static QString toJson();
+    // Write the events to the passed file, returns false if it cannot
+    // be written.
+    static bool save( const QString& fileName );
+
+  private:
+    static std::atomic<bool> enabled_;
+};
+
+// Traces the time spent in its scope, if tracing is enabled when
+// entering the scope.
+class TraceScope
+{
+  public:
+    explicit TraceScope( const char* name )
+        : name_( name ), start_( Tracer::isEnabled() ? Tracer::now() : -1 ) {}
+    ~TraceScope()
+    {
+        if ( start_ >= 0 )
+            Tracer::complete( name_, start_, Tracer::now() - start_ );
+    }
+
+  private:
+    // Non copyable
+    TraceScope( const TraceScope& );
+    TraceScope& operator=( const TraceScope& );
+
+    const char* name_;
+    const qint64 start_;
+};
+
+#endif
@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements the TrigramIndex class.
+// The signature of a block is a bitmap of 2^15 bits (4 KiB), for a typical
+// block of 5000 log lines it is around a third full, so a literal of
+// ten characters lets us skip nearly all the blocks not containing it.
+
+#include "log.h"
+
+#include "trigramindex.h"
+
+const int TrigramIndex::hashBits = 15;
+
+namespace {
+
+// Returns the position of the ']' closing the character class
+// opened at pos (or the end of the pattern).
+int skipCharClass( const QString& pattern, int pos )
+{
+    const int length = pattern.length();
+    int i = pos + 1;
+
+    if ( i < length && pattern.at( i ) == '^' )
+        i++;
+    // A ']' at the beginning is part of the class
+    if ( i < length && pattern.at( i ) == ']' )
+        i++;
+    while ( i < length && pattern.at( i ) != ']' ) {
+        if ( pattern.at( i ) == '\\' )
+            i++;
+        i++;
+    }
+
+    return i;
+}
+
+// Extracts the literal strings a match of the (QRegExp) regexp must
+// contain.  This is conservative: we only consider the literals outside
+// any group and not made optional by a quantifier.
+// Returns false if nothing can be extracted (alternation).
+bool extractRegExpLiterals( const QString& pattern, QStringList* literals )
+{
+    QString literal;
+    bool lastAtomInLiteral = false;
+    int depth = 0;
+
+    for ( int i = 0; i < pattern.length(); i++ ) {
+        QChar c = pattern.at( i );
+        bool isLiteral = false;
+
+        if ( c == '|' ) {
+            return false;
+        }
+        else if ( c == '*' || c == '?' || c == '{' ) {
+            // The previous atom is optional
+            if ( lastAtomInLiteral )
+                literal.chop( 1 );
+            if ( c == '{' ) {
+                while ( i < pattern.length() && pattern.at( i ) != '}' )
+                    i++;
+            }
+        }
+        else if ( c == '(' ) {
+            depth++;
+        }
+        else if ( c == ')' ) {
+            if ( depth > 0 )
+                depth--;
+        }
+        else if ( c == '[' ) {
+            i = skipCharClass( pattern, i );
+        }
+        else if ( c == '\\' ) {
+            if ( ++i < pattern.length() ) {
+                c = pattern.at( i );
+                if ( c == 'x' || c == '0' ) {
+                    // Character code (\xhhhh or \0ooo)
+                    const QString digits = ( c == 'x' ) ?
+                        "0123456789abcdefABCDEF" : "01234567";
+                    const int maxDigits = ( c == 'x' ) ? 4 : 3;
+                    for ( int n = 0; n < maxDigits && i + 1 < pattern.length()
+                            && digits.contains( pattern.at( i + 1 ) ); n++ )
+                        i++;
+                }
+                // \d, \w, back references... are not literals
+                isLiteral = ! c.isLetterOrNumber();
+            }
+        }
+        else if ( c != '.' && c != '^' && c != '$' && c != '+' ) {
+            isLiteral = true;
+        }
+
+        if ( isLiteral && depth == 0 && c.unicode() < 128 ) {
+            literal += c;
+            lastAtomInLiteral = true;
+        }
+        else {
+            if ( ! literal.isEmpty() )
+                *literals << literal;
+            literal.clear();
+            lastAtomInLiteral = false;
+        }
+    }
+
+    if ( ! literal.isEmpty() )
+        *literals << literal;
+
+    return true;
+}
+
+// Extracts the literal strings from a fixed string, only the ASCII parts
+// are used as the case folding of other characters is not as simple.
+void extractFixedStringLiterals( const QString& pattern, QStringList* literals )
+{
+    QString literal;
+
+    foreach ( const QChar c, pattern ) {
+        if ( c.unicode() >= 128 ) {
+            if ( ! literal.isEmpty() )
+                *literals << literal;
+            literal.clear();
+        }
+        else {
+            literal += c;
+        }
+    }
+
+    if ( ! literal.isEmpty() )
+        *literals << literal;
+}
+
+// Extracts the literal strings from a wildcard pattern.
+void extractWildcardLiterals( const QString& pattern, QStringList* literals )
+{
+    QString literal;
+
+    for ( int i = 0; i < pattern.length(); i++ ) {
+        const QChar c = pattern.at( i );
+
+        if ( c == '[' )
+            i = skipCharClass( pattern, i );
+
+        if ( c == '[' || c == '*' || c == '?' || c == '\\'
+                || c.unicode() >= 128 ) {
+            if ( ! literal.isEmpty() )
+                *literals << literal;
+            literal.clear();
+        }
+        else {
+            literal += c;
+        }
+    }
+
+    if ( ! literal.isEmpty() )
+        *literals << literal;
+}
+
+}
+
+TrigramIndex::Query::Query( const QRegExp& regexp ) : hashes_()
+{
+    const QString pattern = regexp.pattern();
+    QStringList literals;
+
+    switch ( regexp.patternSyntax() ) {
+        case QRegExp::FixedString:
+            extractFixedStringLiterals( pattern, &literals );
+            break;
+        case QRegExp::Wildcard:
+        case QRegExp::WildcardUnix:
+            extractWildcardLiterals( pattern, &literals );
+            break;
+        case QRegExp::RegExp:
+        case QRegExp::RegExp2:
+            if ( ! extractRegExpLiterals( pattern, &literals ) )
+                literals.clear();
+            break;
+        default:
+            break;
+    }
+
+    foreach ( const QString& literal, literals )
+        addLiteral( literal );
+
+    LOG(logDEBUG) << "TrigramIndex::Query: " << hashes_.size()
+        << " trigrams from " << literals.size() << " literals";
+}
+
+void TrigramIndex::Query::addLiteral( const QString& literal )
+{
+    for ( int i = 2; i < literal.length(); i++ ) {
+        const uint h = hash( fold( literal.at( i - 2 ) ),
+                fold( literal.at( i - 1 ) ), fold( literal.at( i ) ) );
+        if ( ! hashes_.contains( h ) )
+            hashes_.append( h );
+    }
+}
+
+TrigramIndex::TrigramIndex() : signatures_()
+{
+    sourceGeneration_ = 0;
+}
+
+void TrigramIndex::reset( int sourceGeneration )
+{
+    signatures_.clear();
+    sourceGeneration_ = sourceGeneration;
+}
+
+bool TrigramIndex::isIndexed( int block ) const
+{
+    return ( block < signatures_.size() ) && ( ! signatures_[block].isEmpty() );
+}
+
+void TrigramIndex::indexBlock( int block, const QStringList& lines )
+{
+    QBitArray signature( 1 << hashBits );
+
+    foreach ( const QString& line, lines ) {
+        if ( line.length() < 3 )
+            continue;
+
+        const QChar* data = line.constData();
+        ushort a = fold( data[0] );
+        ushort b = fold( data[1] );
+        for ( int i = 2; i < line.length(); i++ ) {
+            const ushort c = fold( data[i] );
+            signature.setBit( hash( a, b, c ) );
+            a = b;
+            b = c;
+        }
+    }
+
+    if ( block >= signatures_.size() )
+        signatures_.resize( block + 1 );
+    signatures_[block] = signature;
+}
+
+bool TrigramIndex::mayMatch( int block, const Query& query ) const
+{
+    if ( ! isIndexed( block ) )
+        return true;
+
+    const QBitArray& signature = signatures_[block];
+    foreach ( uint h, query.hashes_ ) {
+        if ( ! signature.testBit( h ) )
+            return false;
+    }
+
+    return true;
+}
+
+uint TrigramIndex::hash( ushort a, ushort b, ushort c )
+{
+    const uint h = ( ( a * 31u + b ) * 31u + c ) * 2654435761u;
+
+    return h >> ( 32 - hashBits );
+}
+
+// Case folding, a case insensitive search finds lines differing from the
+// pattern only in case, their trigrams must be the same.
+ushort TrigramIndex::fold( QChar c )
+{
+    return c.toLower().unicode();
+}
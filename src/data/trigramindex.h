@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRIGRAMINDEX_H
+#define TRIGRAMINDEX_H
+
+#include <QVector>
+#include <QBitArray>
+#include <QStringList>
+#include <QRegExp>
+
+// Index of the trigrams (sequences of three characters) present in each
+// block of lines of a file.
+// Each block is summarised by a fixed size signature (a bit per trigram
+// hash), which lets a search skip the blocks that cannot contain a
+// match without reading them.  Letters are indexed case-folded so the
+// same index serves case sensitive and insensitive searches.
+// This class is not thread-safe, it is used by the search worker thread
+// only.
+class TrigramIndex
+{
+  public:
+    // The trigrams a line must contain to match a regexp.
+    class Query
+    {
+      public:
+        // Builds the query from the literal strings the regexp needs
+        // to match.  The query is empty (matches everything) if no
+        // such string can be extracted.
+        Query( const QRegExp& regexp );
+
+        // An empty query cannot be used to skip any block
+        bool isEmpty() const { return hashes_.isEmpty(); }
+        // Hashes (see TrigramIndex::hash) of the trigrams required
+        const QVector<uint>& hashes() const { return hashes_; }
+
+      private:
+        friend class TrigramIndex;
+
+        void addLiteral( const QString& literal );
+
+        QVector<uint> hashes_;
+    };
+
+    TrigramIndex();
+
+    // Removes all the signatures and associates the index with the passed
+    // generation of the source data (see LogData::getIndexGeneration).
+    void reset( int sourceGeneration );
+    // Generation of the source data the index has been built from
+    int sourceGeneration() const { return sourceGeneration_; }
+
+    // Returns whether the passed block has a signature
+    bool isIndexed( int block ) const;
+    // Computes the signature of the block from its lines
+    void indexBlock( int block, const QStringList& lines );
+    // Returns false if the block is indexed and cannot contain any
+    // line matching the query.
+    bool mayMatch( int block, const Query& query ) const;
+
+    // Number of bits of the hash of a trigram (size of each signature)
+    static const int hashBits;
+
+    // Hash of the trigram of the passed (folded) characters
+    static uint hash( ushort a, ushort b, ushort c );
+    // Case folding applied to the characters before hashing them
+    static ushort fold( QChar c );
+
+  private:
+
+    QVector<QBitArray> signatures_;
+    int sourceGeneration_;
+};
+
+#endif
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QtGui>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QPushButton>
+
+#include "diagnosticsdialog.h"
+
+#include "log.h"
+#include "data/perfcounters.h"
+#include "data/tracer.h"
+
+namespace {
+    const int updatePeriod = 1000; // ms
+
+    enum Column {
+        NameColumn,
+        ValueColumn,
+        MedianColumn,
+        Percentile90Column,
+        Percentile99Column,
+        MaxColumn,
+    };
+
+    // The throughputs shown, as a counter over the time of a latency
+    struct Throughput {
+        const char* name;
+        PerfCounters::Counter counter;
+        PerfCounters::Latency latency;
+    };
+
+    const Throughput throughputs[] = {
+        { "Lines indexed/s", PerfCounters::LinesIndexed,
+            PerfCounters::IndexingTime },
+        { "Bytes indexed/s", PerfCounters::BytesIndexed,
+            PerfCounters::IndexingTime },
+        { "Lines searched/s", PerfCounters::LinesSearched,
+            PerfCounters::SearchChunkTime },
+        { "Lines read/s", PerfCounters::LinesRead,
+            PerfCounters::LineReadTime },
+    };
+    const int nbThroughputs = sizeof( throughputs ) / sizeof( throughputs[0] );
+
+    QTreeWidgetItem* addGroup( QTreeWidget* tree, const QString& name )
+    {
+        QTreeWidgetItem* group = new QTreeWidgetItem( tree,
+                QStringList( name ) );
+        group->setExpanded( true );
+        return group;
+    }
+
+    QTreeWidgetItem* addItem( QTreeWidgetItem* group, const QString& name )
+    {
+        QTreeWidgetItem* item = new QTreeWidgetItem( group,
+                QStringList( name ) );
+        for ( int column = ValueColumn; column <= MaxColumn; column++ )
+            item->setTextAlignment( column, Qt::AlignRight );
+        return item;
+    }
+}
+
+// Constructor
+DiagnosticsDialog::DiagnosticsDialog( QWidget* parent ) : QDialog( parent ),
+    updateTimer_(), counterItems_(), gaugeItems_(), latencyItems_(),
+    throughputItems_()
+{
+    setupUi( this );
+
+    buttonBox->button( QDialogButtonBox::Save )->setText(
+            tr( "Save as JSON..." ) );
+
+    QTreeWidgetItem* group = addGroup( countersTree, tr( "Counters" ) );
+    for ( int i = 0; i < PerfCounters::NbCounters; i++ )
+        counterItems_.append( addItem( group,
+                    PerfCounters::name( PerfCounters::Counter( i ) ) ) );
+
+    group = addGroup( countersTree, tr( "Queues (current/max)" ) );
+    for ( int i = 0; i < PerfCounters::NbGauges; i++ )
+        gaugeItems_.append( addItem( group,
+                    PerfCounters::name( PerfCounters::Gauge( i ) ) ) );
+
+    group = addGroup( countersTree, tr( "Latencies (count)" ) );
+    for ( int i = 0; i < PerfCounters::NbLatencies; i++ )
+        latencyItems_.append( addItem( group,
+                    PerfCounters::name( PerfCounters::Latency( i ) ) ) );
+
+    group = addGroup( countersTree, tr( "Throughput" ) );
+    for ( int i = 0; i < nbThroughputs; i++ )
+        throughputItems_.append( addItem( group,
+                    tr( throughputs[i].name ) ) );
+
+    connect( buttonBox, SIGNAL( clicked( QAbstractButton* ) ),
+            this, SLOT( onButtonBoxClicked( QAbstractButton* ) ) );
+    traceCheckBox->setChecked( Tracer::isEnabled() );
+    connect( traceCheckBox, SIGNAL( toggled( bool ) ),
+            this, SLOT( onTraceToggled( bool ) ) );
+    connect( saveTraceButton, SIGNAL( clicked() ),
+            this, SLOT( saveTrace() ) );
+
+    connect( &updateTimer_, SIGNAL( timeout() ),
+            this, SLOT( updateCounters() ) );
+
+    updateCounters();
+    for ( int column = NameColumn; column <= MaxColumn; column++ )
+        countersTree->resizeColumnToContents( column );
+
+    updateTimer_.start( updatePeriod );
+}
+
+//
+// Slots
+//
+
+void DiagnosticsDialog::updateCounters()
+{
+    for ( int i = 0; i < PerfCounters::NbCounters; i++ )
+        counterItems_[i]->setText( ValueColumn, QString::number(
+                    PerfCounters::value( PerfCounters::Counter( i ) ) ) );
+
+    for ( int i = 0; i < PerfCounters::NbGauges; i++ ) {
+        const PerfCounters::Gauge gauge = PerfCounters::Gauge( i );
+        gaugeItems_[i]->setText( ValueColumn,
+                QString( "%1/%2" ).arg( PerfCounters::level( gauge ) )
+                .arg( PerfCounters::maxLevel( gauge ) ) );
+    }
+
+    for ( int i = 0; i < PerfCounters::NbLatencies; i++ ) {
+        const LatencyHistogram& histogram =
+            PerfCounters::latency( PerfCounters::Latency( i ) );
+        QTreeWidgetItem* item = latencyItems_[i];
+        item->setText( ValueColumn, QString::number( histogram.count() ) );
+        item->setText( MedianColumn,
+                QString::number( histogram.percentile( 50 ) ) );
+        item->setText( Percentile90Column,
+                QString::number( histogram.percentile( 90 ) ) );
+        item->setText( Percentile99Column,
+                QString::number( histogram.percentile( 99 ) ) );
+        item->setText( MaxColumn, QString::number( histogram.max() ) );
+    }
+
+    for ( int i = 0; i < nbThroughputs; i++ )
+        throughputItems_[i]->setText( ValueColumn, QString::number(
+                    PerfCounters::throughput( throughputs[i].counter,
+                        throughputs[i].latency ) ) );
+}
+
+void DiagnosticsDialog::onButtonBoxClicked( QAbstractButton* button )
+{
+    switch ( buttonBox->buttonRole( button ) ) {
+        case QDialogButtonBox::ResetRole:
+            PerfCounters::reset();
+            updateCounters();
+            break;
+        case QDialogButtonBox::AcceptRole:
+            saveToJson();
+            break;
+        default:
+            reject();
+            break;
+    }
+}
+
+void DiagnosticsDialog::onTraceToggled( bool enabled )
+{
+    // A new trace starts each time it is turned on
+    if ( enabled )
+        Tracer::clear();
+
+    Tracer::setEnabled( enabled );
+}
+
+void DiagnosticsDialog::saveTrace()
+{
+    const QString fileName = QFileDialog::getSaveFileName( this,
+            tr( "Save the trace" ), QString(),
+            tr( "Trace files (*.json);;All files (*)" ) );
+    if ( fileName.isEmpty() )
+        return;
+
+    if ( ! Tracer::save( fileName ) )
+        QMessageBox::warning( this, tr( "glogg" ),
+                tr( "Cannot write %1." ).arg( fileName ) );
+}
+
+//
+// Private functions
+//
+
+void DiagnosticsDialog::saveToJson()
+{
+    const QString fileName = QFileDialog::getSaveFileName( this,
+            tr( "Save the counters" ), QString(),
+            tr( "JSON files (*.json);;All files (*)" ) );
+    if ( fileName.isEmpty() )
+        return;
+
+    QFile file( fileName );
+    if ( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        file.write( PerfCounters::toJson().toUtf8() );
+    }
+    else {
+        LOG(logWARNING) << "Cannot write " << fileName.toStdString();
+        QMessageBox::warning( this, tr( "glogg" ),
+                tr( "Cannot write %1:\n%2." )
+                .arg( fileName ).arg( file.errorString() ) );
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QList>
+#include <QTimer>
+
+#include "ui_diagnosticsdialog.h"
+
+class QTreeWidgetItem;
+
+// Shows the performance counters (see PerfCounters), updated every second
+// while the dialog is open, they can be reset or saved in JSON.
+// It also turns the tracing (see Tracer) on and off and saves the trace.
+class DiagnosticsDialog : public QDialog, public Ui::DiagnosticsDialog
+{
+    Q_OBJECT
+
+  public:
+    DiagnosticsDialog( QWidget* parent = 0 );
+
+  private slots:
+    // Copy the current values to the tree
+    void updateCounters();
+    // Called when a close/reset/save button is clicked.
+    void onButtonBoxClicked( QAbstractButton* button );
+    // Called when the 'trace' box is toggled.
+    void onTraceToggled( bool enabled );
+    // Ask for a file and write the trace in it
+    void saveTrace();
+
+  private:
+    // Ask for a file and write the counters in it
+    void saveToJson();
+
+    QTimer updateTimer_;
+
+    QList<QTreeWidgetItem*> counterItems_;
+    QList<QTreeWidgetItem*> gaugeItems_;
+    QList<QTreeWidgetItem*> latencyItems_;
+    QList<QTreeWidgetItem*> throughputItems_;
+};
+
+#endif
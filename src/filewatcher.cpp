@@ -20,30 +20,140 @@
 #include "log.h"
 
 #include "filewatcher.h"
+#include "data/tracer.h"
 
 #include <QStringList>
 #include <QFileInfo>
+#include <QDir>
+#include <QSocketNotifier>
 
-FileWatcher::FileWatcher() : qtFileWatcher_( this )
+#ifdef GLOGG_SUPPORTS_INOTIFY
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <sys/vfs.h>
+#endif
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+#include <windows.h>
+#endif
+
+namespace {
+#ifdef GLOGG_SUPPORTS_INOTIFY
+    // Events watched on the file itself (followed by inode)
+    const uint32_t fileEvents =
+        IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF;
+    // and on its directory (for a file appearing at its path)
+    const uint32_t directoryEvents = IN_CREATE | IN_MOVED_TO;
+#endif
+
+    // Shortest and longest intervals (ms) between two polls
+    const int minPollInterval = 250;
+    const int maxPollInterval = 4000;
+
+#ifdef Q_OS_LINUX
+    // Filesystem types (statfs) where the changes are not notified:
+    // NFS, SMB, CIFS, SMB2, Coda, AFS, Ceph and FUSE (e.g. sshfs)
+    const quint32 networkFilesystems[] = { 0x6969, 0x517B, 0xFF534D42,
+        0xFE534D42, 0x73757245, 0x5346414F, 0x00C36400, 0x65735546 };
+#endif
+
+    // Returns whether the file (or its directory if it doesn't exist)
+    // is on a network filesystem, false if the system cannot tell.
+    bool isOnNetworkFilesystem( const QString& fileName )
+    {
+        const QFileInfo info( fileName );
+
+#if defined(Q_OS_LINUX)
+        struct statfs fs_stat;
+        const QString path = info.exists() ? fileName : info.absolutePath();
+        if ( ::statfs( QFile::encodeName( path ).constData(), &fs_stat ) != 0 )
+            return false;
+
+        for ( unsigned i = 0;
+                i < sizeof networkFilesystems / sizeof networkFilesystems[0];
+                i++ ) {
+            if ( quint32( fs_stat.f_type ) == networkFilesystems[i] )
+                return true;
+        }
+        return false;
+#elif defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+        const QString path =
+            QDir::toNativeSeparators( info.absoluteFilePath() );
+        // UNC path (\\server\share\...)
+        if ( path.startsWith( "\\\\" ) )
+            return true;
+        // or network drive
+        const QString root = path.left( 3 );
+        return GetDriveTypeW( reinterpret_cast<const wchar_t*>(
+                    root.utf16() ) ) == DRIVE_REMOTE;
+#else
+        Q_UNUSED( info );
+        return false;
+#endif
+    }
+}
+
+FileWatcher::FileWatcher() : qtFileWatcher_( this ), pollTimer_(),
+    polledModified_()
 {
     monitoringState_ = None;
+    inotifyFd_       = -1;
+    fileWatch_       = -1;
+    directoryWatch_  = -1;
+    inotifyNotifier_ = NULL;
+    pollingMode_     = PollNetworkFiles;
+    pollInterval_    = minPollInterval;
+    polledExists_    = false;
+    polledSize_      = 0;
+
+#ifdef GLOGG_SUPPORTS_INOTIFY
+    inotifyFd_ = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if ( inotifyFd_ != -1 ) {
+        inotifyNotifier_ = new QSocketNotifier( inotifyFd_,
+                QSocketNotifier::Read, this );
+        connect( inotifyNotifier_, SIGNAL( activated( int ) ),
+                this, SLOT( inotifyEventsAvailable() ) );
+    }
+    else {
+        LOG(logWARNING) << "Cannot use inotify, using QFileSystemWatcher";
+    }
+#endif
 
     connect( &qtFileWatcher_, SIGNAL( fileChanged( const QString& ) ),
             this, SLOT( fileChangedOnDisk( const QString& ) ) );
 
     connect( &qtFileWatcher_, SIGNAL( directoryChanged( const QString& ) ),
             this, SLOT( directoryChangedOnDisk( const QString& ) ) );
+
+    pollTimer_.setSingleShot( true );
+    connect( &pollTimer_, SIGNAL( timeout() ), this, SLOT( pollFile() ) );
 }
 
 FileWatcher::~FileWatcher()
 {
     disconnect( &qtFileWatcher_ );
+
+#ifdef GLOGG_SUPPORTS_INOTIFY
+    if ( inotifyFd_ != -1 ) {
+        delete inotifyNotifier_;
+        close( inotifyFd_ );
+    }
+#endif
 }
 
 void FileWatcher::addFile( const QString& fileName )
 {
     LOG(logDEBUG) << "FileWatcher::addFile " << fileName.toStdString();
 
+    if ( inotifyFd_ != -1 ) {
+        inotifyAddFile( fileName );
+        startPolling();
+        return;
+    }
+
     QFileInfo fileInfo = QFileInfo( fileName );
 
     if ( fileMonitored_.isEmpty() ) {
@@ -61,6 +171,8 @@ void FileWatcher::addFile( const QString& fileName )
             LOG(logDEBUG) << "FileWatcher::addFile: file doesn't exist.";
             monitoringState_ = FileRemoved;
         }
+
+        startPolling();
     }
     else {
         LOG(logWARNING) << "FileWatcher::addFile " << fileName.toStdString()
@@ -73,6 +185,17 @@ void FileWatcher::removeFile( const QString& fileName )
 {
     LOG(logDEBUG) << "FileWatcher::removeFile " << fileName.toStdString();
 
+    if ( fileName == fileMonitored_ )
+        pollTimer_.stop();
+
+    if ( inotifyFd_ != -1 ) {
+        if ( fileName == fileMonitored_ )
+            inotifyRemoveFile();
+        else
+            LOG(logWARNING) << "FileWatcher::removeFile - The file is not watched!";
+        return;
+    }
+
     QFileInfo fileInfo = QFileInfo( fileName );
 
     if ( fileName == fileMonitored_ ) {
@@ -95,6 +218,14 @@ void FileWatcher::removeFile( const QString& fileName )
     }
 }
 
+void FileWatcher::setPollingMode( PollingMode mode )
+{
+    if ( mode != pollingMode_ ) {
+        pollingMode_ = mode;
+        startPolling();
+    }
+}
+
 //
 // Slots
 //
@@ -102,6 +233,7 @@ void FileWatcher::removeFile( const QString& fileName )
 void FileWatcher::fileChangedOnDisk( const QString& filename )
 {
     LOG(logDEBUG) << "FileWatcher::fileChangedOnDisk " << filename.toStdString();
+    Tracer::instant( "fileChangedOnDisk" );
 
     if ( ( monitoringState_ == FileExists ) && ( filename == fileMonitored_ ) )
     {
@@ -118,6 +250,7 @@ void FileWatcher::fileChangedOnDisk( const QString& filename )
 void FileWatcher::directoryChangedOnDisk( const QString& filename )
 {
     LOG(logDEBUG) << "FileWatcher::directoryChangedOnDisk " << filename.toStdString();
+    Tracer::instant( "directoryChangedOnDisk" );
 
     if ( monitoringState_ == FileRemoved ) {
         if ( QFileInfo( fileMonitored_ ).exists() ) {
@@ -151,3 +284,176 @@ void FileWatcher::directoryChangedOnDisk( const QString& filename )
     }
 
 }
+
+// The file watch follows the inode, when it is moved away (rotated) or
+// deleted, the watch is moved to whatever file is at the path, now or
+// when one is created or moved there.
+void FileWatcher::inotifyEventsAvailable()
+{
+#ifdef GLOGG_SUPPORTS_INOTIFY
+    Tracer::instant( "inotifyEvents" );
+
+    const QString name = QFileInfo( fileMonitored_ ).fileName();
+    bool changed = false;
+
+    // Aligned for the events in it
+    char buffer[4096]
+        __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+
+    while ( ( length = read( inotifyFd_, buffer, sizeof buffer ) ) > 0 ) {
+        const char* p = buffer;
+        while ( p < buffer + length ) {
+            const struct inotify_event* event =
+                reinterpret_cast<const struct inotify_event*>( p );
+            p += sizeof( struct inotify_event ) + event->len;
+
+            if ( fileMonitored_.isEmpty() )
+                continue;
+
+            if ( event->mask & IN_Q_OVERFLOW ) {
+                // Events have been lost, better check the file
+                changed = true;
+            }
+            else if ( event->wd == fileWatch_ ) {
+                if ( event->mask & ( IN_MOVE_SELF | IN_DELETE_SELF ) ) {
+                    LOG(logDEBUG) << "FileWatcher: file moved away or deleted";
+                    inotify_rm_watch( inotifyFd_, fileWatch_ );
+                    fileWatch_ = -1;
+                    // It might have been replaced already
+                    monitoringState_ = inotifyWatchFile() ?
+                        FileExists : FileRemoved;
+                    changed = true;
+                }
+                else if ( event->mask & IN_IGNORED ) {
+                    // The watch has been removed by the kernel
+                    fileWatch_ = -1;
+                    monitoringState_ = FileRemoved;
+                }
+                else {
+                    changed = true;
+                }
+            }
+            else if ( event->wd == directoryWatch_ && event->len > 0
+                    && ( event->mask & directoryEvents )
+                    && QFile::decodeName( event->name ) == name ) {
+                LOG(logDEBUG) << "FileWatcher: file created at "
+                    << fileMonitored_.toStdString();
+                if ( inotifyWatchFile() ) {
+                    monitoringState_ = FileExists;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    if ( changed && ! fileMonitored_.isEmpty() )
+        emit fileChanged( fileMonitored_ );
+#endif
+}
+
+void FileWatcher::pollFile()
+{
+    const QFileInfo info( fileMonitored_ );
+    const bool changed = ( info.exists() != polledExists_ )
+        || ( info.size() != polledSize_ )
+        || ( info.lastModified() != polledModified_ );
+
+    polledExists_   = info.exists();
+    polledSize_     = info.size();
+    polledModified_ = info.lastModified();
+
+    // Poll more often while the file is being written
+    pollInterval_ = changed ? minPollInterval :
+        qMin( pollInterval_ * 2, maxPollInterval );
+    pollTimer_.start( pollInterval_ );
+
+    if ( changed ) {
+        LOG(logDEBUG) << "FileWatcher: change found by polling";
+        Tracer::instant( "pollFile" );
+        emit fileChanged( fileMonitored_ );
+    }
+}
+
+//
+// Private functions
+//
+
+void FileWatcher::startPolling()
+{
+    pollTimer_.stop();
+
+    if ( fileMonitored_.isEmpty() || pollingMode_ == PollNever
+            || ( pollingMode_ == PollNetworkFiles
+                && ! isOnNetworkFilesystem( fileMonitored_ ) ) )
+        return;
+
+    LOG(logDEBUG) << "FileWatcher: polling " << fileMonitored_.toStdString();
+
+    const QFileInfo info( fileMonitored_ );
+    polledExists_   = info.exists();
+    polledSize_     = info.size();
+    polledModified_ = info.lastModified();
+
+    pollInterval_ = minPollInterval;
+    pollTimer_.start( pollInterval_ );
+}
+
+void FileWatcher::inotifyAddFile( const QString& fileName )
+{
+#ifdef GLOGG_SUPPORTS_INOTIFY
+    if ( ! fileMonitored_.isEmpty() ) {
+        LOG(logWARNING) << "FileWatcher::addFile " << fileName.toStdString()
+            << "- Already watching a file (" << fileMonitored_.toStdString()
+            << ")!";
+        return;
+    }
+
+    fileMonitored_ = fileName;
+
+    directoryWatch_ = inotify_add_watch( inotifyFd_,
+            QFile::encodeName( QFileInfo( fileName ).path() ).constData(),
+            directoryEvents );
+    if ( directoryWatch_ == -1 )
+        LOG(logWARNING) << "Cannot watch the directory of "
+            << fileName.toStdString();
+
+    monitoringState_ = inotifyWatchFile() ? FileExists : FileRemoved;
+#else
+    Q_UNUSED( fileName );
+#endif
+}
+
+void FileWatcher::inotifyRemoveFile()
+{
+#ifdef GLOGG_SUPPORTS_INOTIFY
+    if ( fileWatch_ != -1 )
+        inotify_rm_watch( inotifyFd_, fileWatch_ );
+    if ( directoryWatch_ != -1 )
+        inotify_rm_watch( inotifyFd_, directoryWatch_ );
+#endif
+
+    fileWatch_       = -1;
+    directoryWatch_  = -1;
+    fileMonitored_.clear();
+    monitoringState_ = None;
+}
+
+bool FileWatcher::inotifyWatchFile()
+{
+#ifdef GLOGG_SUPPORTS_INOTIFY
+    const int watch = inotify_add_watch( inotifyFd_,
+            QFile::encodeName( fileMonitored_ ).constData(), fileEvents );
+    if ( watch == -1 )
+        return false;
+
+    // Another file at the path, the previous one is not followed anymore
+    if ( fileWatch_ != -1 && fileWatch_ != watch )
+        inotify_rm_watch( inotifyFd_, fileWatch_ );
+    fileWatch_ = watch;
+
+    return true;
+#else
+    return false;
+#endif
+}
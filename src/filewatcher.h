@@ -22,10 +22,19 @@
 
 #include <QObject>
 #include <QFileSystemWatcher>
+#include <QTimer>
+#include <QDateTime>
+
+class QSocketNotifier;
 
 // This class encapsulate Qt's QFileSystemWatcher and additionally support
 // watching a file that doesn't exist yet (the class will watch the owning
 // directory)
+// On Linux, inotify is used directly instead: the file is followed by
+// inode, so it is noticed when it is moved away (e.g. rotated) and when
+// another file is created or moved in its place.
+// The file can also be polled, as no notification is received on network
+// filesystems (NFS, CIFS...) for the changes made by other hosts.
 // Only supports one file at the moment.
 class FileWatcher : public QObject {
   Q_OBJECT
@@ -43,6 +52,10 @@ class FileWatcher : public QObject {
     // (do nothing if said file is not monitored)
     void removeFile( const QString& fileName );
 
+    // When the file is polled, in addition to being watched
+    enum PollingMode { PollNetworkFiles, PollAlways, PollNever };
+    void setPollingMode( PollingMode mode );
+
   signals:
     // Sent when the file on disk has changed in any way.
     void fileChanged( const QString& );
@@ -50,13 +63,42 @@ class FileWatcher : public QObject {
   private slots:
     void fileChangedOnDisk( const QString& filename );
     void directoryChangedOnDisk( const QString& filename );
+    // Called when inotify has events to read
+    void inotifyEventsAvailable();
+    // Check if the file has changed since the last poll
+    void pollFile();
 
   private:
     enum MonitoringState { None, FileExists, FileRemoved };
 
+    // inotify versions of addFile/removeFile
+    void inotifyAddFile( const QString& fileName );
+    void inotifyRemoveFile();
+    // Watch the inode currently at the path, returns false if there
+    // is no file there
+    bool inotifyWatchFile();
+    // Start polling the file monitored, if the mode asks for it
+    void startPolling();
+
     QFileSystemWatcher qtFileWatcher_;
     QString fileMonitored_;
     MonitoringState monitoringState_;
+
+    // inotify descriptor (-1 if QFileSystemWatcher is used) and watches
+    int inotifyFd_;
+    int fileWatch_;
+    int directoryWatch_;
+    QSocketNotifier* inotifyNotifier_;
+
+    // Polling, the interval (ms) is shortened when the file changes and
+    // lengthened while it doesn't
+    PollingMode pollingMode_;
+    QTimer pollTimer_;
+    int pollInterval_;
+    // State of the file at the last poll
+    bool polledExists_;
+    qint64 polledSize_;
+    QDateTime polledModified_;
 };
 
 #endif
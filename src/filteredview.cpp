@@ -57,7 +57,7 @@ void FilteredView::setVisibility( Visibility visi )
 }
 
 // For the filtered view, a line is always matching!
-AbstractLogView::LineType FilteredView::lineType( int lineNumber ) const
+AbstractLogView::LineType FilteredView::lineType( qint64 lineNumber ) const
 {
     LogFilteredData::FilteredLineType type =
         logFilteredData_->filteredLineTypeByIndex( lineNumber );
@@ -67,7 +67,7 @@ AbstractLogView::LineType FilteredView::lineType( int lineNumber ) const
         return Match;
 }
 
-qint64 FilteredView::displayLineNumber( int lineNumber ) const
+qint64 FilteredView::displayLineNumber( qint64 lineNumber ) const
 {
     // Display a 1-based index
     return logFilteredData_->getMatchingLineNumber( lineNumber ) + 1;
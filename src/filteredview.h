@@ -37,10 +37,10 @@ class FilteredView : public AbstractLogView
     void setVisibility( Visibility visi );
 
   protected:
-    virtual LineType lineType( int lineNumber ) const;
+    virtual LineType lineType( qint64 lineNumber ) const;
 
     // Number of the filtered line relative to the unfiltered source
-    virtual qint64 displayLineNumber( int lineNumber ) const;
+    virtual qint64 displayLineNumber( qint64 lineNumber ) const;
     virtual qint64 maxDisplayLineNumber() const;
 
   private:
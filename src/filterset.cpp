@@ -22,9 +22,11 @@
 #include <QSettings>
 
 #include "log.h"
+#include "data/trigramindex.h"
 #include "filterset.h"
 
 const int FilterSet::FILTERSET_VERSION = 1;
+int FilterSet::lastVersion_ = 0;
 
 Filter::Filter()
 {
@@ -100,28 +102,134 @@ QDataStream& operator>>( QDataStream& in, Filter& object )
 
 
 // Default constructor
-FilterSet::FilterSet()
+FilterSet::FilterSet() : filterList(), compiled_(), trigramPositions_()
 {
+    compile();
+
     qRegisterMetaTypeStreamOperators<Filter>( "Filter" );
     qRegisterMetaTypeStreamOperators<FilterSet>( "FilterSet" );
     qRegisterMetaTypeStreamOperators<FilterSet::FilterList>( "FilterSet::FilterList" );
 }
 
+FilterSet::FilterSet( const FilterSet& other ) : Persistable(),
+    filterList( other.filterList ), version_( other.version_ ),
+    compiled_( other.compiled_ ),
+    trigramPositions_( other.trigramPositions_ ),
+    nbUsedTrigrams_( other.nbUsedTrigrams_ )
+{
+}
+
+FilterSet& FilterSet::operator=( const FilterSet& other )
+{
+    filterList = other.filterList;
+    compile();
+
+    return *this;
+}
+
 bool FilterSet::matchLine( const QString& line,
         QColor* foreColor, QColor* backColor ) const
 {
-    for ( QList<Filter>::const_iterator i = filterList.constBegin();
-          i != filterList.constEnd(); i++ ) {
-        if ( i->indexIn( line ) != -1 ) {
-            foreColor->setNamedColor( i->foreColorName() );
-            backColor->setNamedColor( i->backColorName() );
-            return true;
-        }
+    const int filter = firstMatchingFilter( line );
+
+    if ( filter != -1 ) {
+        *foreColor = compiled_[filter].foreColor;
+        *backColor = compiled_[filter].backColor;
+        return true;
     }
 
     return false;
 }
 
+int FilterSet::firstMatchingFilter( const QString& line ) const
+{
+    QBitArray trigrams;
+
+    return firstMatchingFilter( line, &trigrams );
+}
+
+void FilterSet::matchLines( const QStringList& lines,
+        QVector<int>* filters ) const
+{
+    filters->resize( lines.size() );
+
+    if ( filterList.isEmpty() ) {
+        filters->fill( -1 );
+        return;
+    }
+
+    QBitArray trigrams;
+    for ( int i = 0; i < lines.size(); i++ )
+        (*filters)[i] = firstMatchingFilter( lines[i], &trigrams );
+}
+
+void FilterSet::compile()
+{
+    version_ = ++lastVersion_;
+
+    compiled_.clear();
+    trigramPositions_.fill( -1, 1 << TrigramIndex::hashBits );
+    nbUsedTrigrams_ = 0;
+
+    foreach ( const Filter& filter, filterList ) {
+        CompiledFilter compiled;
+        compiled.foreColor.setNamedColor( filter.foreColorName() );
+        compiled.backColor.setNamedColor( filter.backColorName() );
+
+        const TrigramIndex::Query query( filter.regExp() );
+        foreach ( uint h, query.hashes() ) {
+            if ( trigramPositions_[h] == -1 )
+                trigramPositions_[h] = nbUsedTrigrams_++;
+            compiled.trigrams.append( trigramPositions_[h] );
+        }
+
+        compiled_.append( compiled );
+    }
+}
+
+// The line is scanned once to find which of the trigrams required by the
+// filters it contains, then only the regexps of the filters which
+// might match are tried, in order.
+int FilterSet::firstMatchingFilter( const QString& line,
+        QBitArray* trigrams ) const
+{
+    findLineTrigrams( line, trigrams );
+
+    for ( int i = 0; i < compiled_.size(); i++ ) {
+        const QVector<int>& required = compiled_[i].trigrams;
+
+        bool mayMatch = true;
+        for ( int j = 0; mayMatch && j < required.size(); j++ )
+            mayMatch = trigrams->testBit( required[j] );
+
+        if ( mayMatch && filterList[i].indexIn( line ) != -1 )
+            return i;
+    }
+
+    return -1;
+}
+
+void FilterSet::findLineTrigrams( const QString& line,
+        QBitArray* trigrams ) const
+{
+    trigrams->fill( false, nbUsedTrigrams_ );
+
+    if ( nbUsedTrigrams_ == 0 || line.length() < 3 )
+        return;
+
+    const QChar* data = line.constData();
+    ushort a = TrigramIndex::fold( data[0] );
+    ushort b = TrigramIndex::fold( data[1] );
+    for ( int i = 2; i < line.length(); i++ ) {
+        const ushort c = TrigramIndex::fold( data[i] );
+        const int position = trigramPositions_[TrigramIndex::hash( a, b, c )];
+        if ( position >= 0 )
+            trigrams->setBit( position );
+        a = b;
+        b = c;
+    }
+}
+
 //
 // Operators for serialization
 //
@@ -138,6 +246,7 @@ QDataStream& operator>>( QDataStream& in, FilterSet& object )
 {
     LOG(logDEBUG) << ">>operator from FilterSet";
     in >> object.filterList;
+    object.compile();
 
     return in;
 }
@@ -203,6 +312,8 @@ void FilterSet::retrieveFromStorage( QSettings& settings )
             LOG(logERROR) << "Unknown version of FilterSet, ignoring it...";
         }
         settings.endGroup();
+
+        compile();
     }
     else {
         LOG(logWARNING) << "Trying to import legacy (<=0.8.2) filters...";
@@ -23,6 +23,9 @@
 #include <QRegExp>
 #include <QColor>
 #include <QMetaType>
+#include <QVector>
+#include <QBitArray>
+#include <QStringList>
 
 #include "persistable.h"
 
@@ -42,6 +45,7 @@ class Filter
 
     // Accessor functions
     QString pattern() const;
+    const QRegExp& regExp() const { return regexp_; }
     void setPattern( const QString& pattern );
     const QString& foreColorName() const;
     void setForeColor( const QString& foreColorName );
@@ -70,6 +74,15 @@ class FilterSet : public Persistable
   public:
     // Construct an empty filter set
     FilterSet();
+    // A copy has the same filters, and so the same version
+    FilterSet( const FilterSet& other );
+    // Replacing the filters gives the set a new version
+    FilterSet& operator=( const FilterSet& other );
+
+    // Returns a number identifying the filters in the set, it changes
+    // every time the set is replaced or read from storage (e.g. to know
+    // when colours computed from it are out of date).
+    int version() const { return version_; }
 
     // Returns weither the passed line match a filter of the set,
     // if so, it returns the fore/back colors the line should use.
@@ -77,6 +90,21 @@ class FilterSet : public Persistable
     bool matchLine( const QString& line,
             QColor* foreColor, QColor* backColor ) const;
 
+    // Returns the index of the first filter matching the passed line,
+    // or -1 if none does.
+    int firstMatchingFilter( const QString& line ) const;
+    // Classify a block of lines in one go: filters receives, for each
+    // line, the index of the first filter matching it (or -1).
+    // Matching uses the regexps of the set, a thread must work on its
+    // own copy of the set.
+    void matchLines( const QStringList& lines, QVector<int>* filters ) const;
+    // Colours of the filter at the passed index (resolved when the
+    // set changes)
+    const QColor& foreColor( int filter ) const
+    { return compiled_[filter].foreColor; }
+    const QColor& backColor( int filter ) const
+    { return compiled_[filter].backColor; }
+
     // Reads/writes the current config in the QSettings object passed
     virtual void saveToStorage( QSettings& settings ) const;
     virtual void retrieveFromStorage( QSettings& settings );
@@ -93,12 +121,41 @@ class FilterSet : public Persistable
             QDataStream& in, FilterSet& object );
 
   private:
+    // What is precomputed for each filter when the set changes
+    struct CompiledFilter {
+        QColor foreColor;
+        QColor backColor;
+        // Trigrams the line must contain to have a chance to match
+        // (their positions in trigramPositions_)
+        QVector<int> trigrams;
+    };
+
     static const int FILTERSET_VERSION;
+    // Last version given to a set
+    static int lastVersion_;
 
     FilterList filterList;
+    int version_;
+
+    QVector<CompiledFilter> compiled_;
+    // For each trigram (hash), its position among the trigrams used by
+    // the filters, -1 if none uses it
+    QVector<int> trigramPositions_;
+    int nbUsedTrigrams_;
+
+    // Gives a new version to the set and precompute what is needed
+    // to match lines (to be called every time the filters change)
+    void compile();
+    // Set the bits (positions in trigramPositions_) of the trigrams
+    // used by the filters that the line contains
+    void findLineTrigrams( const QString& line, QBitArray* trigrams ) const;
+    // Same as the public version, trigrams being used to work with
+    int firstMatchingFilter( const QString& line, QBitArray* trigrams ) const;
 
     // To simplify this class interface, FilterDialog can access our
     // internal structure directly.
+    // (its changes are only taken into account for matching once the
+    // set is assigned to another one)
     friend class FiltersDialog;
 };
 
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements HeadlessSearch, it uses the same LogData and
+// LogFilteredData as the GUI, run from a local event loop.
+
+#include <iostream>
+
+#include <QFileInfo>
+#include <QRegExp>
+
+#include "log.h"
+
+#include "data/logdata.h"
+#include "data/logfiltereddata.h"
+#include "headlesssearch.h"
+
+// Number of lines read (and printed) at once
+static const int nbLinesPrinted = 5000;
+
+HeadlessSearch::HeadlessSearch( const QString& fileName,
+        const QString& pattern, SearchMode mode, int maxMatches )
+    : QObject(), fileName_( fileName ), pattern_( pattern ),
+    mode_( mode ), maxMatches_( maxMatches ),
+    logData_( new LogData() ), logFilteredData_(), eventLoop_()
+{
+    exitStatus_ = 2;
+
+    logFilteredData_.reset( logData_->getNewFilteredData() );
+    logFilteredData_->setVisibility( LogFilteredData::MatchesOnly );
+
+    connect( logData_.get(), SIGNAL( loadingFinished( bool ) ),
+            this, SLOT( loadingFinished( bool ) ) );
+    connect( logFilteredData_.get(), SIGNAL( searchProgressed( int, int ) ),
+            this, SLOT( searchProgressed( int, int ) ) );
+}
+
+HeadlessSearch::~HeadlessSearch()
+{
+    // The filtered data must go before the data it refers to
+    logFilteredData_.reset();
+}
+
+int HeadlessSearch::run()
+{
+    const QRegExp regexp( pattern_ );
+
+    if ( ! regexp.isValid() ) {
+        std::cerr << "Invalid regular expression: "
+            << regexp.errorString().toLocal8Bit().constData() << std::endl;
+        return 2;
+    }
+
+    if ( ! QFileInfo( fileName_ ).isReadable() ) {
+        std::cerr << "Cannot read "
+            << fileName_.toLocal8Bit().constData() << std::endl;
+        return 2;
+    }
+
+    logFilteredData_->setSearchMode( mode_, maxMatches_ );
+    logData_->attachFile( fileName_ );
+
+    // Returns when the search is finished (or the loading failed)
+    eventLoop_.exec();
+
+    return exitStatus_;
+}
+
+//
+// Slots
+//
+
+void HeadlessSearch::loadingFinished( bool success )
+{
+    LOG(logDEBUG) << "HeadlessSearch::loadingFinished " << success;
+
+    if ( success ) {
+        logFilteredData_->runSearch( QRegExp( pattern_ ) );
+    }
+    else {
+        std::cerr << "Error loading "
+            << fileName_.toLocal8Bit().constData() << std::endl;
+        eventLoop_.exit();
+    }
+}
+
+void HeadlessSearch::searchProgressed( int nbMatches, int progress )
+{
+    LOG(logDEBUG) << "HeadlessSearch::searchProgressed " << nbMatches
+        << " " << progress;
+
+    if ( progress == 100 ) {
+        printResult();
+        exitStatus_ = ( logFilteredData_->getNbMatchesFound() > 0 ) ? 0 : 1;
+        eventLoop_.exit();
+    }
+}
+
+//
+// Private functions
+//
+
+void HeadlessSearch::printResult() const
+{
+    if ( mode_ == SearchCountOnly ) {
+        std::cout << logFilteredData_->getNbMatchesFound() << std::endl;
+        return;
+    }
+
+    const qint64 nbMatches = logFilteredData_->getNbLine();
+    for ( qint64 i = 0; i < nbMatches; i += nbLinesPrinted ) {
+        const QStringList lines = logFilteredData_->getLines( i,
+                (int) qMin<qint64>( nbLinesPrinted, nbMatches - i ) );
+        foreach ( const QString& line, lines )
+            std::cout << line.toLocal8Bit().constData() << '\n';
+    }
+
+    std::cout.flush();
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEADLESSSEARCH_H
+#define HEADLESSSEARCH_H
+
+#include <memory>
+
+#include <QObject>
+#include <QString>
+#include <QEventLoop>
+
+#include "data/logfiltereddataworkerthread.h"
+
+class LogData;
+class LogFilteredData;
+
+// Searches a file without any GUI (used from the command line),
+// printing the matching lines or their number on the standard output.
+class HeadlessSearch : public QObject
+{
+  Q_OBJECT
+
+  public:
+    // The search is done with the passed mode (see LogFilteredData),
+    // maxMatches being only used by SearchFirstMatches.
+    HeadlessSearch( const QString& fileName, const QString& pattern,
+            SearchMode mode, int maxMatches );
+    ~HeadlessSearch();
+
+    // Load the file, search it and print the result, returns
+    // the exit status of the program (like grep, 0 if something
+    // matched, 1 if nothing matched, 2 in case of error).
+    int run();
+
+  private slots:
+    void loadingFinished( bool success );
+    void searchProgressed( int nbMatches, int progress );
+
+  private:
+    void printResult() const;
+
+    const QString fileName_;
+    const QString pattern_;
+    const SearchMode mode_;
+    const int maxMatches_;
+
+    std::unique_ptr<LogData> logData_;
+    std::unique_ptr<LogFilteredData> logFilteredData_;
+
+    QEventLoop eventLoop_;
+    int exitStatus_;
+};
+
+#endif
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements HistogramWidget, the distribution of the matches
+// displayed above the filtered view.
+
+#include <QPainter>
+#include <QMouseEvent>
+#include <QHelpEvent>
+#include <QToolTip>
+
+#include "log.h"
+
+#include "histogramwidget.h"
+
+HistogramWidget::HistogramWidget( QWidget* parent ) :
+    QWidget( parent ), histogram_()
+{
+    linesInFile_ = 0;
+
+    setBackgroundRole( QPalette::Base );
+    setAutoFillBackground( true );
+    setSizePolicy( QSizePolicy::Expanding, QSizePolicy::Fixed );
+}
+
+void HistogramWidget::updateData( const MatchHistogram& histogram,
+        qint64 totalNbLine )
+{
+    histogram_   = histogram;
+    linesInFile_ = totalNbLine;
+
+    update();
+}
+
+void HistogramWidget::clear()
+{
+    histogram_.clear();
+
+    update();
+}
+
+QSize HistogramWidget::sizeHint() const
+{
+    return QSize( 100, 32 );
+}
+
+void HistogramWidget::paintEvent( QPaintEvent* )
+{
+    static const QColor bar_color("red");
+
+    QPainter painter( this );
+
+    painter.setPen( palette().color( QPalette::Mid ) );
+    painter.drawRect( 0, 0, width() - 1, height() - 1 );
+
+    const int maxCount = histogram_.maxCount();
+    if ( maxCount == 0 || linesInFile_ == 0 )
+        return;
+
+    const int maxHeight = height() - 2;
+    for ( int i = 0; i < histogram_.nbBuckets(); i++ ) {
+        const int count = histogram_.count( i );
+        if ( count == 0 )
+            continue;
+
+        const qint64 firstLine =
+            histogram_.firstLine() + i * histogram_.linesPerBucket();
+        const int left  = xFromFileLine( firstLine );
+        const int right = xFromFileLine( firstLine + histogram_.linesPerBucket() );
+        // A bucket with a single match must still be visible
+        const int barHeight = qMax( 1, count * maxHeight / maxCount );
+
+        painter.fillRect( left, height() - 1 - barHeight,
+                qMax( 1, right - left ), barHeight, bar_color );
+    }
+}
+
+void HistogramWidget::mousePressEvent( QMouseEvent* mouseEvent )
+{
+    if ( mouseEvent->button() == Qt::LeftButton && linesInFile_ > 0 ) {
+        const qint64 line = qMin( linesInFile_ - 1,
+                (qint64) mouseEvent->x() * linesInFile_ / qMax( width(), 1 ) );
+        const int bucket = bucketFromX( mouseEvent->x() );
+
+        LOG(logDEBUG) << "HistogramWidget::mousePressEvent line=" << line
+            << " bucket=" << bucket;
+
+        // Go to the beginning of the bar if there is one
+        if ( bucket >= 0 && histogram_.count( bucket ) > 0 )
+            emit lineClicked( histogram_.firstLine()
+                        + bucket * histogram_.linesPerBucket() );
+        else
+            emit lineClicked( line );
+    }
+}
+
+bool HistogramWidget::event( QEvent* event )
+{
+    if ( event->type() == QEvent::ToolTip ) {
+        QHelpEvent* helpEvent = static_cast<QHelpEvent*>( event );
+        const int bucket = bucketFromX( helpEvent->x() );
+
+        if ( bucket >= 0 ) {
+            const qint64 firstLine =
+                histogram_.firstLine() + bucket * histogram_.linesPerBucket();
+            const qint64 lastLine = qMin( linesInFile_,
+                    firstLine + histogram_.linesPerBucket() );
+            const int count = histogram_.count( bucket );
+            QToolTip::showText( helpEvent->globalPos(),
+                    tr("Lines %1 to %2: %3 match%4")
+                    .arg( firstLine + 1 ).arg( lastLine )
+                    .arg( count ).arg( count > 1 ? "es" : "" ) );
+        }
+        else {
+            QToolTip::hideText();
+            event->ignore();
+        }
+
+        return true;
+    }
+
+    return QWidget::event( event );
+}
+
+int HistogramWidget::bucketFromX( int x ) const
+{
+    if ( linesInFile_ == 0 || histogram_.isEmpty() )
+        return -1;
+
+    const qint64 line = (qint64) x * linesInFile_ / qMax( width(), 1 );
+    const qint64 bucket =
+        ( line - histogram_.firstLine() ) / histogram_.linesPerBucket();
+
+    if ( line >= histogram_.firstLine() && bucket < histogram_.nbBuckets() )
+        return bucket;
+    else
+        return -1;
+}
+
+int HistogramWidget::xFromFileLine( qint64 line ) const
+{
+    return (int) ( line * width() / linesInFile_ );
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HISTOGRAMWIDGET_H
+#define HISTOGRAMWIDGET_H
+
+#include <QWidget>
+
+#include "data/matchhistogram.h"
+
+// Displays the number of matches along the file as a bar chart,
+// the whole file being spread over the width of the widget.
+class HistogramWidget : public QWidget
+{
+  Q_OBJECT
+
+  public:
+    HistogramWidget( QWidget* parent = 0 );
+
+    // Display the passed histogram (copied) of a file of totalNbLine lines
+    void updateData( const MatchHistogram& histogram, qint64 totalNbLine );
+    // Remove the bars (no search)
+    void clear();
+
+    virtual QSize sizeHint() const;
+
+  protected:
+    void paintEvent( QPaintEvent* paintEvent );
+    void mousePressEvent( QMouseEvent* mouseEvent );
+    bool event( QEvent* event );
+
+  signals:
+    // Sent when the user click on the histogram, passing the first line
+    // of the bucket under the mouse.
+    void lineClicked( qint64 line );
+
+  private:
+    // Returns the bucket displayed at the passed x coordinate (or -1)
+    int bucketFromX( int x ) const;
+    int xFromFileLine( qint64 line ) const;
+
+    MatchHistogram histogram_;
+    qint64 linesInFile_;
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements LineRenderCache, used by AbstractLogView to avoid
+// matching every line on screen against the filters and the QuickFind
+// pattern at each repaint.
+
+#include "log.h"
+
+#include "linerendercache.h"
+
+const int LineRenderCache::maxPixmapBytes = 32 * 1024 * 1024;
+
+LineRenderCache::LineRenderCache() : lines_(), pixmaps_( maxPixmapBytes )
+{
+    dataGeneration_   = -1;
+    filterSetVersion_ = -1;
+    patternVersion_   = -1;
+}
+
+void LineRenderCache::setVersions( int dataGeneration, int filterSetVersion,
+        int patternVersion )
+{
+    if ( dataGeneration != dataGeneration_
+            || filterSetVersion != filterSetVersion_
+            || patternVersion != patternVersion_ ) {
+        LOG(logDEBUG) << "LineRenderCache: invalidated";
+
+        dataGeneration_   = dataGeneration;
+        filterSetVersion_ = filterSetVersion;
+        patternVersion_   = patternVersion;
+        clear();
+    }
+}
+
+const LineRenderCache::Attributes* LineRenderCache::find( qint64 line ) const
+{
+    QHash<qint64, Attributes>::const_iterator i = lines_.constFind( line );
+
+    if ( i != lines_.constEnd() )
+        return &( i.value() );
+    else
+        return NULL;
+}
+
+const LineRenderCache::Attributes* LineRenderCache::insert(
+        qint64 line, const Attributes& attributes )
+{
+    return &( lines_.insert( line, attributes ).value() );
+}
+
+const QPixmap* LineRenderCache::findPixmap( qint64 line,
+        const Style& style ) const
+{
+    const RenderedLine* rendered = pixmaps_.object( line );
+
+    if ( rendered != NULL && rendered->style == style )
+        return &( rendered->pixmap );
+    else
+        return NULL;
+}
+
+void LineRenderCache::insertPixmap( qint64 line, const Style& style,
+        const QPixmap& pixmap )
+{
+    const int cost = pixmap.width() * pixmap.height() * pixmap.depth() / 8;
+
+    pixmaps_.insert( line, new RenderedLine( style, pixmap ), cost );
+}
+
+void LineRenderCache::retain( qint64 first, qint64 last )
+{
+    QHash<qint64, Attributes>::iterator i = lines_.begin();
+    while ( i != lines_.end() ) {
+        if ( i.key() < first || i.key() > last )
+            i = lines_.erase( i );
+        else
+            ++i;
+    }
+}
+
+void LineRenderCache::forgetFrom( qint64 line )
+{
+    QHash<qint64, Attributes>::iterator i = lines_.begin();
+    while ( i != lines_.end() ) {
+        if ( i.key() >= line )
+            i = lines_.erase( i );
+        else
+            ++i;
+    }
+
+    foreach ( qint64 key, pixmaps_.keys() ) {
+        if ( key >= line )
+            pixmaps_.remove( key );
+    }
+}
+
+void LineRenderCache::clear()
+{
+    lines_.clear();
+    pixmaps_.clear();
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LINERENDERCACHE_H
+#define LINERENDERCACHE_H
+
+#include <QHash>
+#include <QCache>
+#include <QList>
+#include <QColor>
+#include <QPixmap>
+
+#include "quickfindpattern.h"
+
+// Keeps, for the lines recently displayed by a view, what is needed
+// to render them: the colours of the filter matching the line (if any)
+// and the QuickFind matches in it, so scrolling only evaluates the lines
+// coming into view.
+// It also keeps the images of the most recently drawn lines (up to
+// maxPixmapBytes), each with the style it has been drawn with.
+// The cache is emptied as soon as the data, the filters or the QuickFind
+// pattern change (see setVersions).
+//
+// This class is NOT thread-safe.
+class LineRenderCache
+{
+  public:
+    // Render attributes of a line
+    class Attributes {
+      public:
+        // Line not matching any filter
+        Attributes() : filtered_( false ), foreColor_(), backColor_(),
+            matches_() {}
+        // Line matching a filter with the passed colours
+        Attributes( const QColor& foreColor, const QColor& backColor ) :
+            filtered_( true ), foreColor_( foreColor ),
+            backColor_( backColor ), matches_() {}
+
+        // Returns whether the line matches a filter
+        // (the colours are only valid if it does)
+        bool isFiltered() const { return filtered_; }
+        const QColor& foreColor() const { return foreColor_; }
+        const QColor& backColor() const { return backColor_; }
+
+        // QuickFind matches in the (expanded) line
+        const QList<QuickFindMatch>& matches() const { return matches_; }
+        QList<QuickFindMatch>& matches() { return matches_; }
+
+      private:
+        bool filtered_;
+        QColor foreColor_;
+        QColor backColor_;
+        QList<QuickFindMatch> matches_;
+    };
+
+    // What the image of a line depends on, besides its attributes
+    class Style {
+      public:
+        Style( int firstCol, int nbCols, bool selected,
+                int selectionStart, int selectionEnd ) :
+            firstCol_( firstCol ), nbCols_( nbCols ), selected_( selected ),
+            selectionStart_( selectionStart ), selectionEnd_( selectionEnd )
+        {}
+
+        bool operator==( const Style& other ) const
+        {
+            return firstCol_ == other.firstCol_ && nbCols_ == other.nbCols_
+                && selected_ == other.selected_
+                && selectionStart_ == other.selectionStart_
+                && selectionEnd_ == other.selectionEnd_;
+        }
+
+      private:
+        int firstCol_;
+        int nbCols_;
+        bool selected_;
+        // Selected portion of the line, -1 if none
+        int selectionStart_;
+        int selectionEnd_;
+    };
+
+    // Maximum size of the images kept
+    static const int maxPixmapBytes;
+
+    LineRenderCache();
+
+    // Set the versions of the data (AbstractLogData::getLinesGeneration),
+    // filters (FilterSet::version) and QuickFind pattern
+    // (QuickFindPattern::version) the lines will be rendered with,
+    // the cache is emptied if any is different from the previous call.
+    void setVersions( int dataGeneration, int filterSetVersion,
+            int patternVersion );
+
+    // Returns the attributes of the passed line or NULL if not cached
+    // (pointer valid until the next non const call)
+    const Attributes* find( qint64 line ) const;
+    // Store the attributes of the passed line and returns a pointer to
+    // them (valid until the next non const call)
+    const Attributes* insert( qint64 line, const Attributes& attributes );
+
+    // Returns the image of the passed line if it has been drawn with
+    // the passed style, NULL if not.
+    // (pointer valid until the next non const call)
+    const QPixmap* findPixmap( qint64 line, const Style& style ) const;
+    // Store the image of the passed line, the least recently used
+    // are forgotten to make room.
+    void insertPixmap( qint64 line, const Style& style,
+            const QPixmap& pixmap );
+
+    // Forget the attributes of the lines out of the passed
+    // range (inclusive)
+    void retain( qint64 first, qint64 last );
+    // Forget the passed line and the ones after it (e.g. when the last
+    // line of the file is completed)
+    void forgetFrom( qint64 line );
+    // Forget everything (e.g. when the font changes)
+    void clear();
+
+  private:
+    struct RenderedLine {
+        RenderedLine( const Style& s, const QPixmap& p ) :
+            style( s ), pixmap( p ) {}
+
+        Style style;
+        QPixmap pixmap;
+    };
+
+    int dataGeneration_;
+    int filterSetVersion_;
+    int patternVersion_;
+
+    QHash<qint64, Attributes> lines_;
+    // The cost of an image is its size in bytes
+    QCache<qint64, RenderedLine> pixmaps_;
+};
+
+#endif
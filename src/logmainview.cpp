@@ -49,7 +49,7 @@ void LogMainView::useNewFiltering( LogFilteredData* filteredData )
         getOverview()->setFilteredData( filteredData_ );
 }
 
-AbstractLogView::LineType LogMainView::lineType( int lineNumber ) const
+AbstractLogView::LineType LogMainView::lineType( qint64 lineNumber ) const
 {
     if ( filteredData_ != NULL ) {
         LineType line_type;
@@ -35,15 +35,30 @@ using namespace std;
 #include "session.h"
 #include "mainwindow.h"
 #include "savedsearches.h"
+#include "headlesssearch.h"
 #include "log.h"
+#include "data/tracer.h"
 
 static void print_version();
+static bool is_headless( int argc, char *argv[] );
 
 int main(int argc, char *argv[])
 {
-    QApplication app(argc, argv);
+    // Qt removes its own options (-style, -platform...) from the command
+    // line, so the application is created before parsing it, without
+    // any display for a search from the command line.
+    const bool headless = is_headless( argc, argv );
+    std::unique_ptr<QCoreApplication> app( headless ?
+            new QCoreApplication( argc, argv ) :
+            new QApplication( argc, argv ) );
 
     string filename = "";
+    // Search from the command line (no GUI)
+    string search_pattern = "";
+    bool count_only = false;
+    int max_count = 0;
+    // Where the trace is saved on exit
+    string trace_file = "";
 
     TLogLevel logLevel = logWARNING;
 
@@ -53,6 +68,13 @@ int main(int argc, char *argv[])
             ("help,h", "print out program usage (this message)")
             ("version,v", "print glogg's version information")
             ("debug,d", "output more debug (include multiple times for more verbosity e.g. -dddd")
+            ("search,s", po::value<string>(),
+             "print the lines of the file matching the regular expression and exit, without starting the GUI")
+            ("count,c", "with --search, only print the number of matching lines")
+            ("max-count,m", po::value<int>(),
+             "with --search, stop after this number of matching lines")
+            ("trace", po::value<string>(),
+             "record what glogg does and save it to this file on exit (Chrome trace format)")
             ;
         po::options_description desc_hidden("Hidden options");
         // For -dd, -ddd...
@@ -102,6 +124,21 @@ int main(int argc, char *argv[])
 
         if ( vm.count("input-file") )
             filename = vm["input-file"].as<string>();
+
+        if ( vm.count("trace") )
+            trace_file = vm["trace"].as<string>();
+
+        if ( vm.count("search") ) {
+            search_pattern = vm["search"].as<string>();
+            count_only = vm.count("count");
+            if ( vm.count("max-count") )
+                max_count = vm["max-count"].as<int>();
+
+            if ( filename.empty() ) {
+                cerr << "--search needs a file to search" << endl;
+                return 2;
+            }
+        }
     }
     catch(exception& e) {
         cerr << "Option processing error: " << e.what() << endl;
@@ -118,6 +155,27 @@ int main(int argc, char *argv[])
 
     FILELog::setReportingLevel( logLevel );
 
+    if ( ! trace_file.empty() )
+        Tracer::setEnabled( true );
+
+    if ( ! search_pattern.empty() ) {
+        // No display is needed, nor any settings
+        SearchMode mode = SearchAllMatches;
+        if ( count_only )
+            mode = SearchCountOnly;
+        else if ( max_count > 0 )
+            mode = SearchFirstMatches;
+
+        HeadlessSearch search( QString::fromStdString( filename ),
+                QString::fromStdString( search_pattern ), mode, max_count );
+        const int result = search.run();
+
+        if ( ! trace_file.empty() )
+            Tracer::save( QString::fromStdString( trace_file ) );
+
+        return result;
+    }
+
     // Register the configuration items
     GetPersistentInfo().migrateAndInit();
     GetPersistentInfo().registerPersistable(
@@ -141,7 +199,30 @@ int main(int argc, char *argv[])
     mw.show();
     mw.reloadSession();
     mw.loadInitialFile( QString::fromStdString( filename ) );
-    return app.exec();
+    const int result = app->exec();
+
+    if ( ! trace_file.empty() )
+        Tracer::save( QString::fromStdString( trace_file ) );
+
+    return result;
+}
+
+// Whether a search without GUI is asked for, looking for --search
+// before the command line is parsed.
+static bool is_headless( int argc, char *argv[] )
+{
+    for ( int i = 1; i < argc; i++ ) {
+        const string arg = argv[i];
+
+        if ( arg == "--" )
+            break;
+        if ( arg == "-s" || arg == "--search" || arg == "-search"
+                || arg.compare( 0, 9, "--search=" ) == 0
+                || arg.compare( 0, 8, "-search=" ) == 0 )
+            return true;
+    }
+
+    return false;
 }
 
 static void print_version()
@@ -37,6 +37,7 @@
 #include <QFileDialog>
 #include <QClipboard>
 #include <QMessageBox>
+#include <QInputDialog>
 #include <QCloseEvent>
 #include <QDragEnterEvent>
 #include <QMimeData>
@@ -51,6 +52,7 @@
 #include "crawlerwidget.h"
 #include "filtersdialog.h"
 #include "optionsdialog.h"
+#include "diagnosticsdialog.h"
 #include "persistentinfo.h"
 #include "menuactiontooltipbehavior.h"
 #include "tabbedcrawlerwidget.h"
@@ -103,8 +105,8 @@ MainWindow::MainWindow( std::unique_ptr<Session> session ) :
     // Actions from the CrawlerWidget
     signalMux_.connect( SIGNAL( followDisabled() ),
             this, SLOT( disableFollow() ) );
-    signalMux_.connect( SIGNAL( updateLineNumber( int ) ),
-            this, SLOT( lineNumberHandler( int ) ) );
+    signalMux_.connect( SIGNAL( updateLineNumber( qint64 ) ),
+            this, SLOT( lineNumberHandler( qint64 ) ) );
 
     // Register for progress status bar
     signalMux_.connect( SIGNAL( loadingProgressed( int ) ),
@@ -235,12 +237,24 @@ void MainWindow::createActions()
     connect( findAction, SIGNAL(triggered()),
             this, SLOT( find() ) );
 
+    goToTimeAction = new QAction(tr("Go to &time..."), this);
+    goToTimeAction->setShortcut(tr("Ctrl+T"));
+    goToTimeAction->setStatusTip(tr("Go to the first line logged at a given time"));
+    connect( goToTimeAction, SIGNAL(triggered()),
+            this, SLOT( goToTime() ) );
+
     overviewVisibleAction = new QAction( tr("Matches &overview"), this );
     overviewVisibleAction->setCheckable( true );
     overviewVisibleAction->setChecked( config->isOverviewVisible() );
     connect( overviewVisibleAction, SIGNAL( toggled( bool ) ),
             this, SLOT( toggleOverviewVisibility( bool )) );
 
+    histogramVisibleAction = new QAction( tr("Matches &histogram"), this );
+    histogramVisibleAction->setCheckable( true );
+    histogramVisibleAction->setChecked( config->isHistogramVisible() );
+    connect( histogramVisibleAction, SIGNAL( toggled( bool ) ),
+            this, SLOT( toggleHistogramVisibility( bool )) );
+
     lineNumbersVisibleInMainAction =
         new QAction( tr("Line &numbers in main view"), this );
     lineNumbersVisibleInMainAction->setCheckable( true );
@@ -279,6 +293,10 @@ void MainWindow::createActions()
     optionsAction->setStatusTip(tr("Show the Options box"));
     connect( optionsAction, SIGNAL(triggered()), this, SLOT(options()) );
 
+    diagnosticsAction = new QAction(tr("&Diagnostics..."), this);
+    diagnosticsAction->setStatusTip(tr("Show the performance counters"));
+    connect( diagnosticsAction, SIGNAL(triggered()), this, SLOT(diagnostics()) );
+
     aboutAction = new QAction(tr("&About"), this);
     aboutAction->setStatusTip(tr("Show the About box"));
     connect( aboutAction, SIGNAL(triggered()), this, SLOT(about()) );
@@ -306,9 +324,11 @@ void MainWindow::createMenus()
     editMenu->addAction( selectAllAction );
     editMenu->addSeparator();
     editMenu->addAction( findAction );
+    editMenu->addAction( goToTimeAction );
 
     viewMenu = menuBar()->addMenu( tr("&View") );
     viewMenu->addAction( overviewVisibleAction );
+    viewMenu->addAction( histogramVisibleAction );
     viewMenu->addSeparator();
     viewMenu->addAction( lineNumbersVisibleInMainAction );
     viewMenu->addAction( lineNumbersVisibleInFilteredAction );
@@ -321,6 +341,7 @@ void MainWindow::createMenus()
     toolsMenu->addAction( filtersAction );
     toolsMenu->addSeparator();
     toolsMenu->addAction( optionsAction );
+    toolsMenu->addAction( diagnosticsAction );
 
     menuBar()->addSeparator();
 
@@ -411,6 +432,30 @@ void MainWindow::find()
     displayQuickFindBar( QuickFindMux::Forward );
 }
 
+// Ask the user for a time and jump to it in the current file
+void MainWindow::goToTime()
+{
+    CrawlerWidget* current = currentCrawlerWidget();
+
+    if ( ! current )
+        return;
+
+    if ( ! current->hasTimestamps() ) {
+        QMessageBox::information( this, tr("Go to time"),
+                tr("No timestamp has been recognised in this file.") );
+        return;
+    }
+
+    bool ok;
+    const QString time = QInputDialog::getText( this, tr("Go to time"),
+            tr("Time (e.g. 14:32:05 or 2014-03-01 14:32:05):"),
+            QLineEdit::Normal, QString(), &ok );
+
+    if ( ok && ! time.isEmpty() && ! current->goToTime( time ) )
+        QMessageBox::warning( this, tr("Go to time"),
+                tr("Cannot understand the time \"%1\".").arg( time ) );
+}
+
 // Opens the 'Filters' dialog box
 void MainWindow::filters()
 {
@@ -420,6 +465,13 @@ void MainWindow::filters()
     signalMux_.disconnect(&dialog, SIGNAL( optionsChanged() ), SLOT( applyConfiguration() ));
 }
 
+// Opens the 'Diagnostics' dialog box.
+void MainWindow::diagnostics()
+{
+    DiagnosticsDialog dialog(this);
+    dialog.exec();
+}
+
 // Opens the 'Options' modal dialog box
 void MainWindow::options()
 {
@@ -455,6 +507,14 @@ void MainWindow::toggleOverviewVisibility( bool isVisible )
     emit optionsChanged();
 }
 
+void MainWindow::toggleHistogramVisibility( bool isVisible )
+{
+    std::shared_ptr<Configuration> config =
+        Persistent<Configuration>( "settings" );
+    config->setHistogramVisible( isVisible );
+    emit optionsChanged();
+}
+
 void MainWindow::toggleMainLineNumbersVisibility( bool isVisible )
 {
     std::shared_ptr<Configuration> config =
@@ -476,7 +536,7 @@ void MainWindow::disableFollow()
     followAction->setChecked( false );
 }
 
-void MainWindow::lineNumberHandler( int line )
+void MainWindow::lineNumberHandler( qint64 line )
 {
     // The line number received is the internal (starts at 0)
     lineNbField->setText( tr( "Line %1" ).arg( line + 1 ) );
@@ -65,13 +65,16 @@ class MainWindow : public QMainWindow
     void selectAll();
     void copy();
     void find();
+    void goToTime();
     void filters();
     void options();
+    void diagnostics();
     void about();
     void aboutQt();
 
     // Change the view settings
     void toggleOverviewVisibility( bool isVisible );
+    void toggleHistogramVisibility( bool isVisible );
     void toggleMainLineNumbersVisibility( bool isVisible );
     void toggleFilteredLineNumbersVisibility( bool isVisible );
 
@@ -80,7 +83,7 @@ class MainWindow : public QMainWindow
 
     // Update the line number displayed in the status bar.
     // Must be passed as the internal (starts at 0) line number.
-    void lineNumberHandler( int line );
+    void lineNumberHandler( qint64 line );
 
     // Instructs the widget to update the loading progress gauge
     void updateLoadingProgress( int progress );
@@ -148,7 +151,9 @@ class MainWindow : public QMainWindow
     QAction *copyAction;
     QAction *selectAllAction;
     QAction *findAction;
+    QAction *goToTimeAction;
     QAction *overviewVisibleAction;
+    QAction *histogramVisibleAction;
     QAction *lineNumbersVisibleInMainAction;
     QAction *lineNumbersVisibleInFilteredAction;
     QAction *followAction;
@@ -156,6 +161,7 @@ class MainWindow : public QMainWindow
     QAction *stopAction;
     QAction *filtersAction;
     QAction *optionsAction;
+    QAction *diagnosticsAction;
     QAction *aboutAction;
     QAction *aboutQtAction;
 
@@ -27,13 +27,13 @@
 // Contains the line number the mark is identifying.
 class Mark {
   public:
-    Mark( int line ) { lineNumber_ = line; };
+    Mark( qint64 line ) { lineNumber_ = line; };
 
     // Accessors
-    int lineNumber() const { return lineNumber_; }
+    qint64 lineNumber() const { return lineNumber_; }
 
   private:
-    int lineNumber_;
+    qint64 lineNumber_;
 };
 
 // A list of marks, i.e. line numbers optionally associated to an
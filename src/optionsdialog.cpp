@@ -32,6 +32,7 @@ OptionsDialog::OptionsDialog( QWidget* parent ) : QDialog(parent)
 
     setupFontList();
     setupRegexp();
+    setupPolling();
 
     connect(buttonBox, SIGNAL( clicked( QAbstractButton* ) ),
             this, SLOT( onButtonBoxClicked( QAbstractButton* ) ) );
@@ -73,6 +74,17 @@ void OptionsDialog::setupRegexp()
     quickFindSearchBox->addItems( regexpTypes );
 }
 
+// Populate the polling ComboBox (in the order of FilePollingMode)
+void OptionsDialog::setupPolling()
+{
+    QStringList pollingModes;
+
+    pollingModes << tr("On network filesystems")
+        << tr("Always") << tr("Never");
+
+    pollingBox->addItems( pollingModes );
+}
+
 // Enable/disable the QuickFind options depending on the state
 // of the "incremental" checkbox.
 void OptionsDialog::setupIncremental()
@@ -123,6 +135,10 @@ void OptionsDialog::updateDialogFromConfig()
             getRegexpIndex( config->quickfindRegexpType() ) );
 
     incrementalCheckBox->setChecked( config->isQuickfindIncremental() );
+    searchAsYouTypeCheckBox->setChecked( config->isSearchAsYouType() );
+    searchIndexCheckBox->setChecked( config->isSearchIndexEnabled() );
+    refreshRateBox->setValue( config->maxRefreshRate() );
+    pollingBox->setCurrentIndex( static_cast<int>( config->pollingMode() ) );
 }
 
 //
@@ -160,6 +176,11 @@ void OptionsDialog::updateConfigFromDialog()
     config->setQuickfindRegexpType(
             getRegexpTypeFromIndex( quickFindSearchBox->currentIndex() ) );
     config->setQuickfindIncremental( incrementalCheckBox->isChecked() );
+    config->setSearchAsYouType( searchAsYouTypeCheckBox->isChecked() );
+    config->setSearchIndexEnabled( searchIndexCheckBox->isChecked() );
+    config->setMaxRefreshRate( refreshRateBox->value() );
+    config->setPollingMode( static_cast<FilePollingMode>(
+                pollingBox->currentIndex() ) );
 
     emit optionsChanged();
 }
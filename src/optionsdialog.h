@@ -53,6 +53,7 @@ class OptionsDialog : public QDialog, public Ui::OptionsDialog
   private:
     void setupFontList();
     void setupRegexp();
+    void setupPolling();
     void setupIncremental();
 
     int getRegexpIndex( SearchRegexpType syntax ) const;
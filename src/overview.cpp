@@ -24,10 +24,12 @@
 #include "log.h"
 
 #include "data/logfiltereddata.h"
+#include "data/tracer.h"
 
 #include "overview.h"
 
-Overview::Overview() : matchLines_(), markLines_()
+Overview::Overview() : quickFindMatches_(), matchLines_(), markLines_(),
+    quickFindLines_()
 {
     logFilteredData_ = NULL;
     linesInFile_     = 0;
@@ -35,6 +37,7 @@ Overview::Overview() : matchLines_(), markLines_()
     nbLines_         = 0;
     height_          = 0;
     dirty_           = true;
+    quickFindDirty_  = false;
     visible_         = false;
 }
 
@@ -47,7 +50,7 @@ void Overview::setFilteredData( const LogFilteredData* logFilteredData )
     logFilteredData_ = logFilteredData;
 }
 
-void Overview::updateData( int totalNbLine )
+void Overview::updateData( qint64 totalNbLine )
 {
     LOG(logDEBUG) << "OverviewWidget::updateData " << totalNbLine;
 
@@ -63,6 +66,10 @@ void Overview::updateView( int height )
 
         recalculatesLines();
     }
+    // Only the QuickFind matches have changed (cheaper)
+    else if ( quickFindDirty_ ) {
+        recalculatesQuickFindLines();
+    }
 }
 
 const QVector<Overview::WeightedLine>* Overview::getMatchLines() const
@@ -75,32 +82,37 @@ const QVector<Overview::WeightedLine>* Overview::getMarkLines() const
     return &markLines_;
 }
 
+const QVector<Overview::WeightedLine>* Overview::getQuickFindLines() const
+{
+    return &quickFindLines_;
+}
+
 std::pair<int,int> Overview::getViewLines() const
 {
     int top = 0;
     int bottom = height_ - 1;
 
     if ( linesInFile_ > 0 ) {
-        top = (int)((qint64)topLine_ * height_ / linesInFile_);
-        bottom = (int)((qint64)top + nbLines_ * height_ / linesInFile_);
+        top = (int)(topLine_ * height_ / linesInFile_);
+        bottom = (int)(top + nbLines_ * height_ / linesInFile_);
     }
 
     return std::pair<int,int>(top, bottom);
 }
 
-int Overview::fileLineFromY( int position ) const
+qint64 Overview::fileLineFromY( int position ) const
 {
-    int line = (int)((qint64)position * linesInFile_ / height_);
+    qint64 line = (qint64)position * linesInFile_ / height_;
 
     return line;
 }
 
-int Overview::yFromFileLine( int file_line ) const
+int Overview::yFromFileLine( qint64 file_line ) const
 {
     int position = 0;
 
     if ( linesInFile_ > 0 )
-        position =  (int)((qint64)file_line * height_ / linesInFile_);
+        position =  (int)(file_line * height_ / linesInFile_);
 
     return position;
 }
@@ -109,40 +121,86 @@ int Overview::yFromFileLine( int file_line ) const
 void Overview::recalculatesLines()
 {
     LOG(logDEBUG) << "OverviewWidget::recalculatesLines";
+    TraceScope trace( "Overview::recalculatesLines" );
 
     if ( logFilteredData_ != NULL ) {
-        matchLines_.clear();
-        markLines_.clear();
+        densityLines( logFilteredData_->getMatchHistogram(), &matchLines_ );
 
-        for ( int i = 0; i < logFilteredData_->getNbLine(); i++ ) {
-            LogFilteredData::FilteredLineType line_type =
-                logFilteredData_->filteredLineTypeByIndex( i );
-            int line = (int) logFilteredData_->getMatchingLineNumber( i );
-            int position = (int)( (qint64)line * height_ / linesInFile_ );
-            if ( line_type == LogFilteredData::Match ) {
-                if ( ( ! matchLines_.isEmpty() ) && matchLines_.last().position() == position ) {
-                    // If the line is already there, we increase its weight
-                    matchLines_.last().load();
-                }
-                else {
-                    // If not we just add it
-                    matchLines_.append( WeightedLine( position ) );
-                }
+        // The marks are few, they are placed individually
+        markLines_.clear();
+        for ( int i = 0; i < logFilteredData_->getNbMarks(); i++ ) {
+            if ( linesInFile_ <= 0 )
+                break;
+
+            const qint64 line = logFilteredData_->getMarkedLineNumber( i );
+            const int position = (int)( line * height_ / linesInFile_ );
+            if ( ( ! markLines_.isEmpty() ) && markLines_.last().position() == position ) {
+                // If the line is already there, we increase its weight
+                markLines_.last().load();
             }
             else {
-                if ( ( ! markLines_.isEmpty() ) && markLines_.last().position() == position ) {
-                    // If the line is already there, we increase its weight
-                    markLines_.last().load();
-                }
-                else {
-                    // If not we just add it
-                    markLines_.append( WeightedLine( position ) );
-                }
+                // If not we just add it
+                markLines_.append( WeightedLine( position ) );
             }
         }
     }
     else
         LOG(logERROR) << "Overview::recalculatesLines: logFilteredData_ == NULL";
 
+    recalculatesQuickFindLines();
+
     dirty_ = false;
 }
+
+void Overview::recalculatesQuickFindLines()
+{
+    densityLines( quickFindMatches_, &quickFindLines_ );
+    quickFindDirty_ = false;
+}
+
+// Convert a histogram to one line per pixel containing matches,
+// darker where the matches are denser.
+void Overview::densityLines( const MatchHistogram& histogram,
+        QVector<WeightedLine>* lines ) const
+{
+    lines->clear();
+
+    if ( histogram.isEmpty() || linesInFile_ <= 0 || height_ <= 0 )
+        return;
+
+    // Number of matches per pixel, a bucket taller than a pixel
+    // is spread evenly over its pixels.
+    QVector<double> density( height_, 0.0 );
+    const qint64 linesPerBucket = histogram.linesPerBucket();
+    for ( int i = 0; i < histogram.nbBuckets(); i++ ) {
+        const int count = histogram.count( i );
+        if ( count == 0 )
+            continue;
+
+        const qint64 first = histogram.firstLine() + i * linesPerBucket;
+        const qint64 last  = qMin<qint64>( first + linesPerBucket,
+                linesInFile_ ) - 1;
+        if ( last < first )
+            break;
+
+        const int top    = qMin<qint64>( first * height_ / linesInFile_,
+                height_ - 1 );
+        const int bottom = qMin<qint64>( last * height_ / linesInFile_,
+                height_ - 1 );
+        const double perPixel = (double) count / ( bottom - top + 1 );
+        for ( int y = top; y <= bottom; y++ )
+            density[y] += perPixel;
+    }
+
+    // A pixel with at least one match is always drawn, then each order of
+    // magnitude makes it darker.
+    for ( int y = 0; y < height_; y++ ) {
+        if ( density[y] <= 0.0 )
+            continue;
+
+        WeightedLine line( y );
+        for ( double d = density[y]; d >= 10.0; d /= 10.0 )
+            line.load();
+        lines->append( line );
+    }
+}
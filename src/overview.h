@@ -23,11 +23,16 @@
 #include <QList>
 #include <QVector>
 
+#include "data/matchhistogram.h"
+
 class LogFilteredData;
 
 // Class implementing the logic behind the matches overview bar.
 // This class converts the matches found in a LogFilteredData in
 // a screen dependent set of coloured lines, which is cached.
+// The matches are taken from the histogram the search maintains, so
+// the cost of an update depends on the height, not on the number of
+// matches.
 // This class is not a UI class, actual display is left to the client.
 //
 // This class is NOT thread-safe.
@@ -61,12 +66,16 @@ class Overview
     // Signal the overview its attached LogFilteredData has been changed and
     // the overview must be updated with the provided total number
     // of line of the file.
-    void updateData( int totalNbLine );
+    void updateData( qint64 totalNbLine );
+    // Set the matches of QuickFind to show, as a number of matches per
+    // bucket of lines (drawn at the resolution of the overview).
+    void setQuickFindMatches( const MatchHistogram& histogram )
+    { quickFindMatches_ = histogram; quickFindDirty_ = true; }
     // Set the visibility flag of this overview.
     void setVisible( bool visible ) { visible_ = visible; dirty_ = visible; }
 
     // Update the current position in the file (to draw the view line)
-    void updateCurrentPosition( int firstLine, int lastLine )
+    void updateCurrentPosition( qint64 firstLine, qint64 lastLine )
     { topLine_ = firstLine; nbLines_ = lastLine - firstLine; }
 
     // Returns weither this overview is visible.
@@ -80,34 +89,47 @@ class Overview
     // Returns a list of lines (between 0 and 'height') representing marks.
     // (pointer returned is valid until next call to update*()
     const QVector<WeightedLine>* getMarkLines() const;
+    // Returns a list of lines (between 0 and 'height') representing
+    // the density of QuickFind matches.
+    // (pointer returned is valid until next call to update*()
+    const QVector<WeightedLine>* getQuickFindLines() const;
     // Return a pair of lines (between 0 and 'height') representing the current view.
     std::pair<int,int> getViewLines() const;
 
     // Return the line number corresponding to the passed overview y coordinate.
-    int fileLineFromY( int y ) const;
+    qint64 fileLineFromY( int y ) const;
     // Return the y coordinate corresponding to the passed line number.
-    int yFromFileLine( int file_line ) const;
+    int yFromFileLine( qint64 file_line ) const;
 
   private:
     // List of matches associated with this Overview.
     const LogFilteredData* logFilteredData_;
     // Total number of lines in the file.
-    int linesInFile_;
+    qint64 linesInFile_;
     // Whether the overview is visible.
     bool visible_;
     // First and last line currently viewed.
-    int topLine_;
-    int nbLines_;
+    qint64 topLine_;
+    qint64 nbLines_;
     // Current height of view window.
     int height_;
     // Does the cache (matchesLines, markLines) need to be recalculated.
     int dirty_;
+    // Matches of QuickFind, per bucket of lines, and whether they
+    // need to be converted again (quickFindLines_).
+    MatchHistogram quickFindMatches_;
+    bool quickFindDirty_;
 
     // List of lines representing matches and marks (are shared with the client)
     QVector<WeightedLine> matchLines_;
     QVector<WeightedLine> markLines_;
+    QVector<WeightedLine> quickFindLines_;
 
     void recalculatesLines();
+    void recalculatesQuickFindLines();
+    // Convert a histogram to one line per pixel containing matches
+    void densityLines( const MatchHistogram& histogram,
+            QVector<WeightedLine>* lines ) const;
 };
 
 #endif
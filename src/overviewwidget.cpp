@@ -155,6 +155,7 @@ void OverviewWidget::paintEvent( QPaintEvent* paintEvent )
 
     static const QColor match_color("red");
     static const QColor mark_color("dodgerblue");
+    static const QColor quickfind_color("goldenrod");
 
     static const QPixmap highlight_pixmap[] = {
         QPixmap( highlight_xpm[0] ),
@@ -176,6 +177,15 @@ void OverviewWidget::paintEvent( QPaintEvent* paintEvent )
         painter.setPen( palette().color(QPalette::Text) );
         painter.drawLine( 0, 0, 0, height() );
 
+        // The 'QuickFind' lines, below the others
+        painter.setPen( quickfind_color );
+        foreach (Overview::WeightedLine line, *(overview_->getQuickFindLines()) ) {
+            painter.setOpacity( ( 1.0 / Overview::WeightedLine::WEIGHT_STEPS )
+                   * ( line.weight() + 1 ) );
+            painter.drawLine( 1 + LINE_MARGIN,
+                    line.position(), width() - LINE_MARGIN - 1, line.position() );
+        }
+
         // The 'match' lines
         painter.setPen( match_color );
         foreach (Overview::WeightedLine line, *(overview_->getMatchLines()) ) {
@@ -235,7 +245,7 @@ void OverviewWidget::mouseMoveEvent( QMouseEvent* mouseEvent )
 
 void OverviewWidget::handleMousePress( int position )
 {
-    int line = overview_->fileLineFromY( position );
+    qint64 line = overview_->fileLineFromY( position );
     LOG(logDEBUG) << "OverviewWidget::handleMousePress y=" << position << " line=" << line;
     emit lineClicked( line );
 }
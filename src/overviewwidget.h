@@ -49,7 +49,7 @@ class OverviewWidget : public QWidget
 
   signals:
     // Sent when the user click on a line in the Overview.
-    void lineClicked( int line );
+    void lineClicked( qint64 line );
 
   private:
     // Constants
@@ -56,6 +56,39 @@ class QFNotificationReachedBegininningOfFile : public QFNotification
     }
 };
 
+class QFNotificationPatternTooSlow : public QFNotification
+{
+    QString message() const {
+        return QObject::tr("Pattern too slow to match, search stopped.");
+    }
+};
+
+class QFNotificationPatternRisky : public QFNotification
+{
+    QString message() const {
+        return QObject::tr("Pattern might be too slow to match, not searched.");
+    }
+};
+
+class QFNotificationMatchPosition : public QFNotification {
+  public:
+    // Constructor taking the rank of the match (from 1) and the number
+    // of matches, complete being false if more might be found.
+    QFNotificationMatchPosition( qint64 rank, qint64 nbMatches, bool complete )
+    { rank_ = rank; nbMatches_ = nbMatches; complete_ = complete; }
+
+    QString message() const {
+        if ( complete_ )
+            return QObject::tr("Match %1 of %2").arg( rank_ ).arg( nbMatches_ );
+        else
+            return QObject::tr("Match %1 of %2 so far").arg( rank_ ).arg( nbMatches_ );
+    }
+  private:
+    qint64 rank_;
+    qint64 nbMatches_;
+    bool complete_;
+};
+
 class QFNotificationProgress : public QFNotification {
   public:
     // Constructor taking the progress (in percent)
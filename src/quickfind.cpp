@@ -23,8 +23,6 @@
 // Search is started just after the selection and the selection is updated
 // if a match is found.
 
-#include <QApplication>
-
 #include "log.h"
 #include "quickfindpattern.h"
 #include "selection.h"
@@ -32,27 +30,7 @@
 
 #include "quickfind.h"
 
-void SearchingNotifier::reset()
-{
-    dotToDisplay_ = 0;
-    startTime_ = QTime::currentTime();
-}
-
-void SearchingNotifier::sendNotification( qint64 current_line, qint64 nb_lines )
-{
-    LOG( logDEBUG ) << "Emitting Searching....";
-    qint64 progress;
-    if ( current_line < 0 )
-        progress = ( nb_lines + current_line ) * 100 / nb_lines;
-    else
-        progress = current_line * 100 / nb_lines;
-    emit notify( QFNotificationProgress( progress ) );
-
-    QApplication::processEvents( QEventLoop::ExcludeUserInputEvents );
-    startTime_ = QTime::currentTime().addMSecs( -800 );
-}
-
-void QuickFind::LastMatchPosition::set( int line, int column )
+void QuickFind::LastMatchPosition::set( qint64 line, int column )
 {
     if ( ( line_ == -1 ) ||
             ( ( line <= line_ ) && ( column < column_ ) ) )
@@ -67,7 +45,7 @@ void QuickFind::LastMatchPosition::set( const FilePosition &position )
     set( position.line(), position.column() );
 }
 
-bool QuickFind::LastMatchPosition::isLater( int line, int column ) const
+bool QuickFind::LastMatchPosition::isLater( qint64 line, int column ) const
 {
     if ( line_ == -1 )
         return false;
@@ -84,7 +62,7 @@ bool QuickFind::LastMatchPosition::isLater( const FilePosition &position ) const
     return isLater( position.line(), position.column() );
 }
 
-bool QuickFind::LastMatchPosition::isSooner( int line, int column ) const
+bool QuickFind::LastMatchPosition::isSooner( qint64 line, int column ) const
 {
     if ( line_ == -1 )
         return false;
@@ -106,11 +84,24 @@ QuickFind::QuickFind( const AbstractLogData* const logData,
         const QuickFindPattern* const quickFindPattern ) :
     logData_( logData ), selection_( selection ),
     quickFindPattern_( quickFindPattern ),
-    lastMatch_(), firstMatch_(), searchingNotifier_(),
-    incrementalSearchStatus_()
+    lastMatch_(), firstMatch_(), incrementalSearchStatus_(),
+    workerThread_( logData )
 {
-    connect( &searchingNotifier_, SIGNAL( notify( const QFNotification& ) ),
-            this, SIGNAL( notify( const QFNotification& ) ) );
+    searchGeneration_ = 0;
+    searchDirection_  = None;
+
+    connect( &workerThread_, SIGNAL( searchProgressed( int, int ) ),
+            this, SLOT( handleSearchProgressed( int, int ) ) );
+    connect( &workerThread_, SIGNAL( matchFound( qint64, int, int, int ) ),
+            this, SLOT( handleMatchFound( qint64, int, int, int ) ) );
+    connect( &workerThread_, SIGNAL( noMatchFound( int ) ),
+            this, SLOT( handleNoMatchFound( int ) ) );
+    connect( &workerThread_, SIGNAL( searchAbandoned( int ) ),
+            this, SLOT( handleSearchAbandoned( int ) ) );
+    connect( &workerThread_, SIGNAL( indexUpdated() ),
+            this, SIGNAL( indexUpdated() ) );
+
+    workerThread_.start();
 }
 
 void QuickFind::incrementalSearchStop()
@@ -129,13 +120,15 @@ void QuickFind::incrementalSearchStop()
 void QuickFind::incrementalSearchAbort()
 {
     if ( incrementalSearchStatus_.isOngoing() ) {
+        stopSearch();
+
         // We reset the selection to what it was
         *selection_ = incrementalSearchStatus_.initialSelection();
         incrementalSearchStatus_ = IncrementalSearchStatus();
     }
 }
 
-qint64 QuickFind::incrementallySearchForward()
+void QuickFind::incrementallySearchForward()
 {
     LOG( logDEBUG ) << "QuickFind::incrementallySearchForward";
 
@@ -156,22 +149,10 @@ qint64 QuickFind::incrementallySearchForward()
                 *selection_ );
     }
 
-    qint64 line_found = doSearchForward( start_position );
-
-    if ( line_found >= 0 ) {
-        // We have found a result...
-        // ... the caller will jump to this line.
-        return line_found;
-    }
-    else {
-        // No result...
-        // ... we want the client to show the initial line.
-        selection_->clear();
-        return incrementalSearchStatus_.position().line();
-    }
+    doSearchForward( start_position );
 }
 
-qint64 QuickFind::incrementallySearchBackward()
+void QuickFind::incrementallySearchBackward()
 {
     LOG( logDEBUG ) << "QuickFind::incrementallySearchBackward";
 
@@ -192,172 +173,205 @@ qint64 QuickFind::incrementallySearchBackward()
                 *selection_ );
     }
 
-    qint64 line_found = doSearchBackward( start_position );
-
-    if ( line_found >= 0 ) {
-        // We have found a result...
-        // ... the caller will jump to this line.
-        return line_found;
-    }
-    else {
-        // No result...
-        // ... we want the client to show the initial line.
-        selection_->clear();
-        return incrementalSearchStatus_.position().line();
-    }
+    doSearchBackward( start_position );
 }
 
-qint64 QuickFind::searchForward()
+void QuickFind::searchForward()
 {
     incrementalSearchStatus_ = IncrementalSearchStatus();
 
     // Position where we start the search from
     FilePosition start_position = selection_->getNextPosition();
 
-    return doSearchForward( start_position );
+    doSearchForward( start_position );
 }
 
 
-qint64 QuickFind::searchBackward()
+void QuickFind::searchBackward()
 {
     incrementalSearchStatus_ = IncrementalSearchStatus();
 
     // Position where we start the search from
     FilePosition start_position = selection_->getPreviousPosition();
 
-    return doSearchBackward( start_position );
+    doSearchBackward( start_position );
+}
+
+void QuickFind::stopSearch()
+{
+    if ( searchDirection_ != None ) {
+        workerThread_.interrupt();
+        searchGeneration_ = 0;
+        searchDirection_  = None;
+
+        emit clearNotification();
+    }
 }
 
-// Internal implementation of forward search,
-// returns the line where the pattern is found or -1 if not found.
-// Parameters are the position the search shall start
-qint64 QuickFind::doSearchForward( const FilePosition &start_position )
+void QuickFind::getMatchHistogram( MatchHistogram* histogram ) const
 {
-    bool found = false;
-    int found_start_col;
-    int found_end_col;
+    histogram->clear();
 
-    if ( ! quickFindPattern_->isActive() )
-        return -1;
+    if ( quickFindPattern_->isActive() )
+        workerThread_.index().getHistogram( quickFindPattern_->getRegExp(),
+                logData_->getLinesGeneration(), histogram );
+}
 
-    // Optimisation: if we are already after the last match,
-    // we don't do any search at all.
-    if ( lastMatch_.isLater( start_position ) ) {
-        // Send a notification
-        emit notify( QFNotificationReachedEndOfFile() );
+void QuickFind::resetLimits()
+{
+    lastMatch_.reset();
+    firstMatch_.reset();
 
-        return -1;
-    }
+    workerThread_.buildIndex( quickFindPattern_->isActive() ?
+            quickFindPattern_->getRegExp() : QRegExp() );
+}
 
-    qint64 line = start_position.line();
-    LOG( logDEBUG ) << "Start searching at line " << line;
-    // We look at the rest of the first line
-    if ( quickFindPattern_->isLineMatching(
-                logData_->getExpandedLineString( line ),
-                start_position.column() ) ) {
-        quickFindPattern_->getLastMatch( &found_start_col, &found_end_col );
-        found = true;
-    }
-    else {
-        searchingNotifier_.reset();
-        // And then the rest of the file
-        qint64 nb_lines = logData_->getNbLine();
-        line++;
-        while ( line < nb_lines ) {
-            if ( quickFindPattern_->isLineMatching(
-                        logData_->getExpandedLineString( line ) ) ) {
-                quickFindPattern_->getLastMatch(
-                        &found_start_col, &found_end_col );
-                found = true;
-                break;
-            }
-            line++;
-
-            // See if we need to notify of the ongoing search
-            searchingNotifier_.ping( line, nb_lines );
-        }
-    }
+//
+// Slots
+//
+void QuickFind::handleSearchProgressed( int percent, int generation )
+{
+    if ( generation == searchGeneration_ )
+        emit notify( QFNotificationProgress( percent ) );
+}
 
-    if ( found ) {
-        selection_->selectPortion(
-                line, found_start_col, found_end_col );
+void QuickFind::handleMatchFound( qint64 line, int startColumn,
+        int endColumn, int generation )
+{
+    if ( generation != searchGeneration_ )
+        return;
 
-        // Clear any notification
-        emit clearNotification();
+    LOG( logDEBUG ) << "QuickFind match found at line " << line;
+
+    searchDirection_ = None;
 
-        return line;
+    selectMatch( line, startColumn, endColumn );
+}
+
+void QuickFind::handleNoMatchFound( int generation )
+{
+    if ( generation != searchGeneration_ )
+        return;
+
+    searchFailed();
+}
+
+void QuickFind::handleSearchAbandoned( int generation )
+{
+    if ( generation != searchGeneration_ )
+        return;
+
+    searchDirection_ = None;
+
+    emit notify( QFNotificationPatternTooSlow() );
+    incrementalSearchFailed();
+}
+
+//
+// Private functions
+//
+
+// Internal implementation of forward search, starts the search
+// from the position passed in the worker thread.
+void QuickFind::doSearchForward( const FilePosition &start_position )
+{
+    // Whatever was searched before is not wanted anymore
+    stopSearch();
+
+    if ( ! quickFindPattern_->isActive() ) {
+        incrementalSearchFailed();
+        return;
     }
-    else {
-        // Update the position of the last match
-        FilePosition last_match_position = selection_->getPreviousPosition();
-        lastMatch_.set( last_match_position );
 
+    // Optimisation: if we are already after the last match,
+    // we don't do any search at all.
+    if ( lastMatch_.isLater( start_position ) ) {
         // Send a notification
         emit notify( QFNotificationReachedEndOfFile() );
+        incrementalSearchFailed();
 
-        return -1;
+        return;
     }
+
+    // The index might know the answer already
+    QuickFindIndex::Match match;
+    switch ( workerThread_.index().findNext(
+                quickFindPattern_->getRegExp(), logData_->getLinesGeneration(),
+                logData_->getNbLine(), start_position.line(),
+                start_position.column(), &match ) ) {
+        case QuickFindIndex::Found:
+            selectMatch( match.line(), match.startColumn(), match.endColumn() );
+            return;
+        case QuickFindIndex::NotFound:
+            searchDirection_ = Forward;
+            searchFailed();
+            return;
+        case QuickFindIndex::Unknown:
+            break;
+    }
+
+    LOG( logDEBUG ) << "Start searching at line " << start_position.line();
+
+    searchDirection_  = Forward;
+    searchGeneration_ = workerThread_.search(
+            quickFindPattern_->getRegExp(), start_position, false );
 }
 
-// Internal implementation of backward search,
-// returns the line where the pattern is found or -1 if not found.
-// Parameters are the position the search shall start
-qint64 QuickFind::doSearchBackward( const FilePosition &start_position )
+// Internal implementation of backward search, starts the search
+// from the position passed in the worker thread.
+void QuickFind::doSearchBackward( const FilePosition &start_position )
 {
-    bool found = false;
-    int start_col;
-    int end_col;
+    // Whatever was searched before is not wanted anymore
+    stopSearch();
 
-    if ( ! quickFindPattern_->isActive() )
-        return -1;
+    if ( ! quickFindPattern_->isActive() ) {
+        incrementalSearchFailed();
+        return;
+    }
 
     // Optimisation: if we are already before the first match,
     // we don't do any search at all.
     if ( firstMatch_.isSooner( start_position ) ) {
         // Send a notification
         emit notify( QFNotificationReachedBegininningOfFile() );
+        incrementalSearchFailed();
 
-        return -1;
+        return;
     }
 
-    qint64 line = start_position.line();
-    LOG( logDEBUG ) << "Start searching at line " << line;
-    // We look at the beginning of the first line
-    if (    ( start_position.column() > 0 )
-         && ( quickFindPattern_->isLineMatchingBackward(
-                 logData_->getExpandedLineString( line ),
-                 start_position.column() ) )
-       ) {
-        quickFindPattern_->getLastMatch( &start_col, &end_col );
-        found = true;
-    }
-    else {
-        searchingNotifier_.reset();
-        // And then the rest of the file
-        qint64 nb_lines = logData_->getNbLine();
-        line--;
-        while ( line >= 0 ) {
-            if ( quickFindPattern_->isLineMatchingBackward(
-                        logData_->getExpandedLineString( line ) ) ) {
-                quickFindPattern_->getLastMatch( &start_col, &end_col );
-                found = true;
-                break;
-            }
-            line--;
-
-            // See if we need to notify of the ongoing search
-            searchingNotifier_.ping( -line, nb_lines );
-        }
+    // The index might know the answer already
+    QuickFindIndex::Match match;
+    switch ( workerThread_.index().findPrevious(
+                quickFindPattern_->getRegExp(), logData_->getLinesGeneration(),
+                start_position.line(), start_position.column(),
+                &match ) ) {
+        case QuickFindIndex::Found:
+            selectMatch( match.line(), match.startColumn(), match.endColumn() );
+            return;
+        case QuickFindIndex::NotFound:
+            searchDirection_ = Backward;
+            searchFailed();
+            return;
+        case QuickFindIndex::Unknown:
+            break;
     }
 
-    if ( found )
-    {
-        selection_->selectPortion( line, start_col, end_col );
+    LOG( logDEBUG ) << "Start searching at line " << start_position.line();
 
-        // Clear any notification
-        emit clearNotification();
+    searchDirection_  = Backward;
+    searchGeneration_ = workerThread_.search(
+            quickFindPattern_->getRegExp(), start_position, true );
+}
+
+void QuickFind::searchFailed()
+{
+    if ( searchDirection_ == Forward ) {
+        // Update the position of the last match
+        FilePosition last_match_position = selection_->getPreviousPosition();
+        lastMatch_.set( last_match_position );
 
-        return line;
+        // Send a notification
+        emit notify( QFNotificationReachedEndOfFile() );
     }
     else {
         // Update the position of the first match
@@ -367,13 +381,38 @@ qint64 QuickFind::doSearchBackward( const FilePosition &start_position )
         // Send a notification
         LOG( logDEBUG ) << "QF: Send BOF notification.";
         emit notify( QFNotificationReachedBegininningOfFile() );
-
-        return -1;
     }
+
+    searchDirection_ = None;
+
+    incrementalSearchFailed();
 }
 
-void QuickFind::resetLimits()
+void QuickFind::selectMatch( qint64 line, int startColumn, int endColumn )
 {
-    lastMatch_.reset();
-    firstMatch_.reset();
+    selection_->selectPortion( line, startColumn, endColumn );
+
+    // Tell the user where the match is if the index knows
+    qint64 nbMatches;
+    bool complete;
+    const qint64 rank = workerThread_.index().rankOf(
+            quickFindPattern_->getRegExp(), logData_->getLinesGeneration(),
+            logData_->getNbLine(), line, startColumn, &nbMatches, &complete );
+    if ( rank >= 0 )
+        emit notify( QFNotificationMatchPosition(
+                    rank + 1, nbMatches, complete ) );
+    else
+        emit clearNotification();
+
+    emit searchFinished( line );
+}
+
+void QuickFind::incrementalSearchFailed()
+{
+    if ( incrementalSearchStatus_.isOngoing() ) {
+        // No result...
+        // ... we want the client to show the initial line.
+        selection_->clear();
+        emit searchFinished( incrementalSearchStatus_.position().line() );
+    }
 }
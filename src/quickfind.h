@@ -22,53 +22,23 @@
 
 #include <QObject>
 #include <QPoint>
-#include <QTime>
 
 #include "utils.h"
 #include "qfnotifications.h"
 #include "selection.h"
+#include "quickfindworkerthread.h"
 
 class QuickFindPattern;
 class AbstractLogData;
 class Portion;
 
-// Handle "long processing" notifications to the UI.
-// reset() shall be called at the beginning of the search
-// and then ping() should be called periodically during the processing.
-// The notify() signal should be forwarded to the UI.
-class SearchingNotifier : public QObject
-{
-  Q_OBJECT
-
-  public:
-    SearchingNotifier() {};
-
-    // Reset internal timers at the beiginning of the processing
-    void reset();
-    // Shall be called frequently during processing, send the notification
-    // and call the event loop when appropriate.
-    // Pass the current line number and total number of line so that
-    // a progress percentage is calculated and displayed.
-    // (line shall be negative if ging in reverse)
-    inline void ping( qint64 line, qint64 nb_lines ) {
-        if ( startTime_.msecsTo( QTime::currentTime() ) > 1000 )
-            sendNotification( line, nb_lines );
-    }
-
-  signals:
-    // Sent when the UI shall display a message to the user.
-    void notify( const QFNotification& message );
-
-  private:
-    void sendNotification( qint64 current_line, qint64 nb_lines );
-
-    QTime startTime_;
-    int dotToDisplay_;
-};
-
 // Represents a search made with Quick Find (without its results)
 // it keeps a pointer to a set of data and to a QuickFindPattern which
 // are used for the searches. (the caller retains ownership of both).
+// The searches are run in the background (QuickFindWorkerThread), their
+// result is sent by searchFinished() once the selection has been updated.
+// The matches are indexed in the background as well, the searches use
+// the index when it covers the part of the file searched.
 class QuickFind : public QObject
 {
   Q_OBJECT
@@ -82,12 +52,12 @@ class QuickFind : public QObject
     void setSearchStartPoint( QPoint startPoint );
 
     // Used for incremental searches
-    // Return the first occurence of the passed pattern from the starting
-    // point.  These searches don't use the QFP and don't change the
-    // starting point.
-    // TODO Update comment
-    qint64 incrementallySearchForward();
-    qint64 incrementallySearchBackward();
+    // Search the first occurence of the QFP from the point where the
+    // incremental search started, each new search superseding the
+    // previous one.  If nothing is found, the line where it started is
+    // sent back.
+    void incrementallySearchForward();
+    void incrementallySearchBackward();
 
     // Stop the currently ongoing incremental search, leave the selection
     // where it is if a match has been found, restore the old one
@@ -99,20 +69,22 @@ class QuickFind : public QObject
     // position/selection
     void incrementalSearchAbort();
 
-    // Used for 'repeated' (n/N) QF searches using the current direction
-    // Return the line of the first occurence of the QFP and
-    // update the selection. It returns -1 if nothing is found.
-    /*
-    int searchNext();
-    int searchPrevious();
-    */
+    // Used for 'repeated' (n/N) QF searches, search the next (previous)
+    // occurence of the QFP from the selection and select it.
+    void searchForward();
+    void searchBackward();
+
+    // Returns whether a search is running in the background.
+    bool isSearching() const { return searchDirection_ != None; }
+    // Interrupt the search in progress, if any.
+    void stopSearch();
 
-    // Idem but ignore the direction and always search in the
-    // specified direction
-    qint64 searchForward();
-    qint64 searchBackward();
+    // Copy the distribution in the file of the matches of the pattern,
+    // as far as they have been indexed (empty if the pattern is inactive).
+    void getMatchHistogram( MatchHistogram* histogram ) const;
 
-    // Make the object forget the 'no more match' flag.
+    // Make the object forget the 'no more match' flag and bring the index
+    // up to date, to be called when the pattern or the data change.
     void resetLimits();
 
   signals:
@@ -120,6 +92,20 @@ class QuickFind : public QObject
     void notify( const QFNotification& message );
     // Sent when the UI shall clear the notification.
     void clearNotification();
+    // Sent when a search is finished with the line to display:
+    // the match (which is now selected) or the line an unsuccessful
+    // incremental search started from.
+    void searchFinished( qint64 line );
+    // Sent when more matches have been indexed (see getMatchHistogram).
+    void indexUpdated();
+
+  private slots:
+    // Results from the worker thread
+    void handleSearchProgressed( int percent, int generation );
+    void handleMatchFound( qint64 line, int startColumn, int endColumn,
+            int generation );
+    void handleNoMatchFound( int generation );
+    void handleSearchAbandoned( int generation );
 
   private:
     enum QFDirection {
@@ -131,18 +117,18 @@ class QuickFind : public QObject
     class LastMatchPosition {
       public:
         LastMatchPosition() : line_( -1 ), column_( -1 ) {}
-        void set( int line, int column );
+        void set( qint64 line, int column );
         void set( const FilePosition& position );
         void reset() { line_ = -1; column_ = -1; }
         // Does the passed position come after the recorded one
-        bool isLater( int line, int column ) const;
+        bool isLater( qint64 line, int column ) const;
         bool isLater( const FilePosition& position ) const;
         // Does the passed position come before the recorded one
-        bool isSooner( int line, int column ) const;
+        bool isSooner( qint64 line, int column ) const;
         bool isSooner( const FilePosition& position ) const;
 
       private:
-        int line_;
+        qint64 line_;
         int column_;
     };
 
@@ -181,14 +167,25 @@ class QuickFind : public QObject
     LastMatchPosition lastMatch_;
     LastMatchPosition firstMatch_;
 
-    SearchingNotifier searchingNotifier_;
-
     // Incremental search status
     IncrementalSearchStatus incrementalSearchStatus_;
 
+    QuickFindWorkerThread workerThread_;
+    // Generation and direction of the search in progress
+    // (the results of the other ones are ignored)
+    int searchGeneration_;
+    QFDirection searchDirection_;
+
     // Private functions
-    qint64 doSearchForward( const FilePosition &start_position );
-    qint64 doSearchBackward( const FilePosition &start_position );
+    void doSearchForward( const FilePosition &start_position );
+    void doSearchBackward( const FilePosition &start_position );
+    // The search in progress has not found anything
+    void searchFailed();
+    // Show the start of the incremental search, if one is ongoing,
+    // as nothing has been found
+    void incrementalSearchFailed();
+    // Select the match and send the result
+    void selectMatch( qint64 line, int startColumn, int endColumn );
 };
 
 #endif
@@ -109,6 +109,11 @@ void QuickFindMux::setNewPattern(
     LOG(logDEBUG) << "QuickFindMux::setNewPattern";
     pattern_->changeSearchPattern( new_pattern, ignore_case );
 
+    if ( pattern_->isRisky() ) {
+        emit notify( QFNotificationPatternRisky() );
+        return;
+    }
+
     // If we must do an incremental search, we do it now
     if ( config->isQuickfindIncremental() ) {
         if ( auto searchable = getSearchableWidget() ) {
@@ -128,6 +133,11 @@ void QuickFindMux::confirmPattern(
 
     pattern_->changeSearchPattern( new_pattern, ignore_case );
 
+    if ( pattern_->isRisky() ) {
+        emit notify( QFNotificationPatternRisky() );
+        return;
+    }
+
     // if non-incremental, we perform the search now
     if ( ! config->isQuickfindIncremental() ) {
         searchNext();
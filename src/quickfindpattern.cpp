@@ -26,10 +26,13 @@
 
 #include "persistentinfo.h"
 #include "configuration.h"
+#include "data/regexpbudget.h"
 
 QuickFindPattern::QuickFindPattern() : QObject(), regexp_()
 {
-    active_ = false;
+    active_  = false;
+    risky_   = false;
+    version_ = 0;
 }
 
 void QuickFindPattern::changeSearchPattern( const QString& pattern )
@@ -51,11 +54,17 @@ void QuickFindPattern::changeSearchPattern( const QString& pattern )
     regexp_.setPattern( pattern );
     regexp_.setPatternSyntax( syntax );
 
-    if ( regexp_.isValid() && ( ! regexp_.isEmpty() ) )
+    // The lines are matched in the GUI thread (highlighting), where
+    // nothing could interrupt a catastrophic backtracking
+    risky_ = ( syntax == QRegExp::RegExp2 )
+        && RegExpBudget::isPatternRisky( pattern );
+
+    if ( regexp_.isValid() && ( ! regexp_.isEmpty() ) && ( ! risky_ ) )
         active_ = true;
     else
         active_ = false;
 
+    ++version_;
     emit patternUpdated();
 }
 
@@ -60,9 +60,16 @@ class QuickFindPattern : public QObject
 
     // Returns whether the search is active (i.e. valid and non empty regexp)
     bool isActive() const { return active_; }
+    // Returns whether the pattern has been refused (left inactive) because
+    // it might take forever to match (see RegExpBudget::isPatternRisky)
+    bool isRisky() const { return risky_; }
 
     // Return the text of the regex
     QString getPattern() const { return regexp_.pattern(); }
+    // Return a copy of the regex (e.g. for searching in another thread)
+    QRegExp getRegExp() const { return regexp_; }
+    // Returns a number which changes every time the pattern is changed
+    int version() const { return version_; }
 
     // Returns whether the passed line match the quick find search.
     // If so, it populate the passed list with the list of matches
@@ -88,7 +95,9 @@ class QuickFindPattern : public QObject
 
   private:
     bool active_;
+    bool risky_;
     QRegExp regexp_;
+    int version_;
 
     mutable int lastMatchStart_;
     mutable int lastMatchEnd_;
@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements QuickFindWorkerThread, the background part
+// of QuickFind.
+
+#include <QStringList>
+
+#include "log.h"
+#include "data/abstractlogdata.h"
+#include "data/regexpbudget.h"
+
+#include "quickfindworkerthread.h"
+
+const int QuickFindWorkerThread::nbLinesInBatch = 5000;
+
+namespace {
+    // Delay (ms) before the first progress is sent
+    const qint64 progressFirstDelay = 1000;
+    // Then delay between two progress notifications
+    const qint64 progressDelay      = 200;
+    // Minimum delay between two indexUpdated() signals
+    const qint64 indexUpdateDelay   = 500;
+}
+
+QuickFindWorkerThread::QuickFindWorkerThread( const AbstractLogData* logData )
+    : QThread(), mutex_(), searchRequestedCond_(), interruptRequested_(),
+    indexRegExp_(), index_(), indexUpdateTimer_(), progressTimer_()
+{
+    logData_          = logData;
+    terminate_        = false;
+    searchRequested_  = NULL;
+    generation_       = 0;
+    indexIdle_        = true;
+    indexRequest_     = 0;
+    nextProgressTime_ = 0;
+
+    indexUpdateTimer_.start();
+}
+
+QuickFindWorkerThread::~QuickFindWorkerThread()
+{
+    {
+        QMutexLocker locker( &mutex_ );
+        terminate_ = true;
+        interruptRequested_.set();
+        searchRequestedCond_.wakeAll();
+    }
+    wait();
+
+    delete searchRequested_;
+}
+
+int QuickFindWorkerThread::search( const QRegExp& regExp,
+        const FilePosition& start, bool backward )
+{
+    QMutexLocker locker( &mutex_ );  // to protect searchRequested_
+
+    LOG(logDEBUG) << "QuickFind search requested from line " << start.line();
+
+    // The new search supersedes everything
+    interruptRequested_.set();
+
+    delete searchRequested_;
+    searchRequested_ = new QuickFindSearch( regExp, start, backward,
+            ++generation_ );
+    searchRequestedCond_.wakeAll();
+
+    return generation_;
+}
+
+void QuickFindWorkerThread::interrupt()
+{
+    QMutexLocker locker( &mutex_ );  // to protect searchRequested_
+
+    LOG(logDEBUG) << "QuickFind interruption requested";
+
+    interruptRequested_.set();
+
+    delete searchRequested_;
+    searchRequested_ = NULL;
+}
+
+void QuickFindWorkerThread::buildIndex( const QRegExp& regExp )
+{
+    QMutexLocker locker( &mutex_ );
+
+    indexRegExp_ = regExp;
+    indexIdle_   = false;
+    ++indexRequest_;
+    searchRequestedCond_.wakeAll();
+}
+
+// This is the thread's main loop
+void QuickFindWorkerThread::run()
+{
+    QMutexLocker locker( &mutex_ );
+
+    forever {
+        while ( (terminate_ == false) && (searchRequested_ == NULL)
+                && indexIdle_ )
+            searchRequestedCond_.wait( &mutex_ );
+
+        if ( terminate_ )
+            return;      // We must die
+
+        interruptRequested_.clear();
+
+        // The mutex is released while we work so new requests can be
+        // queued without blocking the UI.
+        if ( searchRequested_ ) {
+            // Searches come first
+            QuickFindSearch* search = searchRequested_;
+            searchRequested_ = NULL;
+
+            locker.unlock();
+
+            doSearch( *search );
+            delete search;
+
+            locker.relock();
+        }
+        else {
+            const QRegExp regexp = indexRegExp_;
+            const int request    = indexRequest_;
+
+            locker.unlock();
+
+            const bool indexed = indexNextLines( regexp );
+
+            locker.relock();
+
+            // Wait for the next buildIndex() if the index is complete
+            // (unless it has been called in the meantime)
+            if ( ! indexed && request == indexRequest_ )
+                indexIdle_ = true;
+        }
+    }
+}
+
+void QuickFindWorkerThread::doSearch( const QuickFindSearch& search )
+{
+    // Our own copy, matching changes its state
+    QRegExp regexp = search.regExp();
+    const int generation = search.generation();
+    const bool backward = search.isBackward();
+
+    qint64 nbLines = logData_->getNbLine();
+    qint64 line = search.start().line();
+
+    if ( line < 0 || line >= nbLines ) {
+        emit noMatchFound( generation );
+        return;
+    }
+
+    progressTimer_.start();
+    nextProgressTime_ = progressFirstDelay;
+
+    RegExpBudget budget;
+
+    // We look at the rest of the first line
+    const int column = search.start().column();
+    int pos = -1;
+    if ( ! backward )
+        pos = regexp.indexIn( logData_->getExpandedLineString( line ), column );
+    else if ( column > 0 )
+        pos = regexp.lastIndexIn( logData_->getExpandedLineString( line ), column );
+
+    // And then the rest of the file, one batch at a time
+    while ( pos == -1 ) {
+        qint64 first;
+        int nbLinesToRead;
+        if ( ! backward ) {
+            // The file might have grown (or been reloaded)
+            nbLines = logData_->getNbLine();
+            first = line + 1;
+            nbLinesToRead = qMin<qint64>( nbLinesInBatch, nbLines - first );
+        }
+        else {
+            first = qMax<qint64>( 0, line - nbLinesInBatch );
+            nbLinesToRead = line - first;
+        }
+
+        if ( nbLinesToRead <= 0 )
+            break;
+
+        const QStringList lines = logData_->getExpandedLines( first, nbLinesToRead );
+        // Shorter if the data have been changed under our feet
+        if ( lines.size() < nbLinesToRead ) {
+            LOG(logDEBUG) << "QuickFind: lines disappeared, stopping";
+            break;
+        }
+
+        budget.startLine();
+        for ( int i = 0; i < nbLinesToRead; i++ ) {
+            if ( interruptRequested_ ) {
+                LOG(logDEBUG) << "QuickFind search interrupted";
+                return;
+            }
+
+            const int index = backward ? ( nbLinesToRead - 1 - i ) : i;
+            line = first + index;
+
+            pos = backward ? regexp.lastIndexIn( lines[index] ) :
+                regexp.indexIn( lines[index] );
+
+            if ( ! budget.lineDone( line ) ) {
+                emit searchAbandoned( generation );
+                return;
+            }
+            if ( pos != -1 )
+                break;
+        }
+
+        reportProgress( backward ? nbLines - line : line, nbLines, generation );
+    }
+
+    if ( interruptRequested_ )
+        return;
+
+    if ( pos != -1 )
+        emit matchFound( line, pos, pos + regexp.matchedLength() - 1,
+                generation );
+    else
+        emit noMatchFound( generation );
+}
+
+bool QuickFindWorkerThread::indexNextLines( const QRegExp& regExp )
+{
+    if ( regExp.isEmpty() || ! regExp.isValid() )
+        return false;
+
+    // The generation is read first, if the lines change afterwards
+    // the index is for an old generation and will be rebuilt.
+    const int dataGeneration = logData_->getLinesGeneration();
+    if ( ! index_.isFor( regExp, dataGeneration ) ) {
+        LOG(logDEBUG) << "QuickFind index reset";
+        index_.reset( regExp, dataGeneration );
+    }
+
+    const qint64 nbLines = logData_->getNbLine();
+    const qint64 first = index_.nbLinesIndexed();
+    const int nbLinesToRead = qMin<qint64>( nbLinesInBatch, nbLines - first );
+    if ( nbLinesToRead <= 0 )
+        return false;
+
+    const QStringList lines = logData_->getExpandedLines( first, nbLinesToRead );
+    if ( lines.size() < nbLinesToRead )
+        return false;
+
+    // Our own copy, matching changes its state
+    QRegExp regexp = regExp;
+    QVector<QuickFindIndex::Match> matches;
+    for ( int i = 0; i < nbLinesToRead; i++ ) {
+        // The batch is thrown away if interrupted
+        if ( interruptRequested_ )
+            return true;
+
+        int pos = 0;
+        while ( ( pos = regexp.indexIn( lines[i], pos ) ) != -1 ) {
+            const int length = regexp.matchedLength();
+            matches.append( QuickFindIndex::Match(
+                        first + i, pos, pos + length - 1 ) );
+            // Don't loop on empty matches
+            pos += qMax( length, 1 );
+        }
+    }
+
+    index_.append( matches, first + nbLinesToRead );
+
+    // Don't flood the UI
+    if ( first + nbLinesToRead >= nbLines
+            || indexUpdateTimer_.elapsed() > indexUpdateDelay ) {
+        emit indexUpdated();
+        indexUpdateTimer_.restart();
+    }
+
+    return true;
+}
+
+void QuickFindWorkerThread::reportProgress( qint64 position,
+        qint64 nbLines, int generation )
+{
+    if ( nbLines > 0 && progressTimer_.elapsed() > nextProgressTime_ ) {
+        emit searchProgressed( position * 100 / nbLines, generation );
+        nextProgressTime_ = progressTimer_.elapsed() + progressDelay;
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2014 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUICKFINDWORKERTHREAD_H
+#define QUICKFINDWORKERTHREAD_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QRegExp>
+#include <QElapsedTimer>
+
+#include "utils.h"
+#include "data/atomicflag.h"
+#include "data/quickfindindex.h"
+
+class AbstractLogData;
+
+// A QuickFind search to be run by the QuickFindWorkerThread, it keeps
+// a copy of the regexp so the pattern can be changed while it runs.
+class QuickFindSearch
+{
+  public:
+    QuickFindSearch( const QRegExp& regExp, const FilePosition& start,
+            bool backward, int generation )
+        : regexp_( regExp ), start_( start ),
+        backward_( backward ), generation_( generation ) {}
+
+    const QRegExp& regExp() const { return regexp_; }
+    FilePosition start() const { return start_; }
+    bool isBackward() const { return backward_; }
+    int generation() const { return generation_; }
+
+  private:
+    QRegExp regexp_;
+    FilePosition start_;
+    bool backward_;
+    int generation_;
+};
+
+// Run the QuickFind searches in a background thread so that searching
+// a big file doesn't freeze the UI.
+// The lines are read in batches (using the thread-safe getExpandedLines)
+// and every signal is tagged with the generation of the search sending it.
+// When it has no search to run, the thread builds the index of the
+// matches of the current pattern (see QuickFindIndex).
+// Note everything except the run() function is in the UI thread.
+class QuickFindWorkerThread : public QThread
+{
+  Q_OBJECT
+
+  public:
+    QuickFindWorkerThread( const AbstractLogData* logData );
+    ~QuickFindWorkerThread();
+
+    // Start searching the regexp from the passed position, superseding
+    // the search in progress (interrupted) and any pending one.
+    // The match is searched after the position (on the same line from its
+    // column), or before it if backward is true.
+    // Returns immediately with the generation of the new search.
+    int search( const QRegExp& regExp, const FilePosition& start,
+            bool backward );
+    // Interrupts the search in progress and drop any pending one,
+    // returns immediately.
+    void interrupt();
+    // Index the matches of the passed regexp when idle, continuing the
+    // index if it is for the same regexp and the data have only grown.
+    // An empty regexp stops the indexing.
+    void buildIndex( const QRegExp& regExp );
+
+    // Index of the matches (can be used from any thread)
+    const QuickFindIndex& index() const { return index_; }
+
+    // Number of lines read at once
+    static const int nbLinesInBatch;
+
+  signals:
+    // Sent periodically (once the search has taken more than a second)
+    // with the percentage of the file searched.
+    void searchProgressed( int percent, int generation );
+    // Sent when a match is found, the end column being included.
+    void matchFound( qint64 line, int startColumn, int endColumn,
+            int generation );
+    // Sent when the search has reached the end (or the beginning)
+    // of the file without finding anything.
+    void noMatchFound( int generation );
+    // Sent when the search has been abandoned because the regexp
+    // is too slow to match (see RegExpBudget).
+    void searchAbandoned( int generation );
+    // Sent from time to time while the index is built, and when
+    // it is complete.
+    void indexUpdated();
+
+  protected:
+    void run();
+
+  private:
+    // Run the search and send its outcome (nothing if interrupted).
+    void doSearch( const QuickFindSearch& search );
+    // Index the next batch of lines if needed, returns false if there
+    // was nothing to index.
+    bool indexNextLines( const QRegExp& regExp );
+    // Send the progress if enough time has passed since the last one,
+    // position being the number of lines searched.
+    void reportProgress( qint64 position, qint64 nbLines, int generation );
+
+    const AbstractLogData* logData_;
+
+    // Mutex to protect searchRequested_ and friends
+    QMutex mutex_;
+    QWaitCondition searchRequestedCond_;
+
+    // Set when the thread must die
+    bool terminate_;
+    // Next search to run (owned)
+    QuickFindSearch* searchRequested_;
+    // Generation of the latest search requested
+    int generation_;
+    // Set to stop the running search (or indexing)
+    AtomicFlag interruptRequested_;
+    // Regexp to index (empty if none)
+    QRegExp indexRegExp_;
+    // Set once the index is complete, until buildIndex() is called again
+    bool indexIdle_;
+    // Incremented by each buildIndex()
+    int indexRequest_;
+
+    QuickFindIndex index_;
+    // Time since the last indexUpdated()
+    QElapsedTimer indexUpdateTimer_;
+
+    // Progress reporting (only touched by the running search)
+    QElapsedTimer progressTimer_;
+    qint64 nextProgressTime_;
+};
+
+#endif
@@ -39,7 +39,7 @@ Selection::Selection()
     selectedRange_.endLine   = 0;
 }
 
-void Selection::selectPortion( int line, int start_column, int end_column )
+void Selection::selectPortion( qint64 line, int start_column, int end_column )
 {
     // First unselect any whole line or range
     selectedLine_ = -1;
@@ -50,7 +50,7 @@ void Selection::selectPortion( int line, int start_column, int end_column )
     selectedPartial_.endColumn   = qMax ( start_column, end_column );
 }
 
-void Selection::selectRange( int start_line, int end_line )
+void Selection::selectRange( qint64 start_line, qint64 end_line )
 {
     // First unselect any whole line and portion
     selectedLine_ = -1;
@@ -62,9 +62,9 @@ void Selection::selectRange( int start_line, int end_line )
     selectedRange_.firstLine = start_line;
 }
 
-void Selection::selectRangeFromPrevious( int line )
+void Selection::selectRangeFromPrevious( qint64 line )
 {
-    int previous_line;
+    qint64 previous_line;
 
     if ( selectedLine_ >= 0 )
         previous_line = selectedLine_;
@@ -78,7 +78,7 @@ void Selection::selectRangeFromPrevious( int line )
     selectRange( previous_line, line );
 }
 
-void Selection::crop( int last_line )
+void Selection::crop( qint64 last_line )
 {
     if ( selectedLine_ > last_line )
         selectedLine_ = -1;
@@ -93,7 +93,7 @@ void Selection::crop( int last_line )
         selectedRange_.startLine = last_line;
 };
 
-bool Selection::getPortionForLine( int line, int* start_column, int* end_column ) const
+bool Selection::getPortionForLine( qint64 line, int* start_column, int* end_column ) const
 {
     if ( selectedPartial_.line == line ) {
         *start_column = selectedPartial_.startColumn;
@@ -106,7 +106,7 @@ bool Selection::getPortionForLine( int line, int* start_column, int* end_column
     }
 }
 
-bool Selection::isLineSelected( int line ) const
+bool Selection::isLineSelected( qint64 line ) const
 {
     if ( line == selectedLine_ )
         return true;
@@ -122,16 +122,16 @@ qint64 Selection::selectedLine() const
     return selectedLine_;
 }
 
-QList<int> Selection::getLines() const
+QList<qint64> Selection::getLines() const
 {
-    QList<int> selection;
+    QList<qint64> selection;
 
     if ( selectedLine_ >= 0 )
         selection.append( selectedLine_ );
     else if ( selectedPartial_.line >= 0 )
         selection.append( selectedPartial_.line );
     else if ( selectedRange_.startLine >= 0 )
-        for ( int i = selectedRange_.startLine;
+        for ( qint64 i = selectedRange_.startLine;
                 i <= selectedRange_.endLine; i++ )
             selection.append( i );
 
@@ -31,17 +31,17 @@ class Portion
 {
   public:
     Portion() { line_ = -1; }
-    Portion( int line, int start_column, int end_column )
+    Portion( qint64 line, int start_column, int end_column )
     { line_ = line; startColumn_ = start_column; endColumn_ = end_column; }
 
-    int line() const { return line_; }
+    qint64 line() const { return line_; }
     int startColumn() const { return startColumn_; }
     int endColumn() const { return endColumn_; }
 
     bool isValid() const { return ( line_ != -1 ); }
 
   private:
-    int line_;
+    qint64 line_;
     int startColumn_;
     int endColumn_;
 };
@@ -57,23 +57,23 @@ class Selection
     void clear() { selectedPartial_.line = -1; selectedLine_ = -1; };
 
     // Select one line
-    void selectLine( int line )
+    void selectLine( qint64 line )
       { selectedPartial_.line = -1; selectedRange_.startLine = -1;
         selectedLine_ = line; };
     // Select a portion of line (both start and end included)
-    void selectPortion( int line, int start_column, int end_column );
+    void selectPortion( qint64 line, int start_column, int end_column );
     void selectPortion( Portion selection )
       { selectPortion( selection.line(), selection.startColumn(),
               selection.endColumn() ); }
     // Select a range of lines (both start and end included)
-    void selectRange( int start_line, int end_line );
+    void selectRange( qint64 start_line, qint64 end_line );
 
     // Select a range from the previously selected line or beginning
     // of range (shift+click behaviour)
-    void selectRangeFromPrevious( int line );
+    void selectRangeFromPrevious( qint64 line );
 
     // Crop selection so that in fit in the range ending with the line passed.
-    void crop( int last_line );
+    void crop( qint64 last_line );
 
     // Returns whether the selection is empty
     bool isEmpty() const
@@ -87,13 +87,13 @@ class Selection
 
     // Returns whether a portion is selected or not on the passed line.
     // If so, returns the portion position.
-    bool getPortionForLine( int line,
+    bool getPortionForLine( qint64 line,
             int* start_column, int* end_column ) const;
     // Get a list of selected line(s), in order.
-    QList<int> getLines() const;
+    QList<qint64> getLines() const;
 
     // Returns wether the line passed is selected (entirely).
-    bool isLineSelected( int line ) const;
+    bool isLineSelected( qint64 line ) const;
 
     // Returns the line selected or -1 if not a single line selection
     qint64 selectedLine() const;
@@ -111,19 +111,19 @@ class Selection
 
   private:
     // Line number currently selected, or -1 if none selected
-    int selectedLine_;
+    qint64 selectedLine_;
 
     struct SelectedPartial {
-        int line;
+        qint64 line;
         int startColumn;
         int endColumn;
     };
     struct SelectedRange {
         // The limits of the range, sorted
-        int startLine;
-        int endLine;
+        qint64 startLine;
+        qint64 endLine;
         // The line selected first, used for shift+click
-        int firstLine;
+        qint64 firstLine;
     };
     struct SelectedPartial selectedPartial_;
     struct SelectedRange selectedRange_;
@@ -87,6 +87,11 @@ class FilePosition
     qint64 line() const { return line_; }
     int column() const { return column_; }
 
+    bool operator==( const FilePosition& other ) const
+    { return line_ == other.line_ && column_ == other.column_; }
+    bool operator!=( const FilePosition& other ) const
+    { return ! operator==( other ); }
+
   private:
     qint64 line_;
     int column_;
@@ -2,6 +2,14 @@
 
 #include "testlogdata.h"
 #include "testlogfiltereddata.h"
+#include "testtrigramindex.h"
+#include "testtimestampindex.h"
+#include "testmatchhistogram.h"
+#include "testregexpbudget.h"
+#include "testquickfindindex.h"
+#include "testperfcounters.h"
+#include "testtracer.h"
+#include "testfilewatcher.h"
 
 int main(int argc, char** argv)
 {
@@ -10,6 +18,14 @@ int main(int argc, char** argv)
     int retval(0);
     retval += QTest::qExec(&TestLogData(), argc, argv);
     retval += QTest::qExec(&TestLogFilteredData(), argc, argv);
+    retval += QTest::qExec(&TestTrigramIndex(), argc, argv);
+    retval += QTest::qExec(&TestTimestampIndex(), argc, argv);
+    retval += QTest::qExec(&TestMatchHistogram(), argc, argv);
+    retval += QTest::qExec(&TestRegExpBudget(), argc, argv);
+    retval += QTest::qExec(&TestQuickFindIndex(), argc, argv);
+    retval += QTest::qExec(&TestPerfCounters(), argc, argv);
+    retval += QTest::qExec(&TestTracer(), argc, argv);
+    retval += QTest::qExec(&TestFileWatcher(), argc, argv);
 
     return (retval ? 1 : 0);
 
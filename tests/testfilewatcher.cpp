@@ -0,0 +1,49 @@
+#include <QSignalSpy>
+#include <QFile>
+
+#include "testfilewatcher.h"
+
+#include "filewatcher.h"
+
+#if !defined( TMPDIR )
+#define TMPDIR "/tmp"
+#endif
+
+static const char* polled_file = TMPDIR "/polledfile.txt";
+
+void TestFileWatcher::pollAlways()
+{
+    QFile file( polled_file );
+    QVERIFY( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+    file.write( "first line\n" );
+    file.close();
+
+    FileWatcher watcher;
+    watcher.setPollingMode( FileWatcher::PollAlways );
+    watcher.addFile( polled_file );
+
+    QSignalSpy changedSpy( &watcher, SIGNAL( fileChanged( const QString& ) ) );
+
+    // Nothing changed since the file was added
+    QVERIFY( QMetaObject::invokeMethod( &watcher, "pollFile" ) );
+    QCOMPARE( changedSpy.count(), 0 );
+
+    // The poll is called directly, before any event is processed, so
+    // the change can only come from it (not from inotify or Qt)
+    QVERIFY( file.open( QIODevice::Append ) );
+    file.write( "second line\n" );
+    file.close();
+    QVERIFY( QMetaObject::invokeMethod( &watcher, "pollFile" ) );
+    QCOMPARE( changedSpy.count(), 1 );
+    QCOMPARE( changedSpy.at( 0 ).at( 0 ).toString(), QString( polled_file ) );
+
+    // Each change is reported once
+    QVERIFY( QMetaObject::invokeMethod( &watcher, "pollFile" ) );
+    QCOMPARE( changedSpy.count(), 1 );
+
+    QVERIFY( QFile::remove( polled_file ) );
+    QVERIFY( QMetaObject::invokeMethod( &watcher, "pollFile" ) );
+    QCOMPARE( changedSpy.count(), 2 );
+
+    watcher.removeFile( polled_file );
+}
@@ -0,0 +1,9 @@
+#include <QtTest/QtTest>
+
+class TestFileWatcher: public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void pollAlways();
+};
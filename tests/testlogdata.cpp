@@ -23,6 +23,8 @@
 
 #include "testlogdata.h"
 #include "logdata.h"
+#include "logdataworkerthread.h"
+#include "marks.h"
 
 #if !defined( TMPDIR )
 #define TMPDIR "/tmp"
@@ -235,6 +237,150 @@ void TestLogData::changingFile()
     QCOMPARE( logData.getFileSize(), 0LL );
 }
 
+void TestLogData::rotatingFile()
+{
+    char newLine[90];
+    LogData logData;
+
+    QSignalSpy finishedSpy( &logData, SIGNAL( loadingFinished( bool ) ) );
+    QSignalSpy changedSpy( &logData,
+            SIGNAL( fileChanged( LogData::MonitoredFileStatus ) ) );
+
+    connect( &logData, SIGNAL( loadingFinished( bool ) ),
+            this, SLOT( loadingFinished() ) );
+
+    // Generate a file
+    QFile::remove( TMPDIR "/rotatingfile.txt.1" );
+    QFile file( TMPDIR "/rotatingfile.txt" );
+    if ( file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 0; i < 200; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    file.close();
+
+    logData.attachFile( TMPDIR "/rotatingfile.txt" );
+    QApplication::exec();
+
+    QCOMPARE( finishedSpy.count(), 1 );
+    QCOMPARE( logData.getNbLine(), 200LL );
+
+    // Rotate it (rename and create, as logrotate does) with a new file
+    // bigger than the old one
+    QVERIFY( QFile::rename( TMPDIR "/rotatingfile.txt",
+                TMPDIR "/rotatingfile.txt.1" ) );
+    if ( file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 0; i < 300; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    file.close();
+
+    QApplication::exec();
+
+    // The new file has replaced the old one (its lines have not been
+    // appended to the old ones)
+    QCOMPARE( finishedSpy.count(), 2 );
+    QVERIFY( changedSpy.count() >= 1 );
+    QCOMPARE( logData.getNbLine(), 300LL );
+    QCOMPARE( logData.getFileSize(), 300 * (SL_LINE_LENGTH+1LL) );
+
+    disconnect( &logData, 0 );
+    QFile::remove( TMPDIR "/rotatingfile.txt.1" );
+}
+
+void TestLogData::removedFile()
+{
+    char newLine[90];
+    LogData logData;
+
+    QSignalSpy finishedSpy( &logData, SIGNAL( loadingFinished( bool ) ) );
+    QSignalSpy changedSpy( &logData,
+            SIGNAL( fileChanged( LogData::MonitoredFileStatus ) ) );
+
+    connect( &logData, SIGNAL( loadingFinished( bool ) ),
+            this, SLOT( loadingFinished() ) );
+
+    // Generate a file
+    QFile file( TMPDIR "/removedfile.txt" );
+    if ( file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 0; i < 200; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    file.close();
+
+    logData.attachFile( TMPDIR "/removedfile.txt" );
+    QApplication::exec();
+
+    QCOMPARE( finishedSpy.count(), 1 );
+    QCOMPARE( logData.getNbLine(), 200LL );
+
+    // Kept for a while in case it is being rotated, then cleared
+    QVERIFY( QFile::remove( TMPDIR "/removedfile.txt" ) );
+    QTest::qWait( 500 );
+    QCOMPARE( logData.getNbLine(), 200LL );
+
+    QApplication::exec();
+
+    QCOMPARE( finishedSpy.count(), 2 );
+    QCOMPARE( changedSpy.count(), 1 );
+    QCOMPARE( logData.getNbLine(), 0LL );
+
+    disconnect( &logData, 0 );
+}
+
+void TestLogData::rewrittenFile()
+{
+    char newLine[100];
+    LogData logData;
+
+    QSignalSpy finishedSpy( &logData, SIGNAL( loadingFinished( bool ) ) );
+
+    connect( &logData, SIGNAL( loadingFinished( bool ) ),
+            this, SLOT( loadingFinished() ) );
+
+    // Generate a file
+    QFile file( TMPDIR "/rewrittenfile.txt" );
+    if ( file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 0; i < 200; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    file.close();
+
+    logData.attachFile( TMPDIR "/rewrittenfile.txt" );
+    QApplication::exec();
+
+    QCOMPARE( finishedSpy.count(), 1 );
+    QCOMPARE( logData.getNbLine(), 200LL );
+
+    // Overwrite it in place (same file, not truncated) with longer lines,
+    // the file grows but its beginning is not what has been indexed
+    if ( file.open( QIODevice::ReadWrite ) ) {
+        for (int i = 0; i < 250; i++) {
+            qstrcpy( newLine, "rewritten " );
+            snprintf(newLine + 10, 89, sl_format, i);
+            file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    file.close();
+
+    QApplication::exec();
+
+    // The whole file has been indexed again
+    QCOMPARE( finishedSpy.count(), 2 );
+    QCOMPARE( logData.getNbLine(), 250LL );
+    QCOMPARE( logData.getFileSize(), 250 * (SL_LINE_LENGTH+11LL) );
+    QVERIFY( logData.getLineString( 0 ).startsWith( "rewritten " ) );
+
+    disconnect( &logData, 0 );
+}
+
 void TestLogData::sequentialRead()
 {
     LogData logData;
@@ -349,6 +495,152 @@ void TestLogData::randomPageReadExpanded()
     }
 }
 
+void TestLogData::scatteredRead()
+{
+    LogData logData;
+
+    // Register for notification file is loaded
+    connect( &logData, SIGNAL( loadingFinished( bool ) ),
+            this, SLOT( loadingFinished() ) );
+
+    logData.attachFile( TMPDIR "/verybiglog.txt" );
+    // Wait for the loading to be done
+    {
+        QApplication::exec();
+    }
+
+    // Some neighbours (read together) and some far apart lines,
+    // like in a filtered view
+    QList<qint64> lines;
+    lines << 0 << 1 << 2 << 10 << 500 << 501 << 40000
+        << VBL_NB_LINES - 2 << VBL_NB_LINES - 1;
+
+    QStringList list = logData.getLinesAt( lines );
+    QCOMPARE( list.count(), lines.count() );
+    for ( int i = 0; i < lines.count(); i++ )
+        QCOMPARE( list[i], logData.getLineString( lines[i] ) );
+
+    list = logData.getExpandedLinesAt( lines );
+    QCOMPARE( list.count(), lines.count() );
+    for ( int i = 0; i < lines.count(); i++ )
+        QCOMPARE( list[i], logData.getExpandedLineString( lines[i] ) );
+
+    // Out of bound lines are empty
+    lines.clear();
+    lines << 3 << VBL_NB_LINES;
+    list = logData.getLinesAt( lines );
+    QCOMPARE( list.count(), 2 );
+    QCOMPARE( list[0], logData.getLineString( 3 ) );
+    QVERIFY( list[1].isEmpty() );
+}
+
+void TestLogData::longLineWindow()
+{
+    LogData logData;
+
+    // Register for notification file is loaded
+    connect( &logData, SIGNAL( loadingFinished( bool ) ),
+            this, SLOT( loadingFinished() ) );
+
+    // A short line, a line of about 1 MB with tabs here and there
+    // (read by parts) and a short line
+    QByteArray longLine;
+    for ( int i = 0; longLine.size() < 1024 * 1024; i++ ) {
+        longLine.append( QByteArray::number( i ) );
+        longLine.append( ( i % 7 == 0 ) ? '\t' : ' ' );
+    }
+
+    QFile file( TMPDIR "/longline.txt" );
+    if ( file.open( QIODevice::WriteOnly ) ) {
+        file.write( "first\tline\n" );
+        file.write( longLine );
+        file.write( "\nlast line\n" );
+    }
+    file.close();
+
+    logData.attachFile( TMPDIR "/longline.txt" );
+    // Wait for the loading to be done
+    {
+        QApplication::exec();
+    }
+
+    QCOMPARE( logData.getNbLine(), 3LL );
+
+    const QStringList full = logData.getExpandedLines( 0, 3 );
+    QCOMPARE( logData.getLineLength( 1 ), full[1].length() );
+    QCOMPARE( logData.getMaxLength(), full[1].length() );
+
+    // Windows at the start, across segments, and at the very end
+    QList<int> columns;
+    columns << 0 << 3 << 65530 << 65536 << 500000 << full[1].length() - 10
+        << full[1].length() + 10;
+    foreach ( int column, columns ) {
+        const QStringList window =
+            logData.getExpandedLinesWindow( 0, 3, column, 100 );
+        QCOMPARE( window.size(), 3 );
+        for ( int i = 0; i < 3; i++ )
+            QCOMPARE( window[i], full[i].mid( column, 100 ) );
+    }
+}
+
+void TestLogData::linePositionArray()
+{
+    // Enough positions to fill a few blocks
+    const qint64 nbPositions = 200000;
+
+    LinePositionArray array;
+    for ( qint64 i = 0; i < nbPositions; i++ )
+        array.append( i * 100 );
+
+    QCOMPARE( array.size(), nbPositions );
+    QCOMPARE( array.at( 0 ), 0LL );
+    QCOMPARE( array.at( 65535 ), 6553500LL );
+    QCOMPARE( array.at( 65536 ), 6553600LL );
+    QCOMPARE( array[ nbPositions - 1 ], ( nbPositions - 1 ) * 100 );
+
+    // A fake final LF is replaced by what comes next
+    array.append( nbPositions * 100 + 1 );
+    array.setFakeFinalLF();
+
+    LinePositionArray copy = array;
+
+    LinePositionArray more;
+    more.append( nbPositions * 100 + 50 );
+    more.append( nbPositions * 100 + 80 );
+    array += more;
+
+    QCOMPARE( array.size(), nbPositions + 2 );
+    QCOMPARE( array.at( nbPositions ), nbPositions * 100 + 50 );
+    QCOMPARE( array.at( nbPositions + 1 ), nbPositions * 100 + 80 );
+    QVERIFY( ! array.hasFakeFinalLF() );
+
+    // The copy is not affected
+    QCOMPARE( copy.size(), nbPositions + 1 );
+    QCOMPARE( copy.at( nbPositions ), nbPositions * 100 + 1 );
+}
+
+void TestLogData::hugeLineNumbers()
+{
+    // Line numbers beyond what an int can hold, as in a file of more
+    // than three billion lines
+    const qint64 far = 5000000000LL;
+
+    Marks marks;
+    marks.addMark( far + 2 );
+    marks.addMark( 10 );
+    marks.addMark( far, QChar( 'a' ) );
+
+    QCOMPARE( marks.size(), 3 );
+    QVERIFY( marks.isLineMarked( far ) );
+    QVERIFY( ! marks.isLineMarked( far + 1 ) );
+    QVERIFY( ! marks.isLineMarked( far - ( 1LL << 32 ) ) );
+    QCOMPARE( marks.getLineMarkedByIndex( 0 ), 10LL );
+    QCOMPARE( marks.getLineMarkedByIndex( 2 ), far + 2 );
+
+    marks.deleteMark( far + 2 );
+    QCOMPARE( marks.size(), 2 );
+}
+
 //
 // Private functions
 //
@@ -12,10 +12,17 @@ class TestLogData: public QObject
         void simpleLoad();
         void multipleLoad();
         void changingFile();
+        void rotatingFile();
+        void removedFile();
+        void rewrittenFile();
         void sequentialRead();
         void sequentialReadExpanded();
         void randomPageRead();
         void randomPageReadExpanded();
+        void scatteredRead();
+        void longLineWindow();
+        void linePositionArray();
+        void hugeLineNumbers();
 
     public slots:
         void loadingFinished();
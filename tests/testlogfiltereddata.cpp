@@ -174,17 +174,21 @@ void TestLogFilteredData::multipleSearchTest()
 
     // Performs two searches in a row
     // Start the search, and immediately another one
-    // (the second call should block until the first search is done)
+    // (the second call supersedes the first one without blocking,
+    // progress from the first search is discarded)
     filteredData_->runSearch( QRegExp( "1234" ) );
     filteredData_->runSearch( QRegExp( "123" ) );
 
-    for ( int i = 0; i < 3; i++ ) {
-        waitSearchProgressed();
-        signalSearchProgressedRead();
+    {
+        std::pair<int,int> progress;
+        do {
+            progress = waitSearchProgressed();
+            if ( progress.second < 100 )
+                signalSearchProgressedRead();
+        } while ( progress.second < 100 );
     }
 
     // We should have the result for the 2nd search after the last chunk
-    waitSearchProgressed();
     QCOMPARE( filteredData_->getNbLine(), 12LL );
     signalSearchProgressedRead();
 
@@ -276,6 +280,8 @@ void TestLogFilteredData::updateSearchTest()
 
     sleep(1);
 
+    const int generation = filteredData_->getLinesGeneration();
+
     // Start an update search
     filteredData_->updateSearch();
 
@@ -287,6 +293,8 @@ void TestLogFilteredData::updateSearchTest()
     // Check the result
     QCOMPARE( logData_->getNbLine(), 5001LL );
     QCOMPARE( filteredData_->getNbLine(), 26LL );
+    // The matches have only been appended, the lines are unchanged
+    QCOMPARE( filteredData_->getLinesGeneration(), generation );
 
     QWARN("Starting stage 3");
 
@@ -350,6 +358,192 @@ void TestLogFilteredData::updateSearchTest()
     QApplication::quit();
 }
 
+void TestLogFilteredData::wrappedSearch()
+{
+    logData_ = new LogData();
+
+    // Register for notification file is loaded
+    connect( logData_, SIGNAL( loadingFinished( bool ) ),
+            this, SLOT( loadingFinished() ) );
+
+    filteredData_ = logData_->getNewFilteredData();
+    connect( filteredData_, SIGNAL( searchProgressed( int, int ) ),
+            this, SLOT( searchProgressed( int, int ) ) );
+
+    QFuture<void> future = QtConcurrent::run(this, &TestLogFilteredData::wrappedSearchTest);
+
+    QApplication::exec();
+
+    disconnect( filteredData_, 0 );
+    disconnect( logData_, 0 );
+
+    delete filteredData_;
+    delete logData_;
+}
+
+void TestLogFilteredData::wrappedSearchTest()
+{
+    // First load the tests file
+    logData_->attachFile( TMPDIR "/mediumlog.txt" );
+    // Wait for the loading to be done
+    waitLoadingFinished();
+    QCOMPARE( logData_->getNbLine(), ML_NB_LINES );
+    signalLoadingFinishedRead();
+
+    // Start the search in the middle of the file, it will wrap around
+    filteredData_->runSearch( QRegExp( "123" ), 7000 );
+
+    {
+        std::pair<int,int> progress;
+        do {
+            progress = waitSearchProgressed();
+            if ( progress.second < 100 )
+                signalSearchProgressedRead();
+        } while ( progress.second < 100 );
+    }
+
+    // Same results as a search from the beginning, in the same order
+    QCOMPARE( filteredData_->getNbLine(), 135LL );
+    QCOMPARE( filteredData_->getMatchingLineNumber( 0 ), 123LL );
+    for ( int i = 1; i < 135; i++ )
+        QVERIFY( filteredData_->getMatchingLineNumber( i - 1 )
+                < filteredData_->getMatchingLineNumber( i ) );
+    signalSearchProgressedRead();
+
+    // Same thing starting around the line and moving away from it
+    filteredData_->setSearchDirection( SearchOutward );
+    filteredData_->runSearch( QRegExp( "123" ), 7000 );
+
+    {
+        std::pair<int,int> progress;
+        do {
+            progress = waitSearchProgressed();
+            if ( progress.second < 100 )
+                signalSearchProgressedRead();
+        } while ( progress.second < 100 );
+    }
+
+    QCOMPARE( filteredData_->getNbLine(), 135LL );
+    QCOMPARE( filteredData_->getMatchingLineNumber( 0 ), 123LL );
+    for ( int i = 1; i < 135; i++ )
+        QVERIFY( filteredData_->getMatchingLineNumber( i - 1 )
+                < filteredData_->getMatchingLineNumber( i ) );
+    signalSearchProgressedRead();
+
+    // Same thing searching from the end of the file
+    filteredData_->setSearchDirection( SearchBackward );
+    filteredData_->runSearch( QRegExp( "123" ) );
+
+    {
+        std::pair<int,int> progress;
+        do {
+            progress = waitSearchProgressed();
+            if ( progress.second < 100 )
+                signalSearchProgressedRead();
+        } while ( progress.second < 100 );
+    }
+
+    QCOMPARE( filteredData_->getNbLine(), 135LL );
+    QCOMPARE( filteredData_->getMatchingLineNumber( 0 ), 123LL );
+    for ( int i = 1; i < 135; i++ )
+        QVERIFY( filteredData_->getMatchingLineNumber( i - 1 )
+                < filteredData_->getMatchingLineNumber( i ) );
+    signalSearchProgressedRead();
+
+    // Limited, it keeps the last matches
+    filteredData_->setSearchMode( SearchFirstMatches, 10 );
+    filteredData_->runSearch( QRegExp( "123" ) );
+
+    {
+        std::pair<int,int> progress;
+        do {
+            progress = waitSearchProgressed();
+            if ( progress.second < 100 )
+                signalSearchProgressedRead();
+        } while ( progress.second < 100 );
+    }
+
+    QCOMPARE( filteredData_->getNbLine(), 10LL );
+    QCOMPARE( filteredData_->getMatchingLineNumber( 9 ), 14123LL );
+    signalSearchProgressedRead();
+
+    QApplication::quit();
+}
+
+void TestLogFilteredData::limitedSearch()
+{
+    logData_ = new LogData();
+
+    // Register for notification file is loaded
+    connect( logData_, SIGNAL( loadingFinished( bool ) ),
+            this, SLOT( loadingFinished() ) );
+
+    filteredData_ = logData_->getNewFilteredData();
+    connect( filteredData_, SIGNAL( searchProgressed( int, int ) ),
+            this, SLOT( searchProgressed( int, int ) ) );
+
+    QFuture<void> future = QtConcurrent::run(this, &TestLogFilteredData::limitedSearchTest);
+
+    QApplication::exec();
+
+    disconnect( filteredData_, 0 );
+    disconnect( logData_, 0 );
+
+    delete filteredData_;
+    delete logData_;
+}
+
+void TestLogFilteredData::limitedSearchTest()
+{
+    // First load the tests file
+    logData_->attachFile( TMPDIR "/mediumlog.txt" );
+    // Wait for the loading to be done
+    waitLoadingFinished();
+    QCOMPARE( logData_->getNbLine(), ML_NB_LINES );
+    signalLoadingFinishedRead();
+
+    // Only count the matches
+    filteredData_->setSearchMode( SearchCountOnly );
+    filteredData_->runSearch( QRegExp( "123" ) );
+
+    {
+        std::pair<int,int> progress;
+        do {
+            progress = waitSearchProgressed();
+            if ( progress.second < 100 )
+                signalSearchProgressedRead();
+        } while ( progress.second < 100 );
+    }
+
+    QCOMPARE( filteredData_->getNbMatchesFound(), 135LL );
+    QCOMPARE( filteredData_->getNbLine(), 0LL );
+    QCOMPARE( filteredData_->getMaxLength(), 0 );
+    signalSearchProgressedRead();
+
+    // Only keep the first 10, even when starting further in the file
+    filteredData_->setSearchMode( SearchFirstMatches, 10 );
+    filteredData_->runSearch( QRegExp( "123" ), 7000 );
+
+    {
+        std::pair<int,int> progress;
+        do {
+            progress = waitSearchProgressed();
+            if ( progress.second < 100 )
+                signalSearchProgressedRead();
+        } while ( progress.second < 100 );
+    }
+
+    QCOMPARE( filteredData_->getNbMatchesFound(), 10LL );
+    QCOMPARE( filteredData_->getNbLine(), 10LL );
+    QCOMPARE( filteredData_->getMatchingLineNumber( 0 ), 123LL );
+    for ( int i = 1; i < 10; i++ )
+        QVERIFY( filteredData_->getMatchingLineNumber( i - 1 )
+                < filteredData_->getMatchingLineNumber( i ) );
+    signalSearchProgressedRead();
+
+    QApplication::quit();
+}
+
 void TestLogFilteredData::marks()
 {
     logData_ = new LogData();
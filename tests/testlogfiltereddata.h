@@ -20,6 +20,8 @@ class TestLogFilteredData: public QObject
         void marks();
         void lineLength();
         void updateSearch();
+        void wrappedSearch();
+        void limitedSearch();
 
     public slots:
         void loadingFinished();
@@ -31,6 +33,8 @@ class TestLogFilteredData: public QObject
         void simpleSearchTest();
         void multipleSearchTest();
         void updateSearchTest();
+        void wrappedSearchTest();
+        void limitedSearchTest();
         void marksTest();
         void lineLengthTest();
 
@@ -0,0 +1,87 @@
+#include "testmatchhistogram.h"
+#include "matchhistogram.h"
+
+void TestMatchHistogram::addAndRemove()
+{
+    MatchHistogram histogram;
+    QVERIFY( histogram.isEmpty() );
+    QCOMPARE( histogram.maxCount(), 0 );
+
+    histogram.add( 10 );
+    histogram.add( 10 );
+    histogram.add( 12 );
+    QCOMPARE( histogram.linesPerBucket(), 1LL );
+    QCOMPARE( histogram.firstLine(), 10LL );
+    QCOMPARE( histogram.nbBuckets(), 3 );
+    QCOMPARE( histogram.count( 0 ), 2 );
+    QCOMPARE( histogram.count( 1 ), 0 );
+    QCOMPARE( histogram.maxCount(), 2 );
+
+    histogram.remove( 10 );
+    histogram.remove( 11 );
+    QCOMPARE( histogram.count( 0 ), 1 );
+    QCOMPARE( histogram.count( 1 ), 0 );
+
+    histogram.clear();
+    QVERIFY( histogram.isEmpty() );
+}
+
+void TestMatchHistogram::coarsen()
+{
+    MatchHistogram histogram;
+
+    // One match on every line of a file far bigger than maxBuckets
+    const int nbLines = MatchHistogram::maxBuckets * 10;
+    for ( int i = 0; i < nbLines; i++ )
+        histogram.add( i );
+
+    QVERIFY( histogram.nbBuckets() <= MatchHistogram::maxBuckets );
+    QCOMPARE( histogram.linesPerBucket(), 16LL );
+    QCOMPARE( histogram.firstLine(), 0LL );
+
+    int total = 0;
+    for ( int i = 0; i < histogram.nbBuckets(); i++ )
+        total += histogram.count( i );
+    QCOMPARE( total, nbLines );
+    QCOMPARE( histogram.maxCount(), 16 );
+}
+
+void TestMatchHistogram::merge()
+{
+    MatchHistogram first;
+    first.add( 0 );
+    first.add( 1 );
+
+    // Far enough to be coarser than first
+    MatchHistogram second;
+    second.add( 4000 );
+    second.add( 5000 );
+
+    first.merge( second );
+    QCOMPARE( first.linesPerBucket(), 16LL );
+    QCOMPARE( first.count( 0 ), 2 );
+    QCOMPARE( first.count( 4000 / 16 ), 1 );
+    QCOMPARE( first.count( 5000 / 16 ), 1 );
+}
+
+void TestMatchHistogram::mergeCoarsening()
+{
+    MatchHistogram first;
+    first.add( 0 );
+
+    // Same resolution, but the merged range only fits once coarsened,
+    // which happens while the buckets are added
+    MatchHistogram second;
+    second.add( 400 );
+    second.add( 600 );
+    second.add( 700 );
+    QCOMPARE( second.linesPerBucket(), 1LL );
+
+    first.merge( second );
+    QCOMPARE( first.linesPerBucket(), 2LL );
+    QCOMPARE( first.nbBuckets(), 700 / 2 + 1 );
+    QCOMPARE( first.count( 0 ), 1 );
+    QCOMPARE( first.count( 400 / 2 ), 1 );
+    QCOMPARE( first.count( 600 / 2 ), 1 );
+    QCOMPARE( first.count( 700 / 2 ), 1 );
+}
@@ -0,0 +1,12 @@
+#include <QtTest/QtTest>
+
+class TestMatchHistogram: public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void addAndRemove();
+        void coarsen();
+        void merge();
+        void mergeCoarsening();
+};
@@ -0,0 +1,85 @@
+#include "testperfcounters.h"
+
+#include "perfcounters.h"
+
+void TestPerfCounters::latencyBuckets()
+{
+    LatencyHistogram histogram;
+
+    histogram.record( 0 );
+    histogram.record( 1 );
+    histogram.record( 3 );
+    histogram.record( 1000 );
+
+    QCOMPARE( histogram.count(), 4LL );
+    QCOMPARE( histogram.total(), 1004LL );
+    QCOMPARE( histogram.max(), 1000LL );
+    QCOMPARE( histogram.bucketCount( 0 ), 1LL );
+    QCOMPARE( histogram.bucketCount( 1 ), 1LL );
+    QCOMPARE( histogram.bucketCount( 2 ), 1LL );
+    // 512 <= 1000 < 1024
+    QCOMPARE( histogram.bucketCount( 10 ), 1LL );
+
+    // Very long durations all go to the last bucket
+    histogram.record( 1LL << 40 );
+    QCOMPARE( histogram.bucketCount( LatencyHistogram::nbBuckets - 1 ), 1LL );
+
+    histogram.reset();
+    QCOMPARE( histogram.count(), 0LL );
+    QCOMPARE( histogram.bucketCount( 10 ), 0LL );
+}
+
+void TestPerfCounters::percentiles()
+{
+    LatencyHistogram histogram;
+    QCOMPARE( histogram.percentile( 50 ), 0LL );
+
+    // 98 fast durations and 2 slow ones
+    for ( int i = 0; i < 98; i++ )
+        histogram.record( 10 );
+    histogram.record( 5000 );
+    histogram.record( 5000 );
+
+    QCOMPARE( histogram.percentile( 50 ), 16LL );
+    QCOMPARE( histogram.percentile( 98 ), 16LL );
+    QCOMPARE( histogram.percentile( 99 ), 8192LL );
+}
+
+void TestPerfCounters::gauges()
+{
+    PerfCounters::reset();
+    const qint64 initial = PerfCounters::level( PerfCounters::SearchQueue );
+
+    PerfCounters::addToGauge( PerfCounters::SearchQueue, 1 );
+    PerfCounters::addToGauge( PerfCounters::SearchQueue, 1 );
+    PerfCounters::addToGauge( PerfCounters::SearchQueue, -1 );
+
+    QCOMPARE( PerfCounters::level( PerfCounters::SearchQueue ), initial + 1 );
+    QCOMPARE( PerfCounters::maxLevel( PerfCounters::SearchQueue ), initial + 2 );
+
+    // The maximum restarts from the current level
+    PerfCounters::addToGauge( PerfCounters::SearchQueue, -1 );
+    PerfCounters::reset();
+    QCOMPARE( PerfCounters::maxLevel( PerfCounters::SearchQueue ),
+            PerfCounters::level( PerfCounters::SearchQueue ) );
+}
+
+void TestPerfCounters::json()
+{
+    PerfCounters::reset();
+    PerfCounters::add( PerfCounters::LinesIndexed, 1000 );
+    PerfCounters::record( PerfCounters::IndexingTime, 500 );
+
+    QCOMPARE( PerfCounters::value( PerfCounters::LinesIndexed ), 1000LL );
+    QCOMPARE( PerfCounters::throughput( PerfCounters::LinesIndexed,
+                PerfCounters::IndexingTime ), 2000000LL );
+
+    const QString json = PerfCounters::toJson();
+    QVERIFY( json.startsWith( "{" ) );
+    QVERIFY( json.contains( "\"linesIndexed\": 1000" ) );
+    QVERIFY( json.contains( "\"indexing\": { \"count\": 1," ) );
+    QVERIFY( json.contains( "\"indexingLinesPerSecond\": 2000000" ) );
+
+    PerfCounters::reset();
+    QCOMPARE( PerfCounters::value( PerfCounters::LinesIndexed ), 0LL );
+}
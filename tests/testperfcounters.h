@@ -0,0 +1,12 @@
+#include <QtTest/QtTest>
+
+class TestPerfCounters: public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void latencyBuckets();
+        void percentiles();
+        void gauges();
+        void json();
+};
@@ -0,0 +1,98 @@
+#include "testquickfindindex.h"
+#include "quickfindindex.h"
+
+typedef QuickFindIndex::Match Match;
+
+void TestQuickFindIndex::lookups()
+{
+    const QRegExp regexp( "abc" );
+    QuickFindIndex index;
+    index.reset( regexp, 1 );
+
+    // Two matches on line 3, one on line 10, in 20 lines
+    QVector<Match> matches;
+    matches << Match( 3, 0, 2 ) << Match( 3, 8, 10 );
+    index.append( matches, 5 );
+    matches.clear();
+    matches << Match( 10, 4, 6 );
+    index.append( matches, 20 );
+    QCOMPARE( index.nbLinesIndexed(), 20LL );
+
+    Match match;
+    QCOMPARE( index.findNext( regexp, 1, 20, 0, 0, &match ),
+            QuickFindIndex::Found );
+    QCOMPARE( match.line(), 3LL );
+    QCOMPARE( match.startColumn(), 0 );
+    QCOMPARE( index.findNext( regexp, 1, 20, 3, 3, &match ),
+            QuickFindIndex::Found );
+    QCOMPARE( match.startColumn(), 8 );
+    QCOMPARE( match.endColumn(), 10 );
+    QCOMPARE( index.findNext( regexp, 1, 20, 10, 5, &match ),
+            QuickFindIndex::NotFound );
+    // The file has grown
+    QCOMPARE( index.findNext( regexp, 1, 30, 10, 5, &match ),
+            QuickFindIndex::Unknown );
+    QCOMPARE( index.findNext( regexp, 1, 30, 25, 0, &match ),
+            QuickFindIndex::Unknown );
+
+    QCOMPARE( index.findPrevious( regexp, 1, 10, 4, &match ),
+            QuickFindIndex::Found );
+    QCOMPARE( match.line(), 10LL );
+    QCOMPARE( index.findPrevious( regexp, 1, 10, 0, &match ),
+            QuickFindIndex::Found );
+    QCOMPARE( match.line(), 3LL );
+    QCOMPARE( match.startColumn(), 8 );
+    QCOMPARE( index.findPrevious( regexp, 1, 3, 7, &match ),
+            QuickFindIndex::Found );
+    QCOMPARE( match.startColumn(), 0 );
+    QCOMPARE( index.findPrevious( regexp, 1, 3, 0, &match ),
+            QuickFindIndex::NotFound );
+
+    qint64 nbMatches;
+    bool complete;
+    QCOMPARE( index.rankOf( regexp, 1, 20, 10, 4, &nbMatches, &complete ), 2LL );
+    QCOMPARE( nbMatches, 3LL );
+    QVERIFY( complete );
+    QCOMPARE( index.rankOf( regexp, 1, 20, 10, 5, &nbMatches, &complete ), -1LL );
+    QCOMPARE( index.rankOf( regexp, 1, 40, 3, 8, &nbMatches, &complete ), 1LL );
+    QVERIFY( ! complete );
+}
+
+void TestQuickFindIndex::validity()
+{
+    const QRegExp regexp( "abc" );
+    QuickFindIndex index;
+    index.reset( regexp, 1 );
+
+    QVector<Match> matches;
+    matches << Match( 0, 0, 2 );
+    index.append( matches, 1 );
+
+    Match match;
+    QVERIFY( index.isFor( regexp, 1 ) );
+    QVERIFY( ! index.isFor( regexp, 2 ) );
+    QVERIFY( ! index.isFor( QRegExp( "abd" ), 1 ) );
+    QCOMPARE( index.findNext( regexp, 2, 1, 0, 0, &match ),
+            QuickFindIndex::Unknown );
+    QCOMPARE( index.findNext( QRegExp( "abc", Qt::CaseInsensitive ),
+                1, 1, 0, 0, &match ), QuickFindIndex::Unknown );
+
+    // Too many matches
+    matches.fill( Match( 1, 0, 2 ), QuickFindIndex::maxMatches );
+    index.append( matches, 2 );
+    QVERIFY( index.isAbandoned() );
+    QCOMPARE( index.findNext( regexp, 1, 2, 0, 0, &match ),
+            QuickFindIndex::Unknown );
+
+    // They are still counted
+    MatchHistogram histogram;
+    QVERIFY( index.getHistogram( regexp, 1, &histogram ) );
+    QCOMPARE( histogram.count( 0 ), 1 );
+    QCOMPARE( histogram.count( 1 ), QuickFindIndex::maxMatches );
+    QCOMPARE( index.nbLinesIndexed(), 2LL );
+    QVERIFY( ! index.getHistogram( regexp, 2, &histogram ) );
+
+    index.reset( regexp, 1 );
+    QVERIFY( ! index.isAbandoned() );
+    QCOMPARE( index.nbLinesIndexed(), 0LL );
+}
@@ -0,0 +1,10 @@
+#include <QtTest/QtTest>
+
+class TestQuickFindIndex: public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void lookups();
+        void validity();
+};
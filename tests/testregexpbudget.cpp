@@ -0,0 +1,77 @@
+#include <QElapsedTimer>
+
+#include "testregexpbudget.h"
+#include "regexpbudget.h"
+
+namespace {
+    // Spin instead of sleeping, like a slow regexp would
+    void spin( int ms )
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while ( ! timer.hasExpired( ms ) );
+    }
+}
+
+void TestRegExpBudget::riskyPatterns()
+{
+    QVERIFY( RegExpBudget::isPatternRisky( "(a+)+$" ) );
+    QVERIFY( RegExpBudget::isPatternRisky( "^(\\w*,)*x" ) );
+    QVERIFY( RegExpBudget::isPatternRisky( "((ab)*c)+" ) );
+    QVERIFY( RegExpBudget::isPatternRisky( "(a|b+){2,}" ) );
+
+    QVERIFY( ! RegExpBudget::isPatternRisky( "error.*timeout" ) );
+    QVERIFY( ! RegExpBudget::isPatternRisky( "(ab)+c*" ) );
+    QVERIFY( ! RegExpBudget::isPatternRisky( "(a+){3}" ) );
+    QVERIFY( ! RegExpBudget::isPatternRisky( "\\(a+\\)+" ) );
+    QVERIFY( ! RegExpBudget::isPatternRisky( "[(a+)]+" ) );
+}
+
+void TestRegExpBudget::slowLines()
+{
+    // 10 ms per line, 25 ms in total
+    RegExpBudget budget( 10, 25 );
+
+    budget.startLine();
+    QVERIFY( budget.lineDone( 1 ) );
+    QVERIFY( budget.slowLines().isEmpty() );
+
+    spin( 15 );
+    QVERIFY( budget.lineDone( 2 ) );
+    QCOMPARE( budget.slowLines().size(), 1 );
+    QCOMPARE( budget.slowLines().first(), 2LL );
+
+    // Time spent between the lines is not accounted
+    spin( 15 );
+    budget.startLine();
+    QVERIFY( budget.lineDone( 3 ) );
+    QCOMPARE( budget.slowLines().size(), 1 );
+
+    spin( 15 );
+    QVERIFY( ! budget.lineDone( 4 ) );
+    QVERIFY( budget.isExhausted() );
+    QCOMPARE( budget.slowLines().size(), 2 );
+}
+
+void TestRegExpBudget::limitedRegExp()
+{
+#if QT_VERSION >= 0x050000
+    QRegularExpression limited;
+
+    QVERIFY( ! RegExpBudget::limitedRegExp(
+                QRegExp( "a*", Qt::CaseSensitive, QRegExp::Wildcard ),
+                &limited ) );
+
+    QVERIFY( RegExpBudget::limitedRegExp(
+                QRegExp( "(a+)+$", Qt::CaseInsensitive, QRegExp::RegExp2 ),
+                &limited ) );
+    QVERIFY( limited.match( "xxAAAA" ).hasMatch() );
+
+    // Would backtrack for ages without the limit
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY( ! limited.match( QString( 64, 'a' ) + "!" ).hasMatch() );
+    QVERIFY( timer.elapsed() < 5000 );
+#endif
+}
+
@@ -0,0 +1,11 @@
+#include <QtTest/QtTest>
+
+class TestRegExpBudget: public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void riskyPatterns();
+        void slowLines();
+        void limitedRegExp();
+};
@@ -13,16 +13,22 @@ else {
     DEFINES = TMPDIR=\\\"$${TMPDIR}\\\"
 }
 
+# Follow the files by inode on Linux (see FileWatcher)
+linux-* {
+    DEFINES += GLOGG_SUPPORTS_INOTIFY
+}
+
 mac {
   CONFIG -= app_bundle
 }
 
 TARGET = logcrawler_tests
-HEADERS += testlogdata.h testlogfiltereddata.h logdata.h logfiltereddata.h logdataworkerthread.h\
-    abstractlogdata.h logfiltereddataworkerthread.h filewatcher.h marks.h
-SOURCES += testlogdata.cpp testlogfiltereddata.cpp abstractlogdata.cpp logdata.cpp main.cpp\
+HEADERS += testlogdata.h testlogfiltereddata.h testtrigramindex.h testtimestampindex.h testmatchhistogram.h testregexpbudget.h testquickfindindex.h testperfcounters.h testtracer.h testfilewatcher.h logdata.h logfiltereddata.h logdataworkerthread.h\
+    abstractlogdata.h logfiltereddataworkerthread.h filewatcher.h marks.h atomicflag.h\
+    trigramindex.h timestampindex.h matchhistogram.h regexpbudget.h quickfindindex.h perfcounters.h tracer.h
+SOURCES += testlogdata.cpp testlogfiltereddata.cpp testtrigramindex.cpp testtimestampindex.cpp testmatchhistogram.cpp testregexpbudget.cpp testquickfindindex.cpp testperfcounters.cpp testtracer.cpp testfilewatcher.cpp abstractlogdata.cpp logdata.cpp main.cpp\
     logfiltereddata.cpp logdataworkerthread.cpp logfiltereddataworkerthread.cpp filewatcher.cpp\
-    marks.cpp
+    marks.cpp trigramindex.cpp timestampindex.cpp matchhistogram.cpp regexpbudget.cpp quickfindindex.cpp perfcounters.cpp tracer.cpp
 
 coverage:QMAKE_CXXFLAGS += -g -fprofile-arcs -ftest-coverage -O0
 coverage:QMAKE_LFLAGS += -fprofile-arcs -ftest-coverage
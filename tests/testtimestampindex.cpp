@@ -0,0 +1,115 @@
+#include <QStringList>
+
+#include "testtimestampindex.h"
+#include "timestampindex.h"
+#include "logdataworkerthread.h"
+
+static const qint64 second = 1000;
+static const qint64 day    = TimestampParser::msInDay;
+
+void TestTimestampIndex::parseFormats()
+{
+    TimestampParser iso( TimestampParser::Iso );
+    const qint64 t = iso.parse( "2014-03-01 12:00:05 INFO  Starting" );
+    QVERIFY( t > 0 );
+    QCOMPARE( iso.parse( "2014-03-01T12:00:05.250 INFO" ), t + 250 );
+    QCOMPARE( iso.parse( "[2014-03-01 12:00:05,5] INFO" ), t + 500 );
+    QCOMPARE( iso.parse( "2014-03-02 12:00:05" ), t + day );
+    QCOMPARE( iso.parse( "    at java.lang.Thread.run" ), -1LL );
+    QCOMPARE( iso.parse( "2014-02-30 12:00:05" ), -1LL );
+
+    TimestampParser apache( TimestampParser::Apache );
+    QCOMPARE( apache.parse( "[01/Mar/2014:12:00:05 +0100] \"GET /\"" ), t );
+
+    TimestampParser syslog( TimestampParser::Syslog );
+    const qint64 s = syslog.parse( "Mar  1 12:00:05 host kernel: boot" );
+    QVERIFY( s > 0 );
+    QCOMPARE( syslog.parse( "Mar 11 12:00:06 host kernel: boot" ),
+            s + 10 * day + second );
+
+    TimestampParser timeOnly( TimestampParser::TimeOnly );
+    QCOMPARE( timeOnly.parse( "00:01:02.003 main" ), 62 * second + 3 );
+    QCOMPARE( timeOnly.parse( "25:01:02 main" ), -1LL );
+}
+
+void TestTimestampIndex::detect()
+{
+    QStringList lines;
+    lines << "2014-03-01 12:00:01 INFO  Starting the server"
+        << "java.lang.Exception: oops"
+        << "    at Main.main"
+        << "2014-03-01 12:00:05 WARN  Connection refused by peer";
+    QCOMPARE( TimestampParser::detect( lines ), TimestampParser::Iso );
+
+    lines.clear();
+    lines << "Mar  1 12:00:05 host kernel: boot"
+        << "Mar  1 12:00:06 host kernel: ready";
+    QCOMPARE( TimestampParser::detect( lines ), TimestampParser::Syslog );
+
+    lines.clear();
+    lines << "Hello" << "World" << "12:00:00" << "!" << "?";
+    QCOMPARE( TimestampParser::detect( lines ), TimestampParser::Unknown );
+}
+
+void TestTimestampIndex::userTime()
+{
+    TimestampParser iso( TimestampParser::Iso );
+    const qint64 reference = iso.parse( "2014-03-01 12:00:05" );
+
+    QCOMPARE( TimestampParser::parseUserTime( "2014-03-01 14:32:05", 0 ),
+            iso.parse( "2014-03-01 14:32:05" ) );
+    QCOMPARE( TimestampParser::parseUserTime( " 14:32:05 ", reference ),
+            iso.parse( "2014-03-01 14:32:05" ) );
+    QCOMPARE( TimestampParser::parseUserTime( "14:32", reference ),
+            iso.parse( "2014-03-01 14:32:00" ) );
+    QCOMPARE( TimestampParser::parseUserTime( "yesterday", reference ), -1LL );
+}
+
+void TestTimestampIndex::lookup()
+{
+    TimestampIndex index;
+    QVERIFY( index.isEmpty() );
+    QCOMPARE( index.timeAt( 10 ), -1LL );
+
+    index.addSample( 0, 100 * second );
+    index.addSample( 4096, 200 * second );
+
+    TimestampIndex added;
+    added.addSample( 10, 300 * second );
+    index.append( added, 8000 );
+
+    QCOMPARE( index.lineBefore( 50 * second ), 0LL );
+    QCOMPARE( index.lineAfter( 50 * second ), 0LL );
+    QCOMPARE( index.lineBefore( 250 * second ), 4096LL );
+    QCOMPARE( index.lineAfter( 250 * second ), 8010LL );
+    QCOMPARE( index.lineAfter( 300 * second ), 8010LL );
+    QCOMPARE( index.lineAfter( 301 * second ), -1LL );
+
+    QCOMPARE( index.timeAt( 5000 ), 200 * second );
+    QCOMPARE( index.timeAt( 9000 ), 300 * second );
+}
+
+void TestTimestampIndex::nextSample()
+{
+    IndexingData data;
+    QCOMPARE( data.getNextTimestampSample(), 0LL );
+
+    LinePositionArray lines;
+    for ( int i = 1; i <= 100; i++ )
+        lines.append( i * 10 );
+    TimestampIndex timestamps;
+    timestamps.addSample( 0, 100 * second );
+    timestamps.addSample( 90, 200 * second );
+    data.setAll( 1000, 10, lines, timestamps );
+
+    // The interval goes on from the last sample, not from the new lines
+    QCOMPARE( data.getNextTimestampSample(),
+            90LL + TimestampIndex::samplingInterval - 100 );
+
+    LinePositionArray added;
+    for ( int i = 101; i <= 200; i++ )
+        added.append( i * 10 );
+    data.addAll( 1000, 10, added, TimestampIndex() );
+    QCOMPARE( data.getNextTimestampSample(),
+            90LL + TimestampIndex::samplingInterval - 200 );
+}
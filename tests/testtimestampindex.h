@@ -0,0 +1,13 @@
+#include <QtTest/QtTest>
+
+class TestTimestampIndex: public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void parseFormats();
+        void detect();
+        void userTime();
+        void lookup();
+        void nextSample();
+};
@@ -0,0 +1,56 @@
+#include "testtracer.h"
+
+#include "tracer.h"
+
+void TestTracer::disabled()
+{
+    Tracer::setEnabled( false );
+    Tracer::clear();
+
+    {
+        TraceScope trace( "notRecorded" );
+    }
+    Tracer::instant( "notRecordedEither" );
+
+    QVERIFY( ! Tracer::toJson().contains( "notRecorded" ) );
+}
+
+void TestTracer::scopes()
+{
+    Tracer::setEnabled( true );
+    Tracer::clear();
+
+    {
+        TraceScope trace( "outerScope" );
+        Tracer::instant( "instantEvent" );
+    }
+
+    Tracer::setEnabled( false );
+
+    const QString json = Tracer::toJson();
+    QVERIFY( json.startsWith( "{ \"traceEvents\": [" ) );
+    QVERIFY( json.contains( "\"name\": \"thread_name\"" ) );
+    QVERIFY( json.contains( "{ \"name\": \"outerScope\", \"ph\": \"X\"" ) );
+    QVERIFY( json.contains( "{ \"name\": \"instantEvent\", \"ph\": \"i\"" ) );
+    // The instant event is recorded before the end of the scope
+    QVERIFY( json.indexOf( "instantEvent" ) < json.indexOf( "outerScope" ) );
+}
+
+void TestTracer::ringBuffer()
+{
+    Tracer::setEnabled( true );
+    Tracer::clear();
+
+    Tracer::instant( "oldestEvent" );
+    for ( int i = 0; i < Tracer::eventsPerThread; i++ )
+        Tracer::instant( "newerEvent" );
+
+    Tracer::setEnabled( false );
+
+    const QString json = Tracer::toJson();
+    QVERIFY( ! json.contains( "oldestEvent" ) );
+    QCOMPARE( json.count( "newerEvent" ), Tracer::eventsPerThread );
+
+    Tracer::clear();
+    QVERIFY( ! Tracer::toJson().contains( "newerEvent" ) );
+}
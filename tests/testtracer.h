@@ -0,0 +1,11 @@
+#include <QtTest/QtTest>
+
+class TestTracer: public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void disabled();
+        void scopes();
+        void ringBuffer();
+};
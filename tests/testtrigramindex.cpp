@@ -0,0 +1,99 @@
+#include <QStringList>
+
+#include "testtrigramindex.h"
+#include "trigramindex.h"
+
+static QStringList block()
+{
+    QStringList lines;
+
+    lines << "2014-03-01 12:00:01 INFO  Starting the server"
+        << "2014-03-01 12:00:02 DEBUG Listening on port 8080"
+        << "2014-03-01 12:00:05 WARN  Connection refused by peer";
+
+    return lines;
+}
+
+void TestTrigramIndex::fixedString()
+{
+    TrigramIndex index;
+    index.indexBlock( 0, block() );
+
+    QVERIFY( index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "Listening", Qt::CaseSensitive, QRegExp::FixedString ) ) ) );
+    QVERIFY( ! index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "Segfault", Qt::CaseSensitive, QRegExp::FixedString ) ) ) );
+}
+
+void TestTrigramIndex::caseFolding()
+{
+    TrigramIndex index;
+    index.indexBlock( 0, block() );
+
+    QVERIFY( index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "connection REFUSED", Qt::CaseInsensitive,
+                        QRegExp::FixedString ) ) ) );
+}
+
+void TestTrigramIndex::regExpLiterals()
+{
+    TrigramIndex index;
+    index.indexBlock( 0, block() );
+
+    // Must match
+    QVERIFY( index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "port \\d+" ) ) ) );
+    QVERIFY( index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "Start(ing)? the" ) ) ) );
+    QVERIFY( index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "refused?x* by" ) ) ) );
+    QVERIFY( index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "\\x0041WARN" ) ) ) );
+    QVERIFY( index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "Listen[a-z]+ on" ) ) ) );
+
+    // Cannot match
+    QVERIFY( ! index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "ERROR.*port" ) ) ) );
+    QVERIFY( ! index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "Stopping" ) ) ) );
+}
+
+void TestTrigramIndex::regExpUnusable()
+{
+    TrigramIndex index;
+    index.indexBlock( 0, block() );
+
+    // Nothing mandatory can be extracted from these
+    QVERIFY( TrigramIndex::Query( QRegExp( "ERROR|WARN" ) ).isEmpty() );
+    QVERIFY( TrigramIndex::Query( QRegExp( "(Stopping)" ) ).isEmpty() );
+    QVERIFY( TrigramIndex::Query( QRegExp( "ab\\d" ) ).isEmpty() );
+}
+
+void TestTrigramIndex::wildcard()
+{
+    TrigramIndex index;
+    index.indexBlock( 0, block() );
+
+    QVERIFY( index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "*Connection*peer", Qt::CaseSensitive, QRegExp::Wildcard ) ) ) );
+    QVERIFY( ! index.mayMatch( 0, TrigramIndex::Query(
+                    QRegExp( "*Connection*closed", Qt::CaseSensitive, QRegExp::Wildcard ) ) ) );
+}
+
+void TestTrigramIndex::notIndexed()
+{
+    TrigramIndex index;
+    index.indexBlock( 1, block() );
+
+    QVERIFY( ! index.isIndexed( 0 ) );
+    QVERIFY( index.isIndexed( 1 ) );
+    QVERIFY( ! index.isIndexed( 2 ) );
+
+    // Blocks not indexed must be searched
+    QVERIFY( index.mayMatch( 0, TrigramIndex::Query( QRegExp( "Stopping" ) ) ) );
+
+    index.reset( 3 );
+    QVERIFY( ! index.isIndexed( 1 ) );
+    QCOMPARE( index.sourceGeneration(), 3 );
+}
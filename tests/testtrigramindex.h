@@ -0,0 +1,14 @@
+#include <QtTest/QtTest>
+
+class TestTrigramIndex: public QObject
+{
+    Q_OBJECT
+
+    private slots:
+        void fixedString();
+        void caseFolding();
+        void regExpLiterals();
+        void regExpUnusable();
+        void wildcard();
+        void notIndexed();
+};